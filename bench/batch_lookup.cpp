@@ -0,0 +1,104 @@
+// Compara buscas uma a uma (Set::search; no Map, find_many com uma chave,
+// para não medir o custo das exceções de operator[] const) com as
+// buscas em lote intercaladas e com prefetch (contains_many, find_many),
+// em árvores bem maiores que o último nível de cache. Para o Set mede também
+// o mesmo lote ordenado: buscas uma a uma versus search_sorted.
+//
+// Uso: batch_lookup_bench [elementos] [buscas]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../include/map.hpp"
+#include "../include/set.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+template <class F>
+double nanoseconds_per(std::size_t count, F&& f) {
+  auto start = Clock::now();
+  f();
+  return std::chrono::duration<double, std::nano>(Clock::now() - start).count() /
+         static_cast<double>(count);
+}
+
+void report(const char* name, double single, double batch) {
+  std::printf("%-12s %14.1f %14.1f %10.2fx\n", name, single, batch, single / batch);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::size_t elements = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+  std::size_t lookups = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000000;
+
+  // Metade das buscas acerta (chaves pares presentes, ímpares ausentes).
+  std::mt19937_64 rng(11);
+  std::vector<std::uint64_t> probes(lookups);
+  for (std::uint64_t& probe : probes) probe = rng() % (2 * elements);
+  std::unique_ptr<bool[]> found(new bool[lookups]);
+
+  std::printf("%-12s %14s %14s %11s\n", "", "ns/busca", "ns/busca lote", "ganho");
+  {
+    Set<std::uint64_t> set;
+    std::uint64_t next = 0;
+    set.assign_sorted(elements, [&] { return 2 * next++; });
+
+    std::size_t single_hits = 0;
+    double single = nanoseconds_per(lookups, [&] {
+      for (std::uint64_t probe : probes) single_hits += set.search(probe);
+    });
+    std::size_t batch_hits = 0;
+    double batch = nanoseconds_per(lookups, [&] {
+      batch_hits = set.contains_many(probes.data(), probes.size(), found.get());
+    });
+    if (single_hits != batch_hits) std::printf("resultados divergentes!\n");
+    report("Set", single, batch);
+
+    // Lote já ordenado (junção): uma passada com search_sorted.
+    std::vector<std::uint64_t> sorted = probes;
+    std::sort(sorted.begin(), sorted.end());
+    single_hits = 0;
+    single = nanoseconds_per(lookups, [&] {
+      for (std::uint64_t probe : sorted) single_hits += set.search(probe);
+    });
+    batch = nanoseconds_per(lookups, [&] {
+      batch_hits = set.search_sorted(sorted.data(), sorted.size(), found.get());
+    });
+    if (single_hits != batch_hits) std::printf("resultados divergentes!\n");
+    report("Set ordenado", single, batch);
+  }
+  {
+    // Inserção em ordem embaralhada pelo caminho normal (com rotações): a
+    // AVL fica balanceada, mas os nós ficam espalhados pela memória sem
+    // relação com a ordem das chaves, ao contrário da construção em ordem do
+    // Set acima.
+    Map<std::uint64_t, std::uint64_t> map;
+    std::vector<std::uint64_t> keys(elements);
+    for (std::size_t i = 0; i < elements; ++i) keys[i] = 2 * i;
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (std::uint64_t key : keys) map[key] = key;
+
+    std::size_t single_hits = 0;
+    double single = nanoseconds_per(lookups, [&] {
+      const std::uint64_t* value;
+      for (std::uint64_t probe : probes) single_hits += map.find_many(&probe, 1, &value);
+    });
+    std::vector<const std::uint64_t*> values(lookups);
+    std::size_t batch_hits = 0;
+    double batch = nanoseconds_per(lookups, [&] {
+      batch_hits = map.find_many(probes.data(), probes.size(), values.data());
+    });
+    if (single_hits != batch_hits) std::printf("resultados divergentes!\n");
+    report("Map", single, batch);
+  }
+  return 0;
+}
@@ -0,0 +1,68 @@
+// Mede um fluxo misto de consultas numa AVL maior que o cache (60% busca
+// exata, 30% limite inferior, 10% faixas curtas) executado por corrotinas
+// com diferentes quantidades de consultas em voo; largura 1 equivale a
+// executar uma consulta de cada vez.
+//
+// Uso: coroutine_lookup_bench [elementos] [consultas]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../include/coroutine_lookup.hpp"
+
+int main(int argc, char** argv) {
+  std::size_t elements = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+  std::size_t queries = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+  constexpr std::size_t kChunk = 4096;  // Consultas criadas por vez.
+
+  AVL<std::uint64_t> tree;
+  std::uint64_t next = 0;
+  tree.assign_sorted(elements, [&] { return 2 * next++; });
+
+  std::mt19937_64 rng(5);
+  std::vector<std::uint64_t> probes(queries);
+  std::vector<int> kinds(queries);
+  for (std::size_t i = 0; i < queries; ++i) {
+    probes[i] = rng() % (2 * elements);
+    unsigned draw = static_cast<unsigned>(rng() % 10);
+    kinds[i] = draw < 6 ? 0 : draw < 9 ? 1 : 2;
+  }
+
+  std::printf("%8s %12s\n", "largura", "ns/consulta");
+  for (std::size_t width : {1, 4, 8, 16, 32}) {
+    std::uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t first = 0; first < queries; first += kChunk) {
+      std::size_t last = std::min(queries, first + kChunk);
+      std::vector<Lookup<const std::uint64_t*>> points;
+      std::vector<Lookup<std::size_t>> ranges;
+      points.reserve(kChunk);
+      ranges.reserve(kChunk);
+      Interleaver executor(width);
+      for (std::size_t i = first; i < last; ++i) {
+        if (kinds[i] == 0) {
+          points.push_back(find_async(tree, probes[i]));
+          executor.add(points.back());
+        } else if (kinds[i] == 1) {
+          points.push_back(lower_bound_async(tree, probes[i]));
+          executor.add(points.back());
+        } else {
+          ranges.push_back(range_async(tree, probes[i], probes[i] + 16,
+                                       [&checksum](std::uint64_t v) { checksum += v; }));
+          executor.add(ranges.back());
+        }
+      }
+      executor.run();
+      for (auto& point : points) checksum += point.result() != nullptr;
+    }
+    double elapsed = std::chrono::duration<double, std::nano>(
+                         std::chrono::steady_clock::now() - start).count();
+    std::printf("%8zu %12.1f   (%llu)\n", width, elapsed / static_cast<double>(queries),
+                static_cast<unsigned long long>(checksum));
+  }
+  return 0;
+}
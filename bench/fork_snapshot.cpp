@@ -0,0 +1,98 @@
+// Mede a latência de escritas num Map enquanto um snapshot é gravado:
+// Map::save bloqueante versus save_in_background (fork). As escritas chegam
+// em ritmo fixo (laço aberto), então a latência inclui o tempo de fila
+// acumulado enquanto o escritor está parado.
+//
+// Uso: fork_snapshot_bench [entradas] [intervalo entre escritas em ns]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/fork_snapshot.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+  double p50, p99, max;  // microssegundos
+};
+
+Result run(Map<std::uint64_t, std::uint64_t>& map, bool background,
+           const std::string& path, long interval_ns) {
+  std::mt19937_64 rng(42);
+  std::vector<double> latencies;
+  auto interval = std::chrono::nanoseconds(interval_ns);
+
+  auto start = Clock::now();
+  bool started = false;
+  bool finished = false;
+  Clock::time_point finished_at;
+  BackgroundSnapshot* pending = nullptr;
+  std::vector<BackgroundSnapshot> handles;
+  handles.reserve(1);
+
+  for (std::uint64_t i = 0;; ++i) {
+    auto scheduled = start + interval * static_cast<long>(i);
+    while (Clock::now() < scheduled) {
+    }
+    if (!started && i == 1000) {
+      started = true;
+      if (background) {
+        handles.push_back(save_in_background(map, path));
+        pending = &handles.back();
+      } else {
+        std::ofstream out(path, std::ios::binary);
+        map.save(out);
+        finished = true;
+        finished_at = Clock::now();
+      }
+    }
+    map[rng()] = i;
+    latencies.push_back(
+        std::chrono::duration<double, std::micro>(Clock::now() - scheduled).count());
+
+    if (pending && !finished && pending->done()) {
+      finished = true;
+      finished_at = Clock::now();
+    }
+    // Mede até o dobro do tempo do snapshot depois que ele termina.
+    if (finished && Clock::now() - finished_at > (finished_at - start)) break;
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  auto at = [&](double q) {
+    return latencies[static_cast<std::size_t>(q * (latencies.size() - 1))];
+  };
+  return {at(0.50), at(0.99), latencies.back()};
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::uint64_t entries = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+  long interval = argc > 2 ? std::atol(argv[2]) : 20000;
+  std::string path = "fork_snapshot_bench.bin";
+
+  Map<std::uint64_t, std::uint64_t> map;
+  std::mt19937_64 rng(7);
+  for (std::uint64_t i = 0; i < entries; ++i) map[rng()] = i;
+  std::printf("%llu entradas, uma escrita a cada %ld ns\n",
+              static_cast<unsigned long long>(map.size()), interval);
+
+  std::printf("%12s %10s %10s %12s\n", "modo", "p50 us", "p99 us", "max us");
+  for (bool background : {false, true}) {
+    Result r = run(map, background, path, interval);
+    std::printf("%12s %10.1f %10.1f %12.1f\n",
+                background ? "fork" : "bloqueante", r.p50, r.p99, r.max);
+  }
+  std::remove(path.c_str());
+  return 0;
+}
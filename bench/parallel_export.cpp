@@ -0,0 +1,47 @@
+// Exportação de uma AVL grande (a base do Set) para um vetor: in_order(),
+// in_order(out) num buffer já alocado e parallel_export com 1, 2, 4 e 8 threads.
+//
+// Uso: parallel_export_bench [elementos]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "../include/avl.hpp"
+
+namespace {
+
+template <class F>
+double milliseconds(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+  AVL<std::uint64_t> tree;
+  std::uint64_t next = 0;
+  tree.assign_sorted(n, [&] { return next++ * 3; });
+  std::vector<std::uint64_t> out(n);
+
+  std::printf("%-20s %10s\n", "modo", "ms");
+  std::printf("%-20s %10.1f\n", "in_order()", milliseconds([&] {
+                std::vector<std::uint64_t> copy = tree.in_order();
+                out[0] = copy[0];
+              }));
+  std::printf("%-20s %10.1f\n", "in_order(out)",
+              milliseconds([&] { tree.in_order(out.data()); }));
+  for (unsigned threads : {1u, 2u, 4u, 8u}) {
+    char label[32];
+    std::snprintf(label, sizeof(label), "parallel_export(%u)", threads);
+    std::printf("%-20s %10.1f\n", label,
+                milliseconds([&] { tree.parallel_export(out.data(), threads); }));
+  }
+  return 0;
+}
@@ -0,0 +1,62 @@
+// Carga de chaves estritamente crescentes (séries temporais): AVL::insert
+// a partir da raiz, insert com dedo, append_max e, como referência,
+// std::vector::push_back.
+//
+// Uso: sequential_insert_bench [chaves]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "../include/avl.hpp"
+
+namespace {
+
+template <class F>
+double nanoseconds_per(std::size_t count, F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start)
+             .count() /
+         static_cast<double>(count);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::size_t keys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5000000;
+
+  std::printf("%-14s %12s\n", "modo", "ns/inserção");
+  {
+    AVL<std::uint64_t> tree;
+    double ns = nanoseconds_per(keys, [&] {
+      for (std::uint64_t i = 0; i < keys; ++i) tree.insert(i);
+    });
+    std::printf("%-14s %12.1f\n", "insert", ns);
+  }
+  {
+    AVL<std::uint64_t> tree;
+    AVL<std::uint64_t>::Finger hint;
+    double ns = nanoseconds_per(keys, [&] {
+      for (std::uint64_t i = 0; i < keys; ++i) tree.insert(hint, i);
+    });
+    std::printf("%-14s %12.1f\n", "insert(dedo)", ns);
+  }
+  {
+    AVL<std::uint64_t> tree;
+    double ns = nanoseconds_per(keys, [&] {
+      for (std::uint64_t i = 0; i < keys; ++i) tree.append_max(i);
+    });
+    std::printf("%-14s %12.1f\n", "append_max", ns);
+  }
+  {
+    std::vector<std::uint64_t> vector;
+    double ns = nanoseconds_per(keys, [&] {
+      for (std::uint64_t i = 0; i < keys; ++i) vector.push_back(i);
+    });
+    std::printf("%-14s %12.1f\n", "vector", ns);
+  }
+  return 0;
+}
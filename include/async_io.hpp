@@ -0,0 +1,383 @@
+#pragma once
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Leituras assíncronas de um arquivo, com várias requisições em voo.
+ *
+ * Usa io_uring quando o kernel permite (chamadas de sistema diretas, sem
+ * liburing) e, caso contrário, um conjunto de threads que executam `pread`.
+ * Em ambos os casos até `depth` leituras ficam pendentes ao mesmo tempo, o
+ * que mantém a fila do dispositivo ocupada em vez de esperar uma página por
+ * vez.
+ *
+ * `submit` apenas enfileira; as requisições vão ao kernel (ou às threads) em
+ * lote e as conclusões são colhidas por `wait`. O leitor pertence a uma única
+ * thread: `submit` e `wait` não podem ser chamados concorrentemente.
+ */
+class AsyncReader {
+ public:
+  /**
+   * @brief Mecanismo usado para as leituras.
+   */
+  enum class Backend {
+    kAuto,       ///< io_uring se disponível, senão threads.
+    kIoUring,    ///< Exige io_uring.
+    kThreadPool  ///< Threads com `pread`.
+  };
+
+  /**
+   * @brief Leitura concluída.
+   */
+  struct Completion {
+    std::uint64_t tag;  ///< Valor passado a `submit`.
+    int error;          ///< 0 em caso de sucesso, ou o `errno` da falha.
+  };
+
+  /**
+   * @brief Cria o leitor para o descritor `fd` (que não passa a ser dele).
+   *
+   * @param fd Arquivo lido.
+   * @param depth Máximo de leituras em voo.
+   * @param backend Mecanismo desejado.
+   * @throw std::system_error se `kIoUring` for pedido e não estiver
+   * disponível.
+   * @throw std::invalid_argument se `depth` for zero.
+   */
+  explicit AsyncReader(int fd, std::size_t depth = 64,
+                       Backend backend = Backend::kAuto);
+
+  ~AsyncReader();
+
+  AsyncReader(const AsyncReader&) = delete;
+  AsyncReader& operator=(const AsyncReader&) = delete;
+
+  /**
+   * @brief Mecanismo efetivamente em uso (`kIoUring` ou `kThreadPool`).
+   */
+  Backend backend() const {
+    return ring_fd >= 0 ? Backend::kIoUring : Backend::kThreadPool;
+  }
+
+  /**
+   * @brief Máximo de leituras em voo.
+   */
+  std::size_t depth() const { return slots.size(); }
+
+  /**
+   * @brief Leituras enviadas e ainda não colhidas por `wait`.
+   */
+  std::size_t in_flight() const { return slots.size() - free_slots.size(); }
+
+  /**
+   * @brief Enfileira a leitura de `length` bytes a partir de `offset`.
+   *
+   * O buffer deve continuar válido até a conclusão ser colhida. Uma leitura
+   * curta (fim do arquivo) conclui com `EIO`.
+   *
+   * @throw std::logic_error se já houver `depth()` leituras em voo.
+   */
+  void submit(std::uint64_t offset, char* buffer, std::size_t length,
+              std::uint64_t tag);
+
+  /**
+   * @brief Envia as leituras enfileiradas e espera ao menos uma conclusão.
+   *
+   * @param out Recebe (ao final) as conclusões colhidas.
+   * @return Quantidade de conclusões acrescentadas; 0 se nada estava em voo.
+   */
+  std::size_t wait(std::vector<Completion>& out);
+
+ private:
+  struct Slot {
+    std::uint64_t offset = 0;
+    char* buffer = nullptr;
+    std::size_t length = 0;
+    std::size_t done = 0;  ///< Bytes já lidos.
+    std::uint64_t tag = 0;
+    iovec vector{};        ///< Mantido vivo enquanto a leitura está em voo.
+  };
+
+  bool setup_ring(std::size_t depth);
+  void start_threads(std::size_t count);
+
+  void ring_push(std::size_t slot);
+  void ring_enter(unsigned min_complete);
+  void ring_reap(std::vector<Completion>& out);
+
+  void worker();
+
+  /// Libera o slot e registra a conclusão.
+  void finish(std::size_t slot, int error, std::vector<Completion>& out) {
+    out.push_back({slots[slot].tag, error});
+    free_slots.push_back(slot);
+  }
+
+  int fd;
+  std::vector<Slot> slots;
+  std::vector<std::size_t> free_slots;
+
+  // io_uring.
+  int ring_fd = -1;
+  void* sq_ring = MAP_FAILED;
+  void* cq_ring = MAP_FAILED;
+  std::size_t sq_ring_size = 0;
+  std::size_t cq_ring_size = 0;
+  io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+  std::size_t sqes_size = 0;
+  unsigned* sq_tail = nullptr;
+  unsigned* sq_mask = nullptr;
+  unsigned* sq_array = nullptr;
+  unsigned* cq_head = nullptr;
+  unsigned* cq_tail = nullptr;
+  unsigned* cq_mask = nullptr;
+  io_uring_cqe* cqes = nullptr;
+  unsigned to_submit = 0;  ///< SQEs preenchidas e ainda não enviadas.
+
+  // Threads com pread.
+  std::vector<std::thread> threads;
+  std::mutex mutex;
+  std::condition_variable work_ready;
+  std::condition_variable work_done;
+  std::deque<std::size_t> queue;                    ///< Slots a ler.
+  std::vector<std::pair<std::size_t, int>> results;  ///< (slot, erro).
+  bool stopping = false;
+};
+
+inline AsyncReader::AsyncReader(int fd, std::size_t depth, Backend backend)
+    : fd(fd), slots(depth) {
+  if (depth == 0) throw std::invalid_argument("AsyncReader com profundidade zero");
+  for (std::size_t i = depth; i > 0; --i) free_slots.push_back(i - 1);
+
+  if (backend != Backend::kThreadPool && setup_ring(depth)) return;
+  if (backend == Backend::kIoUring) {
+    throw std::system_error(errno, std::generic_category(), "io_uring_setup");
+  }
+  start_threads(std::min<std::size_t>(depth, 16));
+}
+
+inline AsyncReader::~AsyncReader() {
+  if (ring_fd >= 0) {
+    // As leituras em voo escrevem em buffers do chamador: espera todas.
+    std::vector<Completion> ignored;
+    while (in_flight() > 0) {
+      try {
+        wait(ignored);
+      } catch (...) {
+        break;
+      }
+    }
+    if (sqes != MAP_FAILED) ::munmap(sqes, sqes_size);
+    if (cq_ring != MAP_FAILED && cq_ring != sq_ring) ::munmap(cq_ring, cq_ring_size);
+    if (sq_ring != MAP_FAILED) ::munmap(sq_ring, sq_ring_size);
+    ::close(ring_fd);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  work_ready.notify_all();
+  for (std::thread& t : threads) t.join();
+}
+
+inline bool AsyncReader::setup_ring(std::size_t depth) {
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  long result = ::syscall(__NR_io_uring_setup, static_cast<unsigned>(depth), &params);
+  if (result < 0) return false;
+  ring_fd = static_cast<int>(result);
+
+  sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single) sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+
+  sq_ring = ::mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+  if (sq_ring != MAP_FAILED) {
+    cq_ring = single ? sq_ring
+                     : ::mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+  }
+  sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+  if (cq_ring != MAP_FAILED) {
+    sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+                                             MAP_SHARED | MAP_POPULATE, ring_fd,
+                                             IORING_OFF_SQES));
+  }
+  if (sqes == MAP_FAILED) {
+    int error = errno;
+    if (cq_ring != MAP_FAILED && cq_ring != sq_ring) ::munmap(cq_ring, cq_ring_size);
+    if (sq_ring != MAP_FAILED) ::munmap(sq_ring, sq_ring_size);
+    ::close(ring_fd);
+    ring_fd = -1;
+    errno = error;
+    return false;
+  }
+
+  char* sq = static_cast<char*>(sq_ring);
+  char* cq = static_cast<char*>(cq_ring);
+  sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+  cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+  return true;
+}
+
+inline void AsyncReader::start_threads(std::size_t count) {
+  for (std::size_t i = 0; i < count; ++i) threads.emplace_back([this] { worker(); });
+}
+
+inline void AsyncReader::submit(std::uint64_t offset, char* buffer,
+                                std::size_t length, std::uint64_t tag) {
+  if (free_slots.empty()) throw std::logic_error("AsyncReader: fila cheia");
+  std::size_t slot = free_slots.back();
+  free_slots.pop_back();
+  Slot& s = slots[slot];
+  s.offset = offset;
+  s.buffer = buffer;
+  s.length = length;
+  s.done = 0;
+  s.tag = tag;
+
+  if (ring_fd >= 0) {
+    ring_push(slot);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.push_back(slot);
+  }
+  work_ready.notify_one();
+}
+
+inline void AsyncReader::ring_push(std::size_t slot) {
+  // O anel de submissão tem ao menos `depth` entradas e nunca há mais de
+  // `depth` leituras em voo, então sempre há espaço.
+  Slot& s = slots[slot];
+  s.vector.iov_base = s.buffer + s.done;
+  s.vector.iov_len = s.length - s.done;
+
+  unsigned tail = *sq_tail;
+  unsigned index = tail & *sq_mask;
+  io_uring_sqe* sqe = &sqes[index];
+  std::memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = IORING_OP_READV;
+  sqe->fd = fd;
+  sqe->off = s.offset + s.done;
+  sqe->addr = reinterpret_cast<std::uint64_t>(&s.vector);
+  sqe->len = 1;
+  sqe->user_data = slot;
+  sq_array[index] = index;
+  __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+  ++to_submit;
+}
+
+inline void AsyncReader::ring_enter(unsigned min_complete) {
+  while (true) {
+    long result = ::syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete,
+                            min_complete > 0 ? IORING_ENTER_GETEVENTS : 0u,
+                            nullptr, 0);
+    if (result >= 0) {
+      to_submit -= static_cast<unsigned>(result);
+      return;
+    }
+    if (errno != EINTR) {
+      throw std::system_error(errno, std::generic_category(), "io_uring_enter");
+    }
+  }
+}
+
+inline void AsyncReader::ring_reap(std::vector<Completion>& out) {
+  unsigned head = *cq_head;
+  unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head) {
+    const io_uring_cqe& cqe = cqes[head & *cq_mask];
+    std::size_t slot = static_cast<std::size_t>(cqe.user_data);
+    Slot& s = slots[slot];
+    if (cqe.res < 0) {
+      finish(slot, -cqe.res, out);
+    } else if (cqe.res == 0) {
+      finish(slot, EIO, out);
+    } else {
+      s.done += static_cast<std::size_t>(cqe.res);
+      if (s.done == s.length) {
+        finish(slot, 0, out);
+      } else {
+        ring_push(slot);  // Leitura curta: pede o restante.
+      }
+    }
+  }
+  __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+}
+
+inline std::size_t AsyncReader::wait(std::vector<Completion>& out) {
+  std::size_t before = out.size();
+  if (in_flight() == 0) return 0;
+
+  if (ring_fd >= 0) {
+    while (out.size() == before) {
+      ring_enter(1);
+      ring_reap(out);
+      if (to_submit > 0) ring_enter(0);
+    }
+    return out.size() - before;
+  }
+
+  std::vector<std::pair<std::size_t, int>> ready;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    work_done.wait(lock, [this] { return !results.empty(); });
+    ready.swap(results);
+  }
+  for (auto [slot, error] : ready) finish(slot, error, out);
+  return out.size() - before;
+}
+
+inline void AsyncReader::worker() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    work_ready.wait(lock, [this] { return stopping || !queue.empty(); });
+    if (queue.empty()) return;
+    std::size_t slot = queue.front();
+    queue.pop_front();
+    Slot s = slots[slot];
+    lock.unlock();
+
+    int error = 0;
+    while (s.done < s.length) {
+      ssize_t got = ::pread(fd, s.buffer + s.done, s.length - s.done,
+                            static_cast<off_t>(s.offset + s.done));
+      if (got < 0 && errno == EINTR) continue;
+      if (got <= 0) {
+        error = got < 0 ? errno : EIO;
+        break;
+      }
+      s.done += static_cast<std::size_t>(got);
+    }
+
+    lock.lock();
+    results.emplace_back(slot, error);
+    work_done.notify_one();
+  }
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <limits>
+
+/**
+ * @file
+ * @brief Agregados mantidos nos nós da `AVL` (e do `Map`).
+ *
+ * Um agregado é um monoide sobre os valores da árvore. O tipo passado como
+ * `Augment` em `AVL<T, Augment>` define:
+ *
+ * - `value_type`: tipo do agregado;
+ * - `static value_type identity()`: elemento neutro;
+ * - `static value_type combine(const value_type& a, const value_type& b)`:
+ *   operação associativa (não precisa ser comutativa: `a` vem antes de `b`
+ *   na ordem da árvore);
+ * - `static value_type measure(const T& value)`: agregado de um único valor.
+ *   No `Map`, `measure(const K& key, const V& value)`.
+ *
+ * Os tipos abaixo cobrem os casos comuns sobre o valor armazenado (ou sobre
+ * o valor associado, no `Map`).
+ */
+
+/**
+ * @brief Campo que cada nó de uma árvore com agregado carrega: o agregado
+ * da subárvore, sempre atualizado pelas operações que alteram a árvore (ver
+ * `AVL::modify`), de modo que as consultas só o leem.
+ */
+template <class Augment>
+struct AugmentSlot {
+  using value_type = typename Augment::value_type;
+  typename Augment::value_type summary = Augment::identity();
+};
+
+/// Sem agregado: os nós não carregam nenhum campo extra.
+template <>
+struct AugmentSlot<void> {
+  using value_type = void;
+};
+
+/**
+ * @brief Soma dos valores.
+ */
+template <class V>
+struct SumOf {
+  using value_type = V;
+  static value_type identity() { return V(); }
+  static value_type combine(const value_type& a, const value_type& b) { return a + b; }
+  static value_type measure(const V& value) { return value; }
+  template <class K>
+  static value_type measure(const K&, const V& value) {
+    return value;
+  }
+};
+
+/**
+ * @brief Menor valor; o neutro é o maior valor representável.
+ */
+template <class V>
+struct MinOf {
+  using value_type = V;
+  static value_type identity() { return std::numeric_limits<V>::max(); }
+  static value_type combine(const value_type& a, const value_type& b) { return b < a ? b : a; }
+  static value_type measure(const V& value) { return value; }
+  template <class K>
+  static value_type measure(const K&, const V& value) {
+    return value;
+  }
+};
+
+/**
+ * @brief Maior valor; o neutro é o menor valor representável.
+ */
+template <class V>
+struct MaxOf {
+  using value_type = V;
+  static value_type identity() { return std::numeric_limits<V>::lowest(); }
+  static value_type combine(const value_type& a, const value_type& b) { return a < b ? b : a; }
+  static value_type measure(const V& value) { return value; }
+  template <class K>
+  static value_type measure(const K&, const V& value) {
+    return value;
+  }
+};
+
+/**
+ * @brief Quantidade de elementos.
+ */
+struct CountOf {
+  using value_type = std::size_t;
+  static value_type identity() { return 0; }
+  static value_type combine(const value_type& a, const value_type& b) { return a + b; }
+  template <class... Values>
+  static value_type measure(const Values&...) {
+    return 1;
+  }
+};
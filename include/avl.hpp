@@ -1,8 +1,25 @@
 #pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
 #include <utility>
 #include <vector>
 #include <cmath>
 
+#include "augment.hpp"
+#include "distance.hpp"
+#include "epoch.hpp"
+#include "prefetch.hpp"
+#include "serial.hpp"
+#include "traversal.hpp"
+
 /**
  * @brief Classe que representa uma Árvore Binária de Busca (BST).
  *
@@ -10,14 +27,16 @@
  * inserção e remoção.
  *
  * @tparam T Tipo dos elementos armazenados na árvore.
+ * @tparam Augment Agregado mantido em cada nó (ver `augment.hpp`), ou `void`
+ * para nenhum.
  */
-template <class T>
+template <class T, class Augment = void>
 class AVL {
  private:
   /**
    * @brief Estrutura interna que representa um nó da árvore.
    */
-  struct TreeNode {
+  struct TreeNode : AugmentSlot<Augment> {
     T data;           ///< Valor armazenado no nó.
     TreeNode* left;   ///< Ponteiro para o filho à esquerda.
     TreeNode* right;  ///< Ponteiro para o filho à direita.
@@ -58,6 +77,26 @@ class AVL {
    */
   int height(TreeNode* node) const;
 
+  static constexpr bool kAugmented = !std::is_void<Augment>::value;
+  using Slot = AugmentSlot<Augment>;
+
+  /**
+   * @brief Recalcula a altura do nó e, se houver agregado, o agregado da
+   * subárvore a partir dos filhos.
+   */
+  static void update(TreeNode* node);
+
+  /**
+   * @brief Agregado da subárvore (`Augment::identity()` se vazia).
+   */
+  static typename Slot::value_type summary(const TreeNode* node);
+
+  /**
+   * @brief Agregado dos valores da subárvore em [*lo, *hi); limite nulo
+   * significa sem limite daquele lado.
+   */
+  static typename Slot::value_type fold(const TreeNode* node, const T* lo, const T* hi);
+
   /**
    * @brief Atualiza o balanceamento da árvore AVL a partir de um nó.
    *
@@ -79,6 +118,93 @@ class AVL {
    */
   bool insert(TreeNode*& node, const T& value);
 
+  /**
+   * @brief Constrói uma subárvore perfeitamente balanceada com `n` elementos.
+   *
+   * Consome os elementos de `next` em ordem (esquerda, nó, direita), de modo
+   * que uma sequência crescente resulta numa árvore de busca válida.
+   *
+   * @param n Quantidade de elementos.
+   * @param next Gerador chamado uma vez por elemento.
+   * @return Raiz da subárvore construída.
+   */
+  template <class Generator>
+  static TreeNode* build(std::size_t n, Generator& next);
+
+  /**
+   * @brief Clona uma subárvore iterativamente, preservando sua forma.
+   *
+   * @param node Raiz da subárvore de origem.
+   * @return Raiz da cópia, ou nullptr se `node` for nulo.
+   */
+  static TreeNode* clone(const TreeNode* node);
+
+  /**
+   * @brief Libera um nó já desligado da árvore.
+   *
+   * Zera os filhos (o destrutor do nó é recursivo) e, se houver um domínio de
+   * recuperação configurado, aposenta o nó em vez de apagá-lo imediatamente.
+   *
+   * @param node Nó removido da árvore.
+   */
+  void dispose(TreeNode* node);
+
+  /**
+   * @brief Libera todos os nós de uma subárvore desligada, iterativamente.
+   *
+   * @param node Raiz da subárvore.
+   * @return Quantidade de nós liberados.
+   */
+  std::size_t release(TreeNode* node);
+
+  /**
+   * @brief Conta os nós de uma subárvore, iterativamente.
+   */
+  static std::size_t tally(const TreeNode* node);
+
+  /**
+   * @brief Une `left`, `middle` e `right` numa árvore AVL em O(|h(left) -
+   * h(right)| + 1).
+   *
+   * Todos os valores de `left` devem ser menores que `middle->data` e todos os
+   * de `right`, maiores. A árvore mais baixa é pendurada na borda da mais
+   * alta, na primeira subárvore de altura compatível, e o caminho é
+   * rebalanceado na volta.
+   *
+   * @return Raiz da árvore unida.
+   */
+  TreeNode* join(TreeNode* left, TreeNode* middle, TreeNode* right);
+
+  /**
+   * @brief Une duas árvores AVL sem nó intermediário (`left` < `right`),
+   * usando o mínimo de `right` como raiz da junção.
+   */
+  TreeNode* join(TreeNode* left, TreeNode* right);
+
+  /**
+   * @brief Divide a subárvore em valores menores que `value` e os demais, em
+   * O(log n). Os nós são reaproveitados.
+   *
+   * @return Par (menores que `value`, maiores ou iguais a `value`).
+   */
+  std::pair<TreeNode*, TreeNode*> split(TreeNode* node, const T& value);
+
+  /**
+   * @brief Desliga o menor nó da subárvore, rebalanceando o caminho até ele.
+   *
+   * @param node Raiz da subárvore (não nula).
+   * @param min Recebe o nó desligado.
+   * @return Nova raiz da subárvore.
+   */
+  TreeNode* detach_min(TreeNode* node, TreeNode*& min);
+
+  /**
+   * @brief Separa da árvore os valores do intervalo [lo, hi).
+   *
+   * @return Raiz da subárvore separada, já desligada de `root`.
+   */
+  TreeNode* cut_range(const T& lo, const T& hi);
+
   /**
    * @brief Remove um valor da árvore recursivamente.
    *
@@ -99,37 +225,30 @@ class AVL {
   bool contain(const TreeNode* const node, const T& value) const;
 
   /**
-   * @brief Executa a travessia in-order recursiva.
+   * @brief Busca exata que tolera as costuras de uma travessia de Morris em
+   * andamento.
    *
-   * Visita a subárvore esquerda, depois o nó atual e em seguida a subárvore
-   * direita. Os valores visitados são armazenados em `result`.
-   *
-   * @param node Ponteiro para o nó atual.
-   * @param result Vetor onde os valores visitados serão armazenados.
+   * Uma costura liga o predecessor de um nó ao próprio nó, que é sempre o
+   * último ancestral em que a descida virou à esquerda; ao encontrá-lo pela
+   * direita, a busca o trata como um filho nulo.
    */
-  void in_order(const TreeNode* const node, std::vector<T>& result) const;
+  const TreeNode* find_threaded(const T& value) const;
 
   /**
-   * @brief Executa a travessia pre-order recursiva.
-   *
-   * Visita o nó atual, em seguida a subárvore esquerda e depois a direita.
-   * Os valores visitados são armazenados em `result`.
-   *
-   * @param node Ponteiro para o nó atual.
-   * @param result Vetor onde os valores visitados serão armazenados.
+   * @brief Nó com o menor valor maior que `value` (ou igual, se `inclusive`).
    */
-  void pre_order(const TreeNode* const node, std::vector<T>& result) const;
+  const TreeNode* above(const T& value, bool inclusive) const;
 
   /**
-   * @brief Executa a travessia post-order recursiva.
-   *
-   * Visita a subárvore esquerda, depois a direita e por último o nó atual.
-   * Os valores visitados são armazenados em `result`.
-   *
-   * @param node Ponteiro para o nó atual.
-   * @param result Vetor onde os valores visitados serão armazenados.
+   * @brief Nó com o maior valor menor que `value` (ou igual, se `inclusive`).
+   */
+  const TreeNode* below(const T& value, bool inclusive) const;
+
+  /**
+   * @brief Parte recursiva de `search_sorted` para o lote [first, last).
    */
-  void post_order(const TreeNode* const node, std::vector<T>& result) const;
+  std::size_t search_sorted(const TreeNode* node, const T* first, const T* last,
+                            bool* found) const;
 
  public:
   /**
@@ -142,6 +261,39 @@ class AVL {
    */
   ~AVL();
 
+  /**
+   * @brief Construtor de cópia profunda.
+   *
+   * Clona a estrutura de `other` nó a nó numa única passagem iterativa, sem
+   * comparações nem rebalanceamento. A cópia não herda o domínio de
+   * recuperação configurado em `other`.
+   *
+   * @param other Árvore a ser copiada.
+   */
+  AVL(const AVL& other);
+
+  /**
+   * @brief Construtor de movimento em O(1); `other` fica vazia.
+   *
+   * @param other Árvore cujos nós serão transferidos.
+   */
+  AVL(AVL&& other) noexcept;
+
+  /**
+   * @brief Atribuição por cópia ou movimento (copy-and-swap).
+   *
+   * @param other Árvore recebida por valor (copiada ou movida).
+   * @return Referência para esta árvore.
+   */
+  AVL& operator=(AVL other) noexcept;
+
+  /**
+   * @brief Troca o conteúdo com outra árvore em O(1).
+   *
+   * @param other Árvore com a qual o conteúdo será trocado.
+   */
+  void swap(AVL& other) noexcept;
+
   /**
    * @brief Insere um novo valor na árvore.
    *
@@ -150,6 +302,59 @@ class AVL {
    */
   bool insert(const T& value);
 
+  /**
+   * @brief Posição guardada entre inserções próximas ("dedo").
+   *
+   * Guarda o caminho da raiz até o último nó inserido, com a faixa de
+   * valores que cabe em cada subárvore do caminho. Uma inserção com dica
+   * sobe só até o primeiro ancestral cuja faixa contém o novo valor e desce
+   * dali, em vez de partir da raiz. O dedo é descartado (e refeito a partir
+   * da raiz) sempre que a árvore é alterada por outra operação; não pode
+   * sobreviver à árvore.
+   */
+  class Finger {
+   public:
+    Finger() = default;
+
+   private:
+    friend class AVL;
+
+    struct Step {
+      TreeNode* node;
+      const T* lower;  ///< Valores da subárvore são > *lower (nulo = -inf).
+      const T* upper;  ///< Valores da subárvore são < *upper (nulo = +inf).
+    };
+
+    std::vector<Step> path;
+    const AVL* tree = nullptr;
+    std::uint64_t version = 0;  ///< Versão da árvore em que o caminho vale.
+  };
+
+  /**
+   * @brief Insere um valor partindo da posição guardada em `hint`.
+   *
+   * Para valores próximos do anterior (cargas ordenadas ou quase), a
+   * descida e o rebalanceamento custam O(1) amortizado. Ao retornar, `hint`
+   * aponta para o valor inserido (ou para o já existente).
+   *
+   * @param hint Dedo de uma inserção anterior, ou um `Finger` novo.
+   * @param value Valor a ser inserido.
+   * @return `true` se o valor foi inserido, `false` se já existia.
+   */
+  bool insert(Finger& hint, const T& value);
+
+  /**
+   * @brief Insere um valor maior que todos os da árvore na ponta direita.
+   *
+   * Mantém internamente o dedo da última inserção, então uma sequência de
+   * chaves crescentes custa O(1) amortizado por inserção, incluindo o
+   * rebalanceamento.
+   *
+   * @param value Valor a ser inserido.
+   * @throw std::invalid_argument se `value` não for maior que o máximo.
+   */
+  void append_max(const T& value);
+
   /**
    * @brief Remove um valor da árvore.
    *
@@ -158,6 +363,31 @@ class AVL {
    */
   bool remove(const T& value);
 
+  /**
+   * @brief Remove todos os valores do intervalo [lo, hi).
+   *
+   * Divide a árvore em `lo` e em `hi` e une as pontas, em O(log n) mais a
+   * liberação dos k nós removidos; não há uma descida e um rebalanceamento
+   * por valor como em chamadas sucessivas de `remove`.
+   *
+   * @param lo Início do intervalo (incluído).
+   * @param hi Fim do intervalo (excluído).
+   * @return Quantidade de valores removidos.
+   */
+  std::size_t erase_range(const T& lo, const T& hi);
+
+  /**
+   * @brief Move os valores do intervalo [lo, hi) para uma nova árvore.
+   *
+   * Os nós são transferidos sem cópia, em O(log n) mais a contagem dos k
+   * nós transferidos. O domínio de recuperação não é transferido.
+   *
+   * @param lo Início do intervalo (incluído).
+   * @param hi Fim do intervalo (excluído).
+   * @return Árvore com os valores removidos.
+   */
+  AVL extract_range(const T& lo, const T& hi);
+
   /**
    * @brief Verifica se um valor está presente na árvore.
    *
@@ -166,6 +396,126 @@ class AVL {
    */
   bool contain(const T& value) const;
 
+  /**
+   * @brief Ponteiro para o valor igual a `value`, ou `nullptr`.
+   */
+  const T* find(const T& value) const;
+
+  /**
+   * @brief Ponteiro para o valor igual a `value`, para alteração pelo
+   * chamador, ou `nullptr`. Só existe sem agregado; com agregado, use
+   * `modify`.
+   *
+   * A parte do valor que define a ordem não pode mudar.
+   */
+  T* find_for_update(const T& value);
+
+  /**
+   * @brief Altera o valor igual a `value` com `f(T&)` e, com agregado,
+   * recalcula os agregados do caminho até ele, em O(log n).
+   *
+   * `f` não pode mudar a parte do valor que define a ordem. Se `f` lançar
+   * uma exceção, os agregados são recalculados mesmo assim.
+   *
+   * @return `true` se o valor foi encontrado.
+   */
+  template <class F>
+  bool modify(const T& value, F&& f);
+
+  /// Tipo do agregado (`void` sem `Augment`).
+  using Summary = typename Slot::value_type;
+
+  /**
+   * @brief Agregado dos valores em [lo, hi), em O(log n).
+   *
+   * Combina, na ordem da árvore, os agregados das subárvores inteiramente
+   * contidas no intervalo com os valores das duas bordas. Os agregados já
+   * estão atualizados, então a consulta só lê a árvore e pode ser feita por
+   * vários leitores ao mesmo tempo, como as demais consultas `const`.
+   *
+   * @param lo Início do intervalo (incluído).
+   * @param hi Fim do intervalo (excluído).
+   * @return O agregado, ou `Augment::identity()` se o intervalo for vazio.
+   */
+  Summary aggregate(const T& lo, const T& hi) const;
+
+  /**
+   * @brief Agregado de todos os valores, em O(1).
+   */
+  Summary aggregate() const;
+
+  /**
+   * @name Consultas por ordem
+   *
+   * Descidas iterativas de O(h) que usam apenas `<`. Devolvem um ponteiro
+   * para o valor guardado na árvore, ou `nullptr` se não houver; o ponteiro
+   * vale até a próxima alteração da árvore.
+   * @{
+   */
+  const T* lower_bound(const T& value) const;  ///< Menor valor >= `value`.
+  const T* upper_bound(const T& value) const;  ///< Menor valor > `value`.
+  const T* ceiling(const T& value) const;      ///< Igual a `lower_bound`.
+  const T* floor(const T& value) const;        ///< Maior valor <= `value`.
+  const T* successor(const T& value) const;    ///< Igual a `upper_bound`.
+  const T* predecessor(const T& value) const;  ///< Maior valor < `value`.
+
+  /**
+   * @brief Valor mais próximo de `value`; no empate, o menor.
+   *
+   * Compara as distâncias `value - floor` e `ceiling - value` com
+   * `closer_above`, então exige que `T` tenha subtração e que o resultado
+   * tenha `<`; para inteiros o cálculo não transborda.
+   */
+  const T* nearest(const T& value) const;
+  /** @} */
+
+  /**
+   * @brief Busca vários valores de uma vez, intercalando as descidas.
+   *
+   * As buscas avançam em grupos de `kBatchGroup`, um nível por vez: a cada
+   * passo cada descida do grupo compara um nó e pede (prefetch) o filho
+   * seguinte, de modo que as faltas de cache das várias descidas se
+   * sobrepõem em vez de serem esperadas uma a uma.
+   *
+   * @param values Valores buscados.
+   * @param n Quantidade de valores.
+   * @param found Recebe, para cada valor, um ponteiro para o elemento
+   * armazenado ou `nullptr` se ausente.
+   * @return Quantidade de valores encontrados.
+   */
+  std::size_t find_many(const T* values, std::size_t n, const T** found) const;
+
+  /**
+   * @brief Verifica a presença de vários valores (ver `find_many`).
+   *
+   * @param values Valores buscados.
+   * @param n Quantidade de valores.
+   * @param found Recebe, para cada valor, se ele está presente.
+   * @return Quantidade de valores encontrados.
+   */
+  std::size_t contains_many(const T* values, std::size_t n, bool* found) const;
+
+  /// Descidas avançadas juntas por `find_many`.
+  static constexpr std::size_t kBatchGroup = 16;
+
+  /**
+   * @brief Verifica a presença de um lote ordenado de valores numa única
+   * passada pela árvore.
+   *
+   * Em cada nó o lote é dividido entre as subárvores (busca binária pelo
+   * valor do nó), então os prefixos de caminho comuns são percorridos uma
+   * vez só: k consultas custam O(k log(n/k)) em vez de k descidas completas.
+   * Quando restam poucos valores numa subárvore, eles descem intercalados e
+   * com prefetch, como em `find_many`.
+   *
+   * @param values Valores em ordem não decrescente (repetições permitidas).
+   * @param n Quantidade de valores.
+   * @param found Recebe, para cada valor, se ele está presente.
+   * @return Quantidade de valores encontrados.
+   * @throw std::invalid_argument se `values` não estiver ordenado.
+   */
+  std::size_t search_sorted(const T* values, std::size_t n, bool* found) const;
+
   /**
    * @brief Retorna os valores da árvore em ordem (in-order).
    *
@@ -193,6 +543,89 @@ class AVL {
    */
   std::vector<T> post_order() const;
 
+  /**
+   * @name Visitantes
+   *
+   * Travessias iterativas (sem recursão, sem alocação enquanto o caminho
+   * tiver até 96 níveis) que chamam `f(const T&)` em cada valor. Se `f`
+   * devolver `bool`, `false` interrompe a travessia.
+   *
+   * @return `true` se todos os valores foram visitados.
+   * @{
+   */
+  template <class F>
+  bool for_each_in_order(F&& f) const;
+  template <class F>
+  bool for_each_pre_order(F&& f) const;
+  template <class F>
+  bool for_each_post_order(F&& f) const;
+  /** @} */
+
+  /**
+   * @name Travessias para um iterador de saída
+   *
+   * Escrevem os valores em `out` (por exemplo, um buffer do chamador ou
+   * `std::back_inserter`) sem vetor intermediário.
+   *
+   * @return O iterador após o último valor escrito.
+   * @{
+   */
+  template <class OutputIt>
+  OutputIt in_order(OutputIt out) const;
+  template <class OutputIt>
+  OutputIt pre_order(OutputIt out) const;
+  template <class OutputIt>
+  OutputIt post_order(OutputIt out) const;
+  /** @} */
+
+  /**
+   * @name Travessia em ordem de Morris
+   *
+   * Como `for_each_in_order` e `in_order(out)`, mas com O(1) de memória
+   * extra em qualquer forma de árvore, ao custo de cerca do dobro de passos
+   * (ver `walk_morris`). Os ponteiros dos nós são alterados e restaurados
+   * durante a chamada, por isso os métodos não são `const`: não pode haver
+   * outros leitores ao mesmo tempo. O próprio visitante pode consultar a
+   * árvore com `contain` e `find`, mas não alterá-la nem usar outras
+   * consultas. Uma interrupção pelo visitante ainda percorre o restante da
+   * árvore.
+   * @{
+   */
+  template <class F>
+  bool for_each_in_order_morris(F&& f);
+  template <class OutputIt>
+  OutputIt in_order_morris(OutputIt out);
+  /** @} */
+
+  /**
+   * @brief Visita os valores em ordem repartindo a árvore entre threads.
+   *
+   * Chama `f(const T&, std::size_t posição)`, em que a posição é o índice do
+   * valor na ordem crescente; as chamadas são concorrentes e fora de ordem
+   * (ver `walk_in_order_parallel`). A árvore não pode ser alterada durante a
+   * visita.
+   *
+   * @param f Visitante; deve aceitar chamadas concorrentes.
+   * @param threads Quantidade de threads, incluindo a chamadora; 0 usa
+   * `std::thread::hardware_concurrency()` (ou uma só thread em árvores com
+   * menos de `kParallelMin` valores).
+   */
+  template <class F>
+  void parallel_for_each_in_order(F&& f, unsigned threads = 0) const;
+
+  /**
+   * @brief Copia os valores em ordem para `out` usando várias threads.
+   *
+   * @param out Buffer com pelo menos `size()` elementos já construídos; cada
+   * posição é atribuída uma vez.
+   * @param threads Como em `parallel_for_each_in_order`.
+   * @return `out + size()`.
+   */
+  T* parallel_export(T* out, unsigned threads = 0) const;
+
+  /// Tamanho mínimo para `threads = 0` usar mais de uma thread.
+  static constexpr std::size_t kParallelMin = std::size_t{1} << 14;
+
   /**
    * @brief Verifica se a árvore está balanceada (propriedade da AVL).
    *
@@ -220,12 +653,93 @@ class AVL {
     return {balanced, node_height};
   }
 
+  /**
+   * @brief Retorna a quantidade de elementos da árvore.
+   */
+  std::size_t size() const { return count; }
+
+  /**
+   * @brief Verifica se a árvore está vazia.
+   */
+  bool empty() const { return count == 0; }
+
+  /**
+   * @brief Substitui o conteúdo por `n` valores em ordem crescente, em O(n).
+   *
+   * Monta de baixo para cima uma árvore perfeitamente balanceada, sem
+   * comparações, descidas a partir da raiz ou rotações. Se `next` lançar uma
+   * exceção, a árvore permanece inalterada.
+   *
+   * @param n Quantidade de valores.
+   * @param next Gerador chamado `n` vezes; deve devolver valores em ordem
+   * estritamente crescente.
+   */
+  template <class Generator>
+  void assign_sorted(std::size_t n, Generator&& next);
+
+  /**
+   * @brief Grava a árvore preservando exatamente a sua forma.
+   *
+   * Os valores são gravados em pré-ordem, em blocos no formato de
+   * `SnapshotHeader` (tipo `kShape`), cada um acompanhado de um byte com os
+   * bits de forma do nó (1 = tem filho à esquerda, 2 = tem filho à direita).
+   * As alturas não são gravadas: são recalculadas da forma na leitura.
+   *
+   * @param out Fluxo binário de saída.
+   * @throw std::runtime_error se a escrita falhar.
+   */
+  void save_shape(std::ostream& out) const;
+
+  /**
+   * @brief Substitui o conteúdo por uma árvore gravada com `save_shape`.
+   *
+   * Restaura a forma idêntica numa única passada linear e iterativa, sem
+   * comparações nem rotações. Em caso de erro a árvore permanece inalterada.
+   *
+   * @param in Fluxo binário de entrada.
+   * @throw std::runtime_error se o snapshot for inválido ou incompatível ou
+   * se a forma gravada não satisfizer a propriedade AVL.
+   */
+  void load_shape(std::istream& in);
+
+  /**
+   * @brief Define o domínio de recuperação usado para liberar nós removidos.
+   *
+   * Com um domínio configurado, `remove` aposenta os nós em `domain` em vez de
+   * apagá-los, de modo que um nó obtido por um leitor fixado
+   * (`EpochDomain::pin`) continue alocado até o fim da fixação.
+   *
+   * Isso apenas adia a liberação: não torna a árvore segura para leitores
+   * sem trava. A remoção zera as ligações do nó retirado e, com dois filhos,
+   * copia o sucessor no lugar, e as rotações reescrevem ligações; leitores
+   * concorrentes ainda precisam excluir o escritor (por exemplo, com uma
+   * trava de leitura). Para leituras sem trava, use `RcuAVL`.
+   *
+   * @param domain Domínio de recuperação, ou `nullptr` para apagar os nós
+   * imediatamente (padrão). Deve sobreviver à árvore.
+   */
+  void set_reclaimer(EpochDomain* domain) { reclaimer = domain; }
+
  private:
+  friend struct CoroutineAccess;  ///< Buscas intercaladas (C++20).
+
+  /**
+   * @brief Atualiza alturas e rebalanceia subindo pelo caminho do dedo,
+   * parando assim que uma subárvore mantém a altura (sem agregado); corrige
+   * o caminho após uma rotação.
+   */
+  void retrace(std::vector<typename Finger::Step>& path, const T& value);
+
   TreeNode* root;  ///< Ponteiro para a raiz da árvore.
+  EpochDomain* reclaimer;  ///< Domínio para nós removidos, se houver.
+  std::size_t count;       ///< Quantidade de elementos.
+  bool threaded = false;   ///< Travessia de Morris em andamento.
+  std::uint64_t version;   ///< Muda a cada alteração; invalida os dedos.
+  Finger tail;             ///< Dedo de `append_max`.
 };
 
-template <class T>
-int AVL<T>::height(TreeNode* node) const {
+template <class T, class Augment>
+int AVL<T, Augment>::height(TreeNode* node) const {
     if (node != nullptr) {
     return node->height;
     } else {
@@ -233,8 +747,8 @@ int AVL<T>::height(TreeNode* node) const {
     }
 }
 
-template <class T>
-void AVL<T>::balance(TreeNode*& node) {
+template <class T, class Augment>
+void AVL<T, Augment>::balance(TreeNode*& node) {
     if (!node) return;
 
     int balanceFactor = height(node->left) - height(node->right);
@@ -247,13 +761,16 @@ void AVL<T>::balance(TreeNode*& node) {
             leftChild->right = leftRightChild->left;
             leftRightChild->left = leftChild;
             node->left = leftRightChild;
+
+            update(leftChild);
+            update(leftRightChild);
         }
         TreeNode* leftChild = node->left;
         node->left = leftChild->right;
         leftChild->right = node;
 
-        node->height = std::max(height(node->left), height(node->right)) + 1;
-        leftChild->height = std::max(height(leftChild->left), height(leftChild->right)) + 1;
+        update(node);
+        update(leftChild);
 
         node = leftChild;
     }
@@ -266,120 +783,749 @@ void AVL<T>::balance(TreeNode*& node) {
             rightChild->left = rightLeftChild->right;
             rightLeftChild->right = rightChild;
             node->right = rightLeftChild;
+
+            update(rightChild);
+            update(rightLeftChild);
         }
         TreeNode* rightChild = node->right;
         node->right = rightChild->left;
         rightChild->left = node;
 
-        node->height = std::max(height(node->left), height(node->right)) + 1;
-        rightChild->height = std::max(height(rightChild->left), height(rightChild->right)) + 1;
+        update(node);
+        update(rightChild);
 
         node = rightChild;
     } else {
-        node->height = std::max(height(node->left), height(node->right)) + 1;
+        update(node);
     }
 }
 
-template <class T>
-AVL<T>::TreeNode::TreeNode(const T& value) : data(value), left(nullptr), right(nullptr), height(1) {}
+template <class T, class Augment>
+AVL<T, Augment>::TreeNode::TreeNode(const T& value) : data(value), left(nullptr), right(nullptr), height(1) {
+    if constexpr (kAugmented) this->summary = Augment::measure(data);
+}
 
-template <class T>
-AVL<T>::TreeNode::~TreeNode() {
+template <class T, class Augment>
+AVL<T, Augment>::TreeNode::~TreeNode() {
     delete left;
     delete right;
 }
 
-template <class T>
-typename AVL<T>::TreeNode* AVL<T>::TreeNode::max() {
+template <class T, class Augment>
+typename AVL<T, Augment>::TreeNode* AVL<T, Augment>::TreeNode::max() {
     TreeNode* current = this;
     while (current->right)
         current = current->right;
     return current;
 }
 
-template <class T>
-typename AVL<T>::TreeNode* AVL<T>::TreeNode::min() {
+template <class T, class Augment>
+typename AVL<T, Augment>::TreeNode* AVL<T, Augment>::TreeNode::min() {
     TreeNode* current = this;
     while (current->left)
         current = current->left;
     return current;
 }
 
-template <class T>
-AVL<T>::AVL() : root(nullptr) {}
+template <class T, class Augment>
+AVL<T, Augment>::AVL() : root(nullptr), reclaimer(nullptr), count(0), version(0) {}
+
+template <class T, class Augment>
+AVL<T, Augment>::AVL(const AVL& other)
+    : root(clone(other.root)), reclaimer(nullptr), count(other.count), version(0) {}
+
+template <class T, class Augment>
+AVL<T, Augment>::AVL(AVL&& other) noexcept
+    : root(other.root), reclaimer(other.reclaimer), count(other.count), version(0) {
+    other.root = nullptr;
+    other.reclaimer = nullptr;
+    other.count = 0;
+    ++other.version;
+}
+
+template <class T, class Augment>
+AVL<T, Augment>& AVL<T, Augment>::operator=(AVL other) noexcept {
+    swap(other);
+    return *this;
+}
+
+template <class T, class Augment>
+void AVL<T, Augment>::swap(AVL& other) noexcept {
+    std::swap(root, other.root);
+    std::swap(reclaimer, other.reclaimer);
+    std::swap(count, other.count);
+    ++version;
+    ++other.version;
+}
+
+template <class T, class Augment>
+void swap(AVL<T, Augment>& a, AVL<T, Augment>& b) noexcept {
+    a.swap(b);
+}
+
+template <class T, class Augment>
+template <class Generator>
+typename AVL<T, Augment>::TreeNode* AVL<T, Augment>::build(std::size_t n, Generator& next) {
+    if (n == 0) return nullptr;
+
+    TreeNode* left = build(n / 2, next);
+    TreeNode* node;
+    try {
+        node = new TreeNode(next());
+    } catch (...) {
+        delete left;
+        throw;
+    }
+    node->left = left;
+    try {
+        node->right = build(n - n / 2 - 1, next);
+    } catch (...) {
+        delete node;
+        throw;
+    }
+    update(node);
+    return node;
+}
+
+template <class T, class Augment>
+template <class Generator>
+void AVL<T, Augment>::assign_sorted(std::size_t n, Generator&& next) {
+    TreeNode* built = build(n, next);
+    delete root;
+    root = built;
+    count = n;
+    ++version;
+}
 
-template <class T>
-AVL<T>::~AVL() {
+template <class T, class Augment>
+void AVL<T, Augment>::save_shape(std::ostream& out) const {
+    SnapshotHeader header =
+        SnapshotHeader::make<T, std::uint8_t>(SnapshotHeader::kShape, count);
+    header.write(out);
+    SnapshotWriter<T, std::uint8_t> writer(out, header);
+    std::vector<const TreeNode*> pending;
+    if (root) pending.push_back(root);
+    while (!pending.empty()) {
+        const TreeNode* node = pending.back();
+        pending.pop_back();
+        std::uint8_t shape = (node->left ? 1 : 0) | (node->right ? 2 : 0);
+        writer.push(node->data, shape);
+        if (node->right) pending.push_back(node->right);
+        if (node->left) pending.push_back(node->left);
+    }
+    writer.flush();
+    if (!out) throw std::runtime_error("falha ao gravar a forma da árvore");
+}
+
+template <class T, class Augment>
+void AVL<T, Augment>::load_shape(std::istream& in) {
+    SnapshotHeader header = SnapshotHeader::read(
+        in, SnapshotHeader::make<T, std::uint8_t>(SnapshotHeader::kShape, 0));
+    SnapshotReader<T, std::uint8_t> reader(in, header, false);
+
+    TreeNode* built = nullptr;
+    // Posições vazias na ordem em que a pré-ordem as preenche.
+    std::vector<TreeNode**> slots;
+    if (header.count > 0) slots.push_back(&built);
+    // Nós em pré-ordem: percorridos de trás para frente, cada filho aparece
+    // antes do pai, o que permite calcular as alturas numa única passada.
+    std::vector<TreeNode*> order;
+    order.reserve(header.reserve_hint(in));
+    try {
+        for (std::uint64_t i = 0; i < header.count; ++i) {
+            reader.advance();
+            std::uint8_t shape = reader.value();
+            if (slots.empty() || shape > 3) {
+                throw std::runtime_error("snapshot inválido: forma inconsistente");
+            }
+            TreeNode** slot = slots.back();
+            slots.pop_back();
+            *slot = new TreeNode(reader.key());
+            order.push_back(*slot);
+            if (shape & 2) slots.push_back(&(*slot)->right);
+            if (shape & 1) slots.push_back(&(*slot)->left);
+        }
+        if (!slots.empty()) {
+            throw std::runtime_error("snapshot inválido: forma inconsistente");
+        }
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            TreeNode* node = *it;
+            int leftHeight = node->left ? node->left->height : 0;
+            int rightHeight = node->right ? node->right->height : 0;
+            if (std::abs(leftHeight - rightHeight) > 1) {
+                throw std::runtime_error("snapshot inválido: forma não é AVL");
+            }
+            update(node);
+        }
+    } catch (...) {
+        delete built;
+        throw;
+    }
+    delete root;
+    root = built;
+    count = static_cast<std::size_t>(header.count);
+    ++version;
+}
+
+template <class T, class Augment>
+typename AVL<T, Augment>::TreeNode* AVL<T, Augment>::clone(const TreeNode* node) {
+    if (node == nullptr) return nullptr;
+
+    TreeNode* copy = new TreeNode(node->data);
+    copy->height = node->height;
+    static_cast<Slot&>(*copy) = *node;
+    // Pilha explícita de pares (origem, cópia) cujos filhos faltam clonar.
+    std::vector<std::pair<const TreeNode*, TreeNode*>> pending;
+    try {
+        pending.emplace_back(node, copy);
+        while (!pending.empty()) {
+            auto [from, to] = pending.back();
+            pending.pop_back();
+            if (from->left) {
+                to->left = new TreeNode(from->left->data);
+                to->left->height = from->left->height;
+                static_cast<Slot&>(*to->left) = *from->left;
+                pending.emplace_back(from->left, to->left);
+            }
+            if (from->right) {
+                to->right = new TreeNode(from->right->data);
+                to->right->height = from->right->height;
+                static_cast<Slot&>(*to->right) = *from->right;
+                pending.emplace_back(from->right, to->right);
+            }
+        }
+    } catch (...) {
+        delete copy;
+        throw;
+    }
+    return copy;
+}
+
+template <class T, class Augment>
+AVL<T, Augment>::~AVL() {
     delete root;
 }
 
-template <class T>
-bool AVL<T>::insert(const T& value) {
-    return insert(root, value);
+template <class T, class Augment>
+bool AVL<T, Augment>::insert(const T& value) {
+    if (!insert(root, value)) return false;
+    ++count;
+    ++version;
+    return true;
+}
+
+template <class T, class Augment>
+bool AVL<T, Augment>::insert(Finger& hint, const T& value) {
+    using Step = typename Finger::Step;
+    std::vector<Step>& path = hint.path;
+    if (hint.tree != this || hint.version != version) {
+        path.clear();
+        hint.tree = this;
+    }
+    // Sobe até o primeiro nó cuja faixa contém o valor.
+    while (!path.empty()) {
+        const Step& step = path.back();
+        if ((!step.lower || *step.lower < value) && (!step.upper || value < *step.upper)) {
+            break;
+        }
+        path.pop_back();
+    }
+    if (!root) {
+        root = new TreeNode(value);
+        path.push_back(Step{root, nullptr, nullptr});
+    } else {
+        if (path.empty()) path.push_back(Step{root, nullptr, nullptr});
+        while (true) {
+            Step step = path.back();
+            TreeNode* node = step.node;
+            if (value < node->data) {
+                bool leaf = !node->left;
+                if (leaf) node->left = new TreeNode(value);
+                path.push_back(Step{node->left, step.lower, &node->data});
+                if (leaf) break;
+            } else if (node->data < value) {
+                bool leaf = !node->right;
+                if (leaf) node->right = new TreeNode(value);
+                path.push_back(Step{node->right, &node->data, step.upper});
+                if (leaf) break;
+            } else {
+                hint.version = version;
+                return false;
+            }
+        }
+        retrace(path, value);
+    }
+    ++count;
+    hint.version = ++version;
+    return true;
+}
+
+template <class T, class Augment>
+void AVL<T, Augment>::retrace(std::vector<typename Finger::Step>& path, const T& value) {
+    using Step = typename Finger::Step;
+    for (std::size_t i = path.size() - 1; i-- > 0;) {
+        TreeNode* node = path[i].node;
+        int before = node->height;
+        update(node);
+        TreeNode*& slot = i == 0 ? root
+                          : path[i - 1].node->left == node ? path[i - 1].node->left
+                                                            : path[i - 1].node->right;
+        balance(slot);
+        if (slot != node) {
+            // Uma rotação devolve à subárvore a altura anterior: corrige o
+            // caminho e para. Na simples o filho sobe para o lugar do nó; na
+            // dupla sobe o neto, e o caminho segue pelo filho dele do lado
+            // do valor (a menos que o neto seja o próprio valor inserido).
+            TreeNode* top = slot;
+            Step replaced = path[i];
+            auto at = path.begin() + static_cast<std::ptrdiff_t>(i);
+            if (top == path[i + 1].node) {
+                path.erase(at);
+                path[i] = Step{top, replaced.lower, replaced.upper};
+            } else {
+                Step up{top, replaced.lower, replaced.upper};
+                if (path.size() > i + 3) {
+                    path.erase(at + 2);
+                    path[i] = up;
+                    path[i + 1] = value < top->data
+                                      ? Step{top->left, replaced.lower, &top->data}
+                                      : Step{top->right, &top->data, replaced.upper};
+                } else {
+                    path.erase(at + 1, at + 3);
+                    path[i] = up;
+                }
+            }
+            // Com agregado, os ancestrais ainda precisam ser atualizados.
+            if (!kAugmented) return;
+        } else if (!kAugmented && node->height == before) {
+            return;
+        }
+    }
+}
+
+template <class T, class Augment>
+void AVL<T, Augment>::append_max(const T& value) {
+    if (tail.tree != this || tail.version != version) {
+        // Refaz o dedo ao longo da borda direita.
+        tail.path.clear();
+        tail.tree = this;
+        tail.version = version;
+        const T* lower = nullptr;
+        for (TreeNode* node = root; node; node = node->right) {
+            tail.path.push_back(typename Finger::Step{node, lower, nullptr});
+            lower = &node->data;
+        }
+    }
+    if (!tail.path.empty() && !(tail.path.back().node->data < value)) {
+        throw std::invalid_argument("append_max: valor não é maior que o máximo");
+    }
+    insert(tail, value);
+}
+
+template <class T, class Augment>
+bool AVL<T, Augment>::remove(const T& value) {
+    if (!remove(root, value)) return false;
+    --count;
+    ++version;
+    return true;
+}
+
+template <class T, class Augment>
+std::size_t AVL<T, Augment>::erase_range(const T& lo, const T& hi) {
+    std::size_t removed = release(cut_range(lo, hi));
+    count -= removed;
+    return removed;
+}
+
+template <class T, class Augment>
+AVL<T, Augment> AVL<T, Augment>::extract_range(const T& lo, const T& hi) {
+    AVL result;
+    result.root = cut_range(lo, hi);
+    result.count = tally(result.root);
+    count -= result.count;
+    return result;
+}
+
+template <class T, class Augment>
+typename AVL<T, Augment>::TreeNode* AVL<T, Augment>::cut_range(const T& lo, const T& hi) {
+    if (!(lo < hi)) return nullptr;
+    std::pair<TreeNode*, TreeNode*> below = split(root, lo);
+    std::pair<TreeNode*, TreeNode*> inside = split(below.second, hi);
+    root = join(below.first, inside.second);
+    ++version;
+    return inside.first;
+}
+
+template <class T, class Augment>
+const T* AVL<T, Augment>::lower_bound(const T& value) const {
+    const TreeNode* node = above(value, true);
+    return node ? &node->data : nullptr;
+}
+
+template <class T, class Augment>
+const T* AVL<T, Augment>::upper_bound(const T& value) const {
+    const TreeNode* node = above(value, false);
+    return node ? &node->data : nullptr;
+}
+
+template <class T, class Augment>
+const T* AVL<T, Augment>::ceiling(const T& value) const {
+    return lower_bound(value);
+}
+
+template <class T, class Augment>
+const T* AVL<T, Augment>::floor(const T& value) const {
+    const TreeNode* node = below(value, true);
+    return node ? &node->data : nullptr;
+}
+
+template <class T, class Augment>
+const T* AVL<T, Augment>::successor(const T& value) const {
+    return upper_bound(value);
+}
+
+template <class T, class Augment>
+const T* AVL<T, Augment>::predecessor(const T& value) const {
+    const TreeNode* node = below(value, false);
+    return node ? &node->data : nullptr;
+}
+
+template <class T, class Augment>
+const T* AVL<T, Augment>::nearest(const T& value) const {
+    const T* low = floor(value);
+    const T* high = ceiling(value);
+    if (!low) return high;
+    if (!high) return low;
+    return closer_above(*low, value, *high) ? high : low;
+}
+
+template <class T, class Augment>
+const typename AVL<T, Augment>::TreeNode* AVL<T, Augment>::above(const T& value, bool inclusive) const {
+    const TreeNode* best = nullptr;
+    const TreeNode* node = root;
+    while (node) {
+        bool fits = inclusive ? !(node->data < value) : value < node->data;
+        if (fits) {
+            best = node;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+    return best;
+}
+
+template <class T, class Augment>
+const typename AVL<T, Augment>::TreeNode* AVL<T, Augment>::below(const T& value, bool inclusive) const {
+    const TreeNode* best = nullptr;
+    const TreeNode* node = root;
+    while (node) {
+        bool fits = inclusive ? !(value < node->data) : node->data < value;
+        if (fits) {
+            best = node;
+            node = node->right;
+        } else {
+            node = node->left;
+        }
+    }
+    return best;
+}
+
+template <class T, class Augment>
+const T* AVL<T, Augment>::find(const T& value) const {
+    if (threaded) {
+        const TreeNode* node = find_threaded(value);
+        return node ? &node->data : nullptr;
+    }
+    const TreeNode* node = root;
+    while (node) {
+        if (value < node->data) {
+            node = node->left;
+        } else if (node->data < value) {
+            node = node->right;
+        } else {
+            return &node->data;
+        }
+    }
+    return nullptr;
+}
+
+template <class T, class Augment>
+T* AVL<T, Augment>::find_for_update(const T& value) {
+    static_assert(!kAugmented, "com Augment, altere os valores com modify");
+    return const_cast<T*>(find(value));
+}
+
+template <class T, class Augment>
+template <class F>
+bool AVL<T, Augment>::modify(const T& value, F&& f) {
+    // Caminho da raiz até o valor; a altura de uma AVL não passa de 96.
+    TreeNode* path[96];
+    std::size_t depth = 0;
+    TreeNode* node = root;
+    while (node) {
+        path[depth++] = node;
+        if (value < node->data) {
+            node = node->left;
+        } else if (node->data < value) {
+            node = node->right;
+        } else {
+            break;
+        }
+    }
+    if (!node) return false;
+    if constexpr (kAugmented) {
+        try {
+            f(node->data);
+        } catch (...) {
+            while (depth > 0) update(path[--depth]);
+            throw;
+        }
+        while (depth > 0) update(path[--depth]);
+    } else {
+        f(node->data);
+    }
+    return true;
+}
+
+template <class T, class Augment>
+typename AVL<T, Augment>::Summary AVL<T, Augment>::aggregate(const T& lo, const T& hi) const {
+    static_assert(kAugmented, "aggregate exige uma AVL com Augment");
+    if (!(lo < hi)) return Augment::identity();
+    return fold(root, &lo, &hi);
+}
+
+template <class T, class Augment>
+typename AVL<T, Augment>::Summary AVL<T, Augment>::aggregate() const {
+    static_assert(kAugmented, "aggregate exige uma AVL com Augment");
+    return summary(root);
+}
+
+template <class T, class Augment>
+void AVL<T, Augment>::update(TreeNode* node) {
+    int leftHeight = node->left ? node->left->height : 0;
+    int rightHeight = node->right ? node->right->height : 0;
+    node->height = std::max(leftHeight, rightHeight) + 1;
+    if constexpr (kAugmented) {
+        node->summary = Augment::combine(
+            Augment::combine(summary(node->left), Augment::measure(node->data)),
+            summary(node->right));
+    }
+}
+
+template <class T, class Augment>
+typename AVL<T, Augment>::Summary AVL<T, Augment>::summary(const TreeNode* node) {
+    return node ? node->summary : Augment::identity();
 }
 
-template <class T>
-bool AVL<T>::remove(const T& value) {
-    return remove(root, value);
+template <class T, class Augment>
+typename AVL<T, Augment>::Summary AVL<T, Augment>::fold(const TreeNode* node, const T* lo,
+                                                        const T* hi) {
+    // Desce até o primeiro nó dentro do intervalo; abaixo dele, cada lado só
+    // tem um limite e as subárvores do lado de dentro entram inteiras.
+    while (node) {
+        if (lo && node->data < *lo) {
+            node = node->right;
+        } else if (hi && !(node->data < *hi)) {
+            node = node->left;
+        } else {
+            break;
+        }
+    }
+    if (!node) return Augment::identity();
+    if (!lo && !hi) return summary(node);
+    return Augment::combine(
+        Augment::combine(fold(node->left, lo, nullptr), Augment::measure(node->data)),
+        fold(node->right, nullptr, hi));
 }
 
-template <class T>
-bool AVL<T>::contain(const T& value) const {
+template <class T, class Augment>
+bool AVL<T, Augment>::contain(const T& value) const {
+    if (threaded) return find_threaded(value) != nullptr;
     return contain(root, value);
 }
 
-template <class T>
-bool AVL<T>::insert(TreeNode*& node, const T& value) {
+template <class T, class Augment>
+const typename AVL<T, Augment>::TreeNode* AVL<T, Augment>::find_threaded(const T& value) const {
+    const TreeNode* turn = nullptr;  // Último nó em que a descida foi à esquerda.
+    const TreeNode* node = root;
+    while (node) {
+        if (value < node->data) {
+            turn = node;
+            node = node->left;
+        } else if (node->data < value) {
+            node = node->right == turn ? nullptr : node->right;
+        } else {
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+template <class T, class Augment>
+std::size_t AVL<T, Augment>::find_many(const T* values, std::size_t n, const T** found) const {
+    std::size_t hits = 0;
+    const TreeNode* current[kBatchGroup];
+    for (std::size_t first = 0; first < n; first += kBatchGroup) {
+        std::size_t m = std::min(kBatchGroup, n - first);
+        for (std::size_t i = 0; i < m; ++i) {
+            current[i] = root;
+            found[first + i] = nullptr;
+        }
+        std::size_t active = root ? m : 0;
+        while (active > 0) {
+            active = 0;
+            for (std::size_t i = 0; i < m; ++i) {
+                const TreeNode* node = current[i];
+                if (!node) continue;
+                const T& value = values[first + i];
+                if (value < node->data) {
+                    node = node->left;
+                } else if (node->data < value) {
+                    node = node->right;
+                } else {
+                    found[first + i] = &node->data;
+                    ++hits;
+                    node = nullptr;
+                }
+                current[i] = node;
+                if (node) {
+                    prefetch_read(node);
+                    ++active;
+                }
+            }
+        }
+    }
+    return hits;
+}
+
+template <class T, class Augment>
+std::size_t AVL<T, Augment>::contains_many(const T* values, std::size_t n, bool* found) const {
+    const T* nodes[kBatchGroup];
+    std::size_t hits = 0;
+    for (std::size_t first = 0; first < n; first += kBatchGroup) {
+        std::size_t m = std::min(kBatchGroup, n - first);
+        hits += find_many(values + first, m, nodes);
+        for (std::size_t i = 0; i < m; ++i) found[first + i] = nodes[i] != nullptr;
+    }
+    return hits;
+}
+
+template <class T, class Augment>
+std::size_t AVL<T, Augment>::search_sorted(const T* values, std::size_t n, bool* found) const {
+    for (std::size_t i = 1; i < n; ++i) {
+        if (values[i] < values[i - 1]) {
+            throw std::invalid_argument("search_sorted: lote fora de ordem");
+        }
+    }
+    return search_sorted(root, values, values + n, found);
+}
+
+template <class T, class Augment>
+std::size_t AVL<T, Augment>::search_sorted(const TreeNode* node, const T* first, const T* last,
+                                  bool* found) const {
+    std::size_t hits = 0;
+    while (node && first != last) {
+        std::size_t m = static_cast<std::size_t>(last - first);
+        if (m <= kBatchGroup) {
+            // Poucos valores: descidas intercaladas a partir deste nó, como
+            // em `find_many`, sobrepondo as faltas de cache.
+            const TreeNode* current[kBatchGroup];
+            std::fill(current, current + m, node);
+            for (std::size_t active = m; active > 0;) {
+                active = 0;
+                for (std::size_t i = 0; i < m; ++i) {
+                    const TreeNode* at = current[i];
+                    if (!at) continue;
+                    if (first[i] < at->data) {
+                        at = at->left;
+                    } else if (at->data < first[i]) {
+                        at = at->right;
+                    } else {
+                        found[i] = true;
+                        ++hits;
+                        current[i] = nullptr;
+                        continue;
+                    }
+                    if (at) {
+                        prefetch_read(at);
+                        ++active;
+                    } else {
+                        found[i] = false;
+                    }
+                    current[i] = at;
+                }
+            }
+            return hits;
+        }
+        // [first, middle) vai à esquerda, [middle, after) é igual ao nó e
+        // [after, last) vai à direita; a direita segue no laço.
+        const T* middle = std::lower_bound(first, last, node->data);
+        const T* after = middle;
+        for (; after != last && !(node->data < *after); ++after) {
+            found[after - first] = true;
+            ++hits;
+        }
+        // A direita só é visitada depois da esquerda inteira: pede-a já.
+        if (after != last && node->right) prefetch_read(node->right);
+        hits += search_sorted(node->left, first, middle, found);
+        found += after - first;
+        first = after;
+        node = node->right;
+    }
+    for (; first != last; ++first) *found++ = false;
+    return hits;
+}
+
+template <class T, class Augment>
+bool AVL<T, Augment>::insert(TreeNode*& node, const T& value) {
     if (!node) {
         node = new TreeNode(value);
         return true;
     }
-    if (value == node->data) 
-    return false; 
-
     bool inserted = false;
     if (value < node->data) {
         inserted = insert(node->left, value);
-    } else {
+    } else if (node->data < value) {
         inserted = insert(node->right, value);
+    } else {
+        return false;
     }
 
     if (inserted) {
-        node->height = std::max(height(node->left), height(node->right)) + 1;
+        update(node);
         balance(node);
     }
     return inserted;
 }
 
-template <class T>
-bool AVL<T>::contain(const TreeNode* const node, const T& value) const {
+template <class T, class Augment>
+bool AVL<T, Augment>::contain(const TreeNode* const node, const T& value) const {
     if (!node) return false;
-    if (value == node->data) return true;
     if (value < node->data) return contain(node->left, value);
-    return contain(node->right, value);
+    if (node->data < value) return contain(node->right, value);
+    return true;
 }
 
-template <class T>
-bool AVL<T>::remove(TreeNode*& node, const T& value) {
+template <class T, class Augment>
+bool AVL<T, Augment>::remove(TreeNode*& node, const T& value) {
     if (!node) 
     return false;
 
     bool removed = false;
     if (value < node->data) {
         removed = remove(node->left, value);
-    } else if (value > node->data) {
+    } else if (node->data < value) {
         removed = remove(node->right, value);
     } else {
         removed = true;
         if (!node->left) {
             TreeNode* rightChild = node->right;
-            node->right = nullptr;
-            delete node;
+            dispose(node);
             node = rightChild;
         } else if (!node->right) {
             TreeNode* leftChild = node->left;
-            node->left = nullptr;
-            delete node;
+            dispose(node);
             node = leftChild;
         } else {
             TreeNode* successor = node->right->min();
@@ -388,53 +1534,229 @@ bool AVL<T>::remove(TreeNode*& node, const T& value) {
         }
     }
     if (removed && node) {
-        node->height = std::max(height(node->left), height(node->right)) + 1;
+        update(node);
         balance(node);
     }
     return removed;
 }
 
-template <class T>
-void AVL<T>::in_order(const TreeNode* const node, std::vector<T>& result) const {
-    if (!node) return;
-    in_order(node->left, result);
-    result.push_back(node->data);
-    in_order(node->right, result);
+template <class T, class Augment>
+void AVL<T, Augment>::dispose(TreeNode* node) {
+    node->left = nullptr;
+    node->right = nullptr;
+    if (reclaimer) {
+        reclaimer->retire(node);
+    } else {
+        delete node;
+    }
 }
 
-template <class T>
-std::vector<T> AVL<T>::in_order() const {
-    std::vector<T> result;
-    in_order(root, result);
-    return result;
+template <class T, class Augment>
+std::size_t AVL<T, Augment>::release(TreeNode* node) {
+    std::size_t released = 0;
+    std::vector<TreeNode*> pending;
+    if (node) pending.push_back(node);
+    while (!pending.empty()) {
+        TreeNode* current = pending.back();
+        pending.pop_back();
+        if (current->left) pending.push_back(current->left);
+        if (current->right) pending.push_back(current->right);
+        dispose(current);
+        ++released;
+    }
+    return released;
 }
 
-template <class T>
-void AVL<T>::pre_order(const TreeNode* const node, std::vector<T>& result) const {
-    if (!node) return;
-    result.push_back(node->data);
-    pre_order(node->left, result);
-    pre_order(node->right, result);
+template <class T, class Augment>
+std::size_t AVL<T, Augment>::tally(const TreeNode* node) {
+    std::size_t total = 0;
+    std::vector<const TreeNode*> pending;
+    if (node) pending.push_back(node);
+    while (!pending.empty()) {
+        const TreeNode* current = pending.back();
+        pending.pop_back();
+        if (current->left) pending.push_back(current->left);
+        if (current->right) pending.push_back(current->right);
+        ++total;
+    }
+    return total;
 }
 
-template <class T>
-std::vector<T> AVL<T>::pre_order() const {
+template <class T, class Augment>
+typename AVL<T, Augment>::TreeNode* AVL<T, Augment>::join(TreeNode* left, TreeNode* middle, TreeNode* right) {
+    if (height(left) > height(right) + 1) {
+        // Desce pela borda direita de `left` até uma altura compatível.
+        left->right = join(left->right, middle, right);
+        update(left);
+        balance(left);
+        return left;
+    }
+    if (height(right) > height(left) + 1) {
+        right->left = join(left, middle, right->left);
+        update(right);
+        balance(right);
+        return right;
+    }
+    middle->left = left;
+    middle->right = right;
+    update(middle);
+    return middle;
+}
+
+template <class T, class Augment>
+typename AVL<T, Augment>::TreeNode* AVL<T, Augment>::join(TreeNode* left, TreeNode* right) {
+    if (!left) return right;
+    if (!right) return left;
+    TreeNode* middle = nullptr;
+    right = detach_min(right, middle);
+    return join(left, middle, right);
+}
+
+template <class T, class Augment>
+typename AVL<T, Augment>::TreeNode* AVL<T, Augment>::detach_min(TreeNode* node, TreeNode*& min) {
+    if (!node->left) {
+        min = node;
+        TreeNode* rest = node->right;
+        node->right = nullptr;
+        return rest;
+    }
+    node->left = detach_min(node->left, min);
+    update(node);
+    balance(node);
+    return node;
+}
+
+template <class T, class Augment>
+std::pair<typename AVL<T, Augment>::TreeNode*, typename AVL<T, Augment>::TreeNode*>
+AVL<T, Augment>::split(TreeNode* node, const T& value) {
+    if (!node) return {nullptr, nullptr};
+    TreeNode* left = node->left;
+    TreeNode* right = node->right;
+    node->left = nullptr;
+    node->right = nullptr;
+    if (node->data < value) {
+        std::pair<TreeNode*, TreeNode*> parts = split(right, value);
+        return {join(left, node, parts.first), parts.second};
+    }
+    std::pair<TreeNode*, TreeNode*> parts = split(left, value);
+    return {parts.first, join(parts.second, node, right)};
+}
+
+template <class T, class Augment>
+std::vector<T> AVL<T, Augment>::in_order() const {
     std::vector<T> result;
-    pre_order(root, result);
+    result.reserve(count);
+    in_order(std::back_inserter(result));
     return result;
 }
 
-template <class T>
-void AVL<T>::post_order(const TreeNode* const node, std::vector<T>& result) const {
-    if (!node) return;
-    post_order(node->left, result);
-    post_order(node->right, result);
-    result.push_back(node->data);
+template <class T, class Augment>
+std::vector<T> AVL<T, Augment>::pre_order() const {
+    std::vector<T> result;
+    result.reserve(count);
+    pre_order(std::back_inserter(result));
+    return result;
 }
 
-template <class T>
-std::vector<T> AVL<T>::post_order() const {
+template <class T, class Augment>
+std::vector<T> AVL<T, Augment>::post_order() const {
     std::vector<T> result;
-    post_order(root, result);
+    result.reserve(count);
+    post_order(std::back_inserter(result));
     return result;
 }
+
+template <class T, class Augment>
+template <class F>
+bool AVL<T, Augment>::for_each_in_order(F&& f) const {
+    return walk_in_order(root, [&f](const TreeNode* node) {
+        return keep_visiting(f, node->data);
+    });
+}
+
+template <class T, class Augment>
+template <class F>
+bool AVL<T, Augment>::for_each_pre_order(F&& f) const {
+    return walk_pre_order(root, [&f](const TreeNode* node) {
+        return keep_visiting(f, node->data);
+    });
+}
+
+template <class T, class Augment>
+template <class F>
+bool AVL<T, Augment>::for_each_post_order(F&& f) const {
+    return walk_post_order(root, [&f](const TreeNode* node) {
+        return keep_visiting(f, node->data);
+    });
+}
+
+template <class T, class Augment>
+template <class F>
+bool AVL<T, Augment>::for_each_in_order_morris(F&& f) {
+    // Enquanto `threaded`, contain segue as costuras sem entrar em ciclo.
+    threaded = true;
+    try {
+        bool complete = walk_morris(root, [&f](const TreeNode* node) {
+            return keep_visiting(f, node->data);
+        });
+        threaded = false;
+        return complete;
+    } catch (...) {
+        threaded = false;
+        throw;
+    }
+}
+
+template <class T, class Augment>
+template <class OutputIt>
+OutputIt AVL<T, Augment>::in_order_morris(OutputIt out) {
+    for_each_in_order_morris([&out](const T& value) { *out++ = value; });
+    return out;
+}
+
+template <class T, class Augment>
+template <class F>
+void AVL<T, Augment>::parallel_for_each_in_order(F&& f, unsigned threads) const {
+    if (threads == 0) {
+        threads = count < kParallelMin ? 1 : std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (threads == 1) {
+        std::size_t position = 0;
+        walk_in_order(root, [&](const TreeNode* node) {
+            f(node->data, position++);
+            return true;
+        });
+        return;
+    }
+    walk_in_order_parallel(root, threads, [&f](const TreeNode* node, std::size_t position) {
+        f(node->data, position);
+    });
+}
+
+template <class T, class Augment>
+T* AVL<T, Augment>::parallel_export(T* out, unsigned threads) const {
+    parallel_for_each_in_order([out](const T& value, std::size_t i) { out[i] = value; },
+                               threads);
+    return out + count;
+}
+
+template <class T, class Augment>
+template <class OutputIt>
+OutputIt AVL<T, Augment>::in_order(OutputIt out) const {
+    for_each_in_order([&out](const T& value) { *out++ = value; });
+    return out;
+}
+
+template <class T, class Augment>
+template <class OutputIt>
+OutputIt AVL<T, Augment>::pre_order(OutputIt out) const {
+    for_each_pre_order([&out](const T& value) { *out++ = value; });
+    return out;
+}
+
+template <class T, class Augment>
+template <class OutputIt>
+OutputIt AVL<T, Augment>::post_order(OutputIt out) const {
+    for_each_post_order([&out](const T& value) { *out++ = value; });
+    return out;
+}
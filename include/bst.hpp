@@ -1,7 +1,21 @@
 #pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#include "distance.hpp"
+#include "epoch.hpp"
+#include "prefetch.hpp"
+#include "serial.hpp"
+#include "traversal.hpp"
+
 /**
  * @brief Classe que representa uma Árvore Binária de Busca (BST).
  *
@@ -59,6 +73,68 @@ class BST {
    */
   bool insert(TreeNode*& node, const T& value);
 
+  /**
+   * @brief Constrói uma subárvore perfeitamente balanceada com `n` elementos.
+   *
+   * Consome os elementos de `next` em ordem (esquerda, nó, direita), de modo
+   * que uma sequência crescente resulta numa árvore de busca válida.
+   *
+   * @param n Quantidade de elementos.
+   * @param next Gerador chamado uma vez por elemento.
+   * @return Raiz da subárvore construída.
+   */
+  template <class Generator>
+  static TreeNode* build(std::size_t n, Generator& next);
+
+  /**
+   * @brief Clona uma subárvore iterativamente, preservando sua forma.
+   *
+   * @param node Raiz da subárvore de origem.
+   * @return Raiz da cópia, ou nullptr se `node` for nulo.
+   */
+  static TreeNode* clone(const TreeNode* node);
+
+  /**
+   * @brief Libera um nó já desligado da árvore.
+   *
+   * Zera os filhos (o destrutor do nó é recursivo) e, se houver um domínio de
+   * recuperação configurado, aposenta o nó em vez de apagá-lo imediatamente.
+   *
+   * @param node Nó removido da árvore.
+   */
+  void dispose(TreeNode* node);
+
+  /**
+   * @brief Libera todos os nós de uma subárvore desligada, iterativamente.
+   *
+   * @param node Raiz da subárvore.
+   * @return Quantidade de nós liberados.
+   */
+  std::size_t release(TreeNode* node);
+
+  /**
+   * @brief Conta os nós de uma subárvore, iterativamente.
+   */
+  static std::size_t tally(const TreeNode* node);
+
+  /**
+   * @brief Separa da árvore os valores do intervalo [lo, hi).
+   *
+   * Divide a árvore em `lo` e em `hi` descendo uma vez por divisão e pendura
+   * a parte final no máximo da parte inicial, tudo em O(h).
+   *
+   * @return Raiz da subárvore separada, já desligada de `root`.
+   */
+  TreeNode* cut_range(const T& lo, const T& hi);
+
+  /**
+   * @brief Divide a subárvore em valores menores que `value` e os demais,
+   * iterativamente e reaproveitando os nós.
+   *
+   * @return Par (menores que `value`, maiores ou iguais a `value`).
+   */
+  static std::pair<TreeNode*, TreeNode*> split(TreeNode* node, const T& value);
+
   /**
    * @brief Remove um valor da árvore recursivamente.
    *
@@ -79,37 +155,24 @@ class BST {
   bool contain(const TreeNode* const node, const T& value) const;
 
   /**
-   * @brief Executa a travessia in-order recursiva.
+   * @brief Busca exata que tolera as costuras de uma travessia de Morris em
+   * andamento.
    *
-   * Visita a subárvore esquerda, depois o nó atual e em seguida a subárvore
-   * direita. Os valores visitados são armazenados em `result`.
-   *
-   * @param node Ponteiro para o nó atual.
-   * @param result Vetor onde os valores visitados serão armazenados.
+   * Uma costura liga o predecessor de um nó ao próprio nó, que é sempre o
+   * último ancestral em que a descida virou à esquerda; ao encontrá-lo pela
+   * direita, a busca o trata como um filho nulo.
    */
-  void in_order(const TreeNode* const node, std::vector<T>& result) const;
+  const TreeNode* find_threaded(const T& value) const;
 
   /**
-   * @brief Executa a travessia pre-order recursiva.
-   *
-   * Visita o nó atual, em seguida a subárvore esquerda e depois a direita.
-   * Os valores visitados são armazenados em `result`.
-   *
-   * @param node Ponteiro para o nó atual.
-   * @param result Vetor onde os valores visitados serão armazenados.
+   * @brief Nó com o menor valor maior que `value` (ou igual, se `inclusive`).
    */
-  void pre_order(const TreeNode* const node, std::vector<T>& result) const;
+  const TreeNode* above(const T& value, bool inclusive) const;
 
   /**
-   * @brief Executa a travessia post-order recursiva.
-   *
-   * Visita a subárvore esquerda, depois a direita e por último o nó atual.
-   * Os valores visitados são armazenados em `result`.
-   *
-   * @param node Ponteiro para o nó atual.
-   * @param result Vetor onde os valores visitados serão armazenados.
+   * @brief Nó com o maior valor menor que `value` (ou igual, se `inclusive`).
    */
-  void post_order(const TreeNode* const node, std::vector<T>& result) const;
+  const TreeNode* below(const T& value, bool inclusive) const;
 
   TreeNode* find_node(TreeNode* node, const T& value) const {
     if (node == nullptr) {
@@ -136,6 +199,39 @@ class BST {
    */
   ~BST();
 
+  /**
+   * @brief Construtor de cópia profunda.
+   *
+   * Clona a estrutura de `other` nó a nó numa única passagem iterativa, sem
+   * comparações nem rebalanceamento. A cópia não herda o domínio de
+   * recuperação configurado em `other`.
+   *
+   * @param other Árvore a ser copiada.
+   */
+  BST(const BST& other);
+
+  /**
+   * @brief Construtor de movimento em O(1); `other` fica vazia.
+   *
+   * @param other Árvore cujos nós serão transferidos.
+   */
+  BST(BST&& other) noexcept;
+
+  /**
+   * @brief Atribuição por cópia ou movimento (copy-and-swap).
+   *
+   * @param other Árvore recebida por valor (copiada ou movida).
+   * @return Referência para esta árvore.
+   */
+  BST& operator=(BST other) noexcept;
+
+  /**
+   * @brief Troca o conteúdo com outra árvore em O(1).
+   *
+   * @param other Árvore com a qual o conteúdo será trocado.
+   */
+  void swap(BST& other) noexcept;
+
   /**
    * @brief Insere um novo valor na árvore.
    *
@@ -152,6 +248,28 @@ class BST {
    */
   bool remove(const T& value);
 
+  /**
+   * @brief Remove todos os valores do intervalo [lo, hi).
+   *
+   * Custa O(h) mais a liberação dos k nós removidos, em vez de uma remoção
+   * completa por valor.
+   *
+   * @param lo Início do intervalo (incluído).
+   * @param hi Fim do intervalo (excluído).
+   * @return Quantidade de valores removidos.
+   */
+  std::size_t erase_range(const T& lo, const T& hi);
+
+  /**
+   * @brief Move os valores do intervalo [lo, hi) para uma nova árvore, sem
+   * copiar os nós. O domínio de recuperação não é transferido.
+   *
+   * @param lo Início do intervalo (incluído).
+   * @param hi Fim do intervalo (excluído).
+   * @return Árvore com os valores removidos.
+   */
+  BST extract_range(const T& lo, const T& hi);
+
   /**
    * @brief Verifica se um valor está presente na árvore.
    *
@@ -160,6 +278,60 @@ class BST {
    */
   bool contain(const T& value) const;
 
+  /**
+   * @name Consultas por ordem
+   *
+   * Descidas iterativas de O(h) que usam apenas `<`. Devolvem um ponteiro
+   * para o valor guardado na árvore, ou `nullptr` se não houver; o ponteiro
+   * vale até a próxima alteração da árvore.
+   * @{
+   */
+  const T* lower_bound(const T& value) const;  ///< Menor valor >= `value`.
+  const T* upper_bound(const T& value) const;  ///< Menor valor > `value`.
+  const T* ceiling(const T& value) const;      ///< Igual a `lower_bound`.
+  const T* floor(const T& value) const;        ///< Maior valor <= `value`.
+  const T* successor(const T& value) const;    ///< Igual a `upper_bound`.
+  const T* predecessor(const T& value) const;  ///< Maior valor < `value`.
+
+  /**
+   * @brief Valor mais próximo de `value`; no empate, o menor.
+   *
+   * Compara as distâncias `value - floor` e `ceiling - value` com
+   * `closer_above`, então exige que `T` tenha subtração e que o resultado
+   * tenha `<`; para inteiros o cálculo não transborda.
+   */
+  const T* nearest(const T& value) const;
+  /** @} */
+
+  /**
+   * @brief Busca vários valores de uma vez, intercalando as descidas.
+   *
+   * As buscas avançam em grupos de `kBatchGroup`, um nível por vez: a cada
+   * passo cada descida do grupo compara um nó e pede (prefetch) o filho
+   * seguinte, de modo que as faltas de cache das várias descidas se
+   * sobrepõem em vez de serem esperadas uma a uma.
+   *
+   * @param values Valores buscados.
+   * @param n Quantidade de valores.
+   * @param found Recebe, para cada valor, um ponteiro para o elemento
+   * armazenado ou `nullptr` se ausente.
+   * @return Quantidade de valores encontrados.
+   */
+  std::size_t find_many(const T* values, std::size_t n, const T** found) const;
+
+  /**
+   * @brief Verifica a presença de vários valores (ver `find_many`).
+   *
+   * @param values Valores buscados.
+   * @param n Quantidade de valores.
+   * @param found Recebe, para cada valor, se ele está presente.
+   * @return Quantidade de valores encontrados.
+   */
+  std::size_t contains_many(const T* values, std::size_t n, bool* found) const;
+
+  /// Descidas avançadas juntas por `find_many`.
+  static constexpr std::size_t kBatchGroup = 16;
+
   /**
    * @brief Retorna os valores da árvore em ordem (in-order).
    *
@@ -187,6 +359,89 @@ class BST {
    */
   std::vector<T> post_order() const;
 
+  /**
+   * @name Visitantes
+   *
+   * Travessias iterativas (sem recursão, sem alocação enquanto o caminho
+   * tiver até 96 níveis) que chamam `f(const T&)` em cada valor. Se `f`
+   * devolver `bool`, `false` interrompe a travessia.
+   *
+   * @return `true` se todos os valores foram visitados.
+   * @{
+   */
+  template <class F>
+  bool for_each_in_order(F&& f) const;
+  template <class F>
+  bool for_each_pre_order(F&& f) const;
+  template <class F>
+  bool for_each_post_order(F&& f) const;
+  /** @} */
+
+  /**
+   * @name Travessias para um iterador de saída
+   *
+   * Escrevem os valores em `out` (por exemplo, um buffer do chamador ou
+   * `std::back_inserter`) sem vetor intermediário.
+   *
+   * @return O iterador após o último valor escrito.
+   * @{
+   */
+  template <class OutputIt>
+  OutputIt in_order(OutputIt out) const;
+  template <class OutputIt>
+  OutputIt pre_order(OutputIt out) const;
+  template <class OutputIt>
+  OutputIt post_order(OutputIt out) const;
+  /** @} */
+
+  /**
+   * @name Travessia em ordem de Morris
+   *
+   * Como `for_each_in_order` e `in_order(out)`, mas com O(1) de memória
+   * extra em qualquer forma de árvore, ao custo de cerca do dobro de passos
+   * (ver `walk_morris`). Os ponteiros dos nós são alterados e restaurados
+   * durante a chamada, por isso os métodos não são `const`: não pode haver
+   * outros leitores ao mesmo tempo. O próprio visitante pode consultar a
+   * árvore com `contain`, mas não alterá-la nem usar outras
+   * consultas. Uma interrupção pelo visitante ainda percorre o restante da
+   * árvore.
+   * @{
+   */
+  template <class F>
+  bool for_each_in_order_morris(F&& f);
+  template <class OutputIt>
+  OutputIt in_order_morris(OutputIt out);
+  /** @} */
+
+  /**
+   * @brief Visita os valores em ordem repartindo a árvore entre threads.
+   *
+   * Chama `f(const T&, std::size_t posição)`, em que a posição é o índice do
+   * valor na ordem crescente; as chamadas são concorrentes e fora de ordem
+   * (ver `walk_in_order_parallel`). A árvore não pode ser alterada durante a
+   * visita.
+   *
+   * @param f Visitante; deve aceitar chamadas concorrentes.
+   * @param threads Quantidade de threads, incluindo a chamadora; 0 usa
+   * `std::thread::hardware_concurrency()` (ou uma só thread em árvores com
+   * menos de `kParallelMin` valores).
+   */
+  template <class F>
+  void parallel_for_each_in_order(F&& f, unsigned threads = 0) const;
+
+  /**
+   * @brief Copia os valores em ordem para `out` usando várias threads.
+   *
+   * @param out Buffer com pelo menos `size()` elementos já construídos; cada
+   * posição é atribuída uma vez.
+   * @param threads Como em `parallel_for_each_in_order`.
+   * @return `out + size()`.
+   */
+  T* parallel_export(T* out, unsigned threads = 0) const;
+
+  /// Tamanho mínimo para `threads = 0` usar mais de uma thread.
+  static constexpr std::size_t kParallelMin = std::size_t{1} << 14;
+
   /**
    * @brief Retorna o ponteiro para o nodo contendo o valor.
    *
@@ -194,8 +449,79 @@ class BST {
    */
   TreeNode* find_node(const T& value) const { return find_node(root, value); }
 
+  /**
+   * @brief Retorna a quantidade de elementos da árvore.
+   */
+  std::size_t size() const { return count; }
+
+  /**
+   * @brief Verifica se a árvore está vazia.
+   */
+  bool empty() const { return count == 0; }
+
+  /**
+   * @brief Substitui o conteúdo por `n` valores em ordem crescente, em O(n).
+   *
+   * Monta de baixo para cima uma árvore perfeitamente balanceada, sem
+   * comparações, descidas a partir da raiz ou rotações. Se `next` lançar uma
+   * exceção, a árvore permanece inalterada.
+   *
+   * @param n Quantidade de valores.
+   * @param next Gerador chamado `n` vezes; deve devolver valores em ordem
+   * estritamente crescente.
+   */
+  template <class Generator>
+  void assign_sorted(std::size_t n, Generator&& next);
+
+  /**
+   * @brief Grava a árvore preservando exatamente a sua forma.
+   *
+   * Os valores são gravados em pré-ordem, em blocos no formato de
+   * `SnapshotHeader` (tipo `kShape`), cada um acompanhado de um byte com os
+   * bits de forma do nó (1 = tem filho à esquerda, 2 = tem filho à direita).
+   * Útil para restaurar árvores cuja forma foi escolhida de propósito.
+   *
+   * @param out Fluxo binário de saída.
+   * @throw std::runtime_error se a escrita falhar.
+   */
+  void save_shape(std::ostream& out) const;
+
+  /**
+   * @brief Substitui o conteúdo por uma árvore gravada com `save_shape`.
+   *
+   * Restaura a forma idêntica numa única passada linear e iterativa, sem
+   * comparações nem rotações. Em caso de erro a árvore permanece inalterada.
+   *
+   * @param in Fluxo binário de entrada.
+   * @throw std::runtime_error se o snapshot for inválido ou incompatível.
+   */
+  void load_shape(std::istream& in);
+
+  /**
+   * @brief Define o domínio de recuperação usado para liberar nós removidos.
+   *
+   * Com um domínio configurado, `remove` aposenta os nós em `domain` em vez de
+   * apagá-los, de modo que um nó obtido por um leitor fixado
+   * (`EpochDomain::pin`) continue alocado até o fim da fixação.
+   *
+   * Isso apenas adia a liberação: não torna a árvore segura para leitores
+   * sem trava. A remoção zera as ligações do nó retirado e, com dois filhos,
+   * copia o sucessor no lugar, então leitores concorrentes ainda precisam
+   * excluir o escritor (por exemplo, com uma trava de leitura). Para leituras
+   * sem trava, use `RcuAVL`.
+   *
+   * @param domain Domínio de recuperação, ou `nullptr` para apagar os nós
+   * imediatamente (padrão). Deve sobreviver à árvore.
+   */
+  void set_reclaimer(EpochDomain* domain) { reclaimer = domain; }
+
  private:
+  friend struct CoroutineAccess;  ///< Buscas intercaladas (C++20).
+
   TreeNode* root;  ///< Ponteiro para a raiz da árvore.
+  EpochDomain* reclaimer;  ///< Domínio para nós removidos, se houver.
+  std::size_t count;       ///< Quantidade de elementos.
+  bool threaded = false;   ///< Travessia de Morris em andamento.
 };
 
 template <class T>
@@ -226,7 +552,152 @@ typename BST<T>::TreeNode* BST<T>::TreeNode::min() {
 }
 
 template <class T>
-BST<T>::BST() : root(nullptr) {}
+BST<T>::BST() : root(nullptr), reclaimer(nullptr), count(0) {}
+
+template <class T>
+BST<T>::BST(const BST& other)
+    : root(clone(other.root)), reclaimer(nullptr), count(other.count) {}
+
+template <class T>
+BST<T>::BST(BST&& other) noexcept
+    : root(other.root), reclaimer(other.reclaimer), count(other.count) {
+    other.root = nullptr;
+    other.reclaimer = nullptr;
+    other.count = 0;
+}
+
+template <class T>
+BST<T>& BST<T>::operator=(BST other) noexcept {
+    swap(other);
+    return *this;
+}
+
+template <class T>
+void BST<T>::swap(BST& other) noexcept {
+    std::swap(root, other.root);
+    std::swap(reclaimer, other.reclaimer);
+    std::swap(count, other.count);
+}
+
+template <class T>
+void swap(BST<T>& a, BST<T>& b) noexcept {
+    a.swap(b);
+}
+
+template <class T>
+template <class Generator>
+typename BST<T>::TreeNode* BST<T>::build(std::size_t n, Generator& next) {
+    if (n == 0) return nullptr;
+
+    TreeNode* left = build(n / 2, next);
+    TreeNode* node;
+    try {
+        node = new TreeNode(next());
+    } catch (...) {
+        delete left;
+        throw;
+    }
+    node->left = left;
+    try {
+        node->right = build(n - n / 2 - 1, next);
+    } catch (...) {
+        delete node;
+        throw;
+    }
+    return node;
+}
+
+template <class T>
+template <class Generator>
+void BST<T>::assign_sorted(std::size_t n, Generator&& next) {
+    TreeNode* built = build(n, next);
+    delete root;
+    root = built;
+    count = n;
+}
+
+template <class T>
+void BST<T>::save_shape(std::ostream& out) const {
+    SnapshotHeader header =
+        SnapshotHeader::make<T, std::uint8_t>(SnapshotHeader::kShape, count);
+    header.write(out);
+    SnapshotWriter<T, std::uint8_t> writer(out, header);
+    std::vector<const TreeNode*> pending;
+    if (root) pending.push_back(root);
+    while (!pending.empty()) {
+        const TreeNode* node = pending.back();
+        pending.pop_back();
+        std::uint8_t shape = (node->left ? 1 : 0) | (node->right ? 2 : 0);
+        writer.push(node->data, shape);
+        if (node->right) pending.push_back(node->right);
+        if (node->left) pending.push_back(node->left);
+    }
+    writer.flush();
+    if (!out) throw std::runtime_error("falha ao gravar a forma da árvore");
+}
+
+template <class T>
+void BST<T>::load_shape(std::istream& in) {
+    SnapshotHeader header = SnapshotHeader::read(
+        in, SnapshotHeader::make<T, std::uint8_t>(SnapshotHeader::kShape, 0));
+    SnapshotReader<T, std::uint8_t> reader(in, header, false);
+
+    TreeNode* built = nullptr;
+    // Posições vazias na ordem em que a pré-ordem as preenche.
+    std::vector<TreeNode**> slots;
+    if (header.count > 0) slots.push_back(&built);
+    try {
+        for (std::uint64_t i = 0; i < header.count; ++i) {
+            reader.advance();
+            std::uint8_t shape = reader.value();
+            if (slots.empty() || shape > 3) {
+                throw std::runtime_error("snapshot inválido: forma inconsistente");
+            }
+            TreeNode** slot = slots.back();
+            slots.pop_back();
+            *slot = new TreeNode(reader.key());
+            if (shape & 2) slots.push_back(&(*slot)->right);
+            if (shape & 1) slots.push_back(&(*slot)->left);
+        }
+        if (!slots.empty()) {
+            throw std::runtime_error("snapshot inválido: forma inconsistente");
+        }
+    } catch (...) {
+        delete built;
+        throw;
+    }
+    delete root;
+    root = built;
+    count = static_cast<std::size_t>(header.count);
+}
+
+template <class T>
+typename BST<T>::TreeNode* BST<T>::clone(const TreeNode* node) {
+    if (node == nullptr) return nullptr;
+
+    TreeNode* copy = new TreeNode(node->data);
+    // Pilha explícita de pares (origem, cópia) cujos filhos faltam clonar.
+    std::vector<std::pair<const TreeNode*, TreeNode*>> pending;
+    try {
+        pending.emplace_back(node, copy);
+        while (!pending.empty()) {
+            auto [from, to] = pending.back();
+            pending.pop_back();
+            if (from->left) {
+                to->left = new TreeNode(from->left->data);
+                pending.emplace_back(from->left, to->left);
+            }
+            if (from->right) {
+                to->right = new TreeNode(from->right->data);
+                pending.emplace_back(from->right, to->right);
+            }
+        }
+    } catch (...) {
+        delete copy;
+        throw;
+    }
+    return copy;
+}
 
 template <class T>
 BST<T>::~BST() {
@@ -235,19 +706,181 @@ BST<T>::~BST() {
 
 template <class T>
 bool BST<T>::insert(const T& value) {
-    return insert(root, value);
+    if (!insert(root, value)) return false;
+    ++count;
+    return true;
 }
 
 template <class T>
 bool BST<T>::remove(const T& value) {
-    return remove(root, value);
+    if (!remove(root, value)) return false;
+    --count;
+    return true;
+}
+
+template <class T>
+std::size_t BST<T>::erase_range(const T& lo, const T& hi) {
+    std::size_t removed = release(cut_range(lo, hi));
+    count -= removed;
+    return removed;
+}
+
+template <class T>
+BST<T> BST<T>::extract_range(const T& lo, const T& hi) {
+    BST result;
+    result.root = cut_range(lo, hi);
+    result.count = tally(result.root);
+    count -= result.count;
+    return result;
+}
+
+template <class T>
+const T* BST<T>::lower_bound(const T& value) const {
+    const TreeNode* node = above(value, true);
+    return node ? &node->data : nullptr;
+}
+
+template <class T>
+const T* BST<T>::upper_bound(const T& value) const {
+    const TreeNode* node = above(value, false);
+    return node ? &node->data : nullptr;
+}
+
+template <class T>
+const T* BST<T>::ceiling(const T& value) const {
+    return lower_bound(value);
+}
+
+template <class T>
+const T* BST<T>::floor(const T& value) const {
+    const TreeNode* node = below(value, true);
+    return node ? &node->data : nullptr;
+}
+
+template <class T>
+const T* BST<T>::successor(const T& value) const {
+    return upper_bound(value);
+}
+
+template <class T>
+const T* BST<T>::predecessor(const T& value) const {
+    const TreeNode* node = below(value, false);
+    return node ? &node->data : nullptr;
+}
+
+template <class T>
+const T* BST<T>::nearest(const T& value) const {
+    const T* low = floor(value);
+    const T* high = ceiling(value);
+    if (!low) return high;
+    if (!high) return low;
+    return closer_above(*low, value, *high) ? high : low;
+}
+
+template <class T>
+const typename BST<T>::TreeNode* BST<T>::above(const T& value, bool inclusive) const {
+    const TreeNode* best = nullptr;
+    const TreeNode* node = root;
+    while (node) {
+        bool fits = inclusive ? !(node->data < value) : value < node->data;
+        if (fits) {
+            best = node;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+    return best;
+}
+
+template <class T>
+const typename BST<T>::TreeNode* BST<T>::below(const T& value, bool inclusive) const {
+    const TreeNode* best = nullptr;
+    const TreeNode* node = root;
+    while (node) {
+        bool fits = inclusive ? !(value < node->data) : node->data < value;
+        if (fits) {
+            best = node;
+            node = node->right;
+        } else {
+            node = node->left;
+        }
+    }
+    return best;
 }
 
 template <class T>
 bool BST<T>::contain(const T& value) const {
+    if (threaded) return find_threaded(value) != nullptr;
     return contain(root, value);
 }
 
+template <class T>
+const typename BST<T>::TreeNode* BST<T>::find_threaded(const T& value) const {
+    const TreeNode* turn = nullptr;  // Último nó em que a descida foi à esquerda.
+    const TreeNode* node = root;
+    while (node) {
+        if (value < node->data) {
+            turn = node;
+            node = node->left;
+        } else if (node->data < value) {
+            node = node->right == turn ? nullptr : node->right;
+        } else {
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+template <class T>
+std::size_t BST<T>::find_many(const T* values, std::size_t n, const T** found) const {
+    std::size_t hits = 0;
+    const TreeNode* current[kBatchGroup];
+    for (std::size_t first = 0; first < n; first += kBatchGroup) {
+        std::size_t m = std::min(kBatchGroup, n - first);
+        for (std::size_t i = 0; i < m; ++i) {
+            current[i] = root;
+            found[first + i] = nullptr;
+        }
+        std::size_t active = root ? m : 0;
+        while (active > 0) {
+            active = 0;
+            for (std::size_t i = 0; i < m; ++i) {
+                const TreeNode* node = current[i];
+                if (!node) continue;
+                const T& value = values[first + i];
+                if (value < node->data) {
+                    node = node->left;
+                } else if (node->data < value) {
+                    node = node->right;
+                } else {
+                    found[first + i] = &node->data;
+                    ++hits;
+                    node = nullptr;
+                }
+                current[i] = node;
+                if (node) {
+                    prefetch_read(node);
+                    ++active;
+                }
+            }
+        }
+    }
+    return hits;
+}
+
+template <class T>
+std::size_t BST<T>::contains_many(const T* values, std::size_t n, bool* found) const {
+    const T* nodes[kBatchGroup];
+    std::size_t hits = 0;
+    for (std::size_t first = 0; first < n; first += kBatchGroup) {
+        std::size_t m = std::min(kBatchGroup, n - first);
+        hits += find_many(values + first, m, nodes);
+        for (std::size_t i = 0; i < m; ++i) found[first + i] = nodes[i] != nullptr;
+    }
+    return hits;
+}
+
 template <class T>
 bool BST<T>::insert(TreeNode*& node, const T& value) {
     if (node == nullptr) {
@@ -289,20 +922,16 @@ bool BST<T>::remove(TreeNode*& node, const T& value) {
         return remove(node->right, value);
     } else {
         if (node->left == nullptr && node->right == nullptr) {
-            delete node;
+            dispose(node);
             node = nullptr;
         } else if (node->left == nullptr) {
             TreeNode* toDelete = node;
             node = node->right;
-            toDelete->left = nullptr;
-            toDelete->right = nullptr;
-            delete toDelete;
+            dispose(toDelete);
         } else if (node->right == nullptr) {
             TreeNode* toDelete = node;
             node = node->left;
-            toDelete->left = nullptr;
-            toDelete->right = nullptr;
-            delete toDelete;
+            dispose(toDelete);
         } else {
             TreeNode* successor = node->right->min();
             node->data = successor->data;
@@ -313,46 +942,199 @@ bool BST<T>::remove(TreeNode*& node, const T& value) {
 }
 
 template <class T>
-void BST<T>::in_order(const TreeNode* const node, std::vector<T>& result) const {
-    if (node == nullptr) return;
-    in_order(node->left, result);
-    result.push_back(node->data);
-    in_order(node->right, result);
+void BST<T>::dispose(TreeNode* node) {
+    node->left = nullptr;
+    node->right = nullptr;
+    if (reclaimer) {
+        reclaimer->retire(node);
+    } else {
+        delete node;
+    }
 }
 
 template <class T>
-std::vector<T> BST<T>::in_order() const {
-    std::vector<T> result;
-    in_order(root, result);
-    return result;
+std::size_t BST<T>::release(TreeNode* node) {
+    std::size_t released = 0;
+    std::vector<TreeNode*> pending;
+    if (node) pending.push_back(node);
+    while (!pending.empty()) {
+        TreeNode* current = pending.back();
+        pending.pop_back();
+        if (current->left) pending.push_back(current->left);
+        if (current->right) pending.push_back(current->right);
+        dispose(current);
+        ++released;
+    }
+    return released;
 }
 
 template <class T>
-void BST<T>::pre_order(const TreeNode* const node, std::vector<T>& result) const {
-    if (node == nullptr) return;
-    result.push_back(node->data);
-    pre_order(node->left, result);
-    pre_order(node->right, result);
+std::size_t BST<T>::tally(const TreeNode* node) {
+    std::size_t total = 0;
+    std::vector<const TreeNode*> pending;
+    if (node) pending.push_back(node);
+    while (!pending.empty()) {
+        const TreeNode* current = pending.back();
+        pending.pop_back();
+        if (current->left) pending.push_back(current->left);
+        if (current->right) pending.push_back(current->right);
+        ++total;
+    }
+    return total;
 }
 
 template <class T>
-std::vector<T> BST<T>::pre_order() const {
+std::pair<typename BST<T>::TreeNode*, typename BST<T>::TreeNode*>
+BST<T>::split(TreeNode* node, const T& value) {
+    TreeNode* less = nullptr;
+    TreeNode* rest = nullptr;
+    TreeNode** lessTail = &less;  // Filho direito livre da parte menor.
+    TreeNode** restTail = &rest;  // Filho esquerdo livre da parte restante.
+    while (node) {
+        if (node->data < value) {
+            *lessTail = node;
+            lessTail = &node->right;
+            node = node->right;
+        } else {
+            *restTail = node;
+            restTail = &node->left;
+            node = node->left;
+        }
+    }
+    *lessTail = nullptr;
+    *restTail = nullptr;
+    return {less, rest};
+}
+
+template <class T>
+typename BST<T>::TreeNode* BST<T>::cut_range(const T& lo, const T& hi) {
+    if (!(lo < hi)) return nullptr;
+    std::pair<TreeNode*, TreeNode*> below = split(root, lo);
+    std::pair<TreeNode*, TreeNode*> inside = split(below.second, hi);
+    if (below.first) {
+        below.first->max()->right = inside.second;
+        root = below.first;
+    } else {
+        root = inside.second;
+    }
+    return inside.first;
+}
+
+template <class T>
+std::vector<T> BST<T>::in_order() const {
     std::vector<T> result;
-    pre_order(root, result);
+    result.reserve(count);
+    in_order(std::back_inserter(result));
     return result;
 }
 
 template <class T>
-void BST<T>::post_order(const TreeNode* const node, std::vector<T>& result) const {
-    if (node == nullptr) return;
-    post_order(node->left, result);
-    post_order(node->right, result);
-    result.push_back(node->data);
+std::vector<T> BST<T>::pre_order() const {
+    std::vector<T> result;
+    result.reserve(count);
+    pre_order(std::back_inserter(result));
+    return result;
 }
 
 template <class T>
 std::vector<T> BST<T>::post_order() const {
     std::vector<T> result;
-    post_order(root, result);
+    result.reserve(count);
+    post_order(std::back_inserter(result));
     return result;
 }
+
+template <class T>
+template <class F>
+bool BST<T>::for_each_in_order(F&& f) const {
+    return walk_in_order(root, [&f](const TreeNode* node) {
+        return keep_visiting(f, node->data);
+    });
+}
+
+template <class T>
+template <class F>
+bool BST<T>::for_each_pre_order(F&& f) const {
+    return walk_pre_order(root, [&f](const TreeNode* node) {
+        return keep_visiting(f, node->data);
+    });
+}
+
+template <class T>
+template <class F>
+bool BST<T>::for_each_post_order(F&& f) const {
+    return walk_post_order(root, [&f](const TreeNode* node) {
+        return keep_visiting(f, node->data);
+    });
+}
+
+template <class T>
+template <class F>
+bool BST<T>::for_each_in_order_morris(F&& f) {
+    // Enquanto `threaded`, contain segue as costuras sem entrar em ciclo.
+    threaded = true;
+    try {
+        bool complete = walk_morris(root, [&f](const TreeNode* node) {
+            return keep_visiting(f, node->data);
+        });
+        threaded = false;
+        return complete;
+    } catch (...) {
+        threaded = false;
+        throw;
+    }
+}
+
+template <class T>
+template <class OutputIt>
+OutputIt BST<T>::in_order_morris(OutputIt out) {
+    for_each_in_order_morris([&out](const T& value) { *out++ = value; });
+    return out;
+}
+
+template <class T>
+template <class F>
+void BST<T>::parallel_for_each_in_order(F&& f, unsigned threads) const {
+    if (threads == 0) {
+        threads = count < kParallelMin ? 1 : std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (threads == 1) {
+        std::size_t position = 0;
+        walk_in_order(root, [&](const TreeNode* node) {
+            f(node->data, position++);
+            return true;
+        });
+        return;
+    }
+    walk_in_order_parallel(root, threads, [&f](const TreeNode* node, std::size_t position) {
+        f(node->data, position);
+    });
+}
+
+template <class T>
+T* BST<T>::parallel_export(T* out, unsigned threads) const {
+    parallel_for_each_in_order([out](const T& value, std::size_t i) { out[i] = value; },
+                               threads);
+    return out + count;
+}
+
+template <class T>
+template <class OutputIt>
+OutputIt BST<T>::in_order(OutputIt out) const {
+    for_each_in_order([&out](const T& value) { *out++ = value; });
+    return out;
+}
+
+template <class T>
+template <class OutputIt>
+OutputIt BST<T>::pre_order(OutputIt out) const {
+    for_each_pre_order([&out](const T& value) { *out++ = value; });
+    return out;
+}
+
+template <class T>
+template <class OutputIt>
+OutputIt BST<T>::post_order(OutputIt out) const {
+    for_each_post_order([&out](const T& value) { *out++ = value; });
+    return out;
+}
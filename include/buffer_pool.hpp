@@ -0,0 +1,346 @@
+#pragma once
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "serial.hpp"
+
+class BufferPool;
+
+/**
+ * @brief Referência a uma página fixada no `BufferPool`.
+ *
+ * Enquanto existir, a página não é despejada. Ao ser destruída solta a
+ * fixação, marcando a página como suja se `mark_dirty` foi chamado.
+ */
+class PageRef {
+ public:
+  PageRef() : pool(nullptr), id(0), bytes(nullptr), dirty(false) {}
+  PageRef(PageRef&& other) noexcept
+      : pool(other.pool), id(other.id), bytes(other.bytes), dirty(other.dirty) {
+    other.pool = nullptr;
+  }
+  PageRef& operator=(PageRef&& other) noexcept {
+    std::swap(pool, other.pool);
+    std::swap(id, other.id);
+    std::swap(bytes, other.bytes);
+    std::swap(dirty, other.dirty);
+    return *this;
+  }
+  PageRef(const PageRef&) = delete;
+  PageRef& operator=(const PageRef&) = delete;
+  inline ~PageRef();
+
+  /**
+   * @brief Indica se a referência fixa alguma página.
+   */
+  explicit operator bool() const { return pool != nullptr; }
+
+  /**
+   * @brief Número da página no arquivo.
+   */
+  std::uint64_t page() const { return id; }
+
+  /**
+   * @brief Conteúdo da página (`BufferPool::kPageSize` bytes; os 4 primeiros
+   * são reservados para o checksum).
+   */
+  char* data() const { return bytes; }
+
+  /**
+   * @brief Indica que a página foi alterada e precisa ser gravada.
+   */
+  void mark_dirty() { dirty = true; }
+
+ private:
+  friend class BufferPool;
+  PageRef(BufferPool* p, std::uint64_t i, char* b)
+      : pool(p), id(i), bytes(b), dirty(false) {}
+
+  BufferPool* pool;
+  std::uint64_t id;
+  char* bytes;
+  bool dirty;
+};
+
+/**
+ * @brief Cache de páginas de tamanho fixo de um arquivo, com substituição
+ * CLOCK e escrita adiada das páginas sujas.
+ *
+ * Cada página reserva os 4 primeiros bytes para o CRC-32 dos demais, gravado
+ * na escrita de volta e conferido em cada leitura do disco; uma página
+ * corrompida gera `std::runtime_error` em vez de dados inválidos.
+ *
+ * O CLOCK aproxima o LRU com um bit de referência por quadro: o ponteiro
+ * percorre os quadros, dá uma segunda chance aos referenciados e despeja o
+ * primeiro não fixado e não referenciado. Não é seguro para uso concorrente.
+ */
+class BufferPool {
+ public:
+  static constexpr std::size_t kPageSize = 4096;  ///< Bytes por página.
+  static constexpr std::size_t kChecksum = 4;     ///< Bytes do CRC.
+
+  /**
+   * @brief Abre (ou cria) o arquivo de páginas.
+   *
+   * @param path Caminho do arquivo.
+   * @param frames Quantidade de páginas mantidas em memória.
+   * @throw std::system_error se o arquivo não puder ser aberto.
+   * @throw std::invalid_argument se `frames` for zero.
+   */
+  BufferPool(const std::string& path, std::size_t frames);
+
+  /**
+   * @brief Grava as páginas sujas e fecha o arquivo.
+   */
+  ~BufferPool();
+
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  /**
+   * @brief Fixa a página `page`, lendo-a do disco se necessário.
+   *
+   * @throw std::runtime_error se o checksum não conferir ou se todas as
+   * páginas em memória estiverem fixadas.
+   */
+  PageRef fetch(std::uint64_t page);
+
+  /**
+   * @brief Fixa a página `page` apenas se ela já estiver em memória.
+   *
+   * @return Referência vazia se a página precisar ser lida do disco.
+   */
+  PageRef lookup(std::uint64_t page);
+
+  /**
+   * @brief Coloca em memória uma página lida por fora (por exemplo, por
+   * `AsyncReader`) e a fixa.
+   *
+   * @param page Número da página.
+   * @param bytes `kPageSize` bytes lidos do arquivo.
+   * @throw std::runtime_error se o checksum não conferir.
+   */
+  PageRef install(std::uint64_t page, const char* bytes);
+
+  /**
+   * @brief Descritor do arquivo, para leituras feitas fora do cache.
+   */
+  int descriptor() const { return fd; }
+
+  /**
+   * @brief Acrescenta uma página zerada ao fim do arquivo e a fixa.
+   */
+  PageRef allocate();
+
+  /**
+   * @brief Grava todas as páginas sujas e sincroniza o arquivo.
+   */
+  void flush();
+
+  /**
+   * @brief Quantidade de páginas do arquivo.
+   */
+  std::uint64_t page_count() const { return pages; }
+
+  std::uint64_t hits() const { return hit_count; }      ///< Acertos.
+  std::uint64_t misses() const { return miss_count; }   ///< Leituras do disco.
+
+ private:
+  friend class PageRef;
+
+  struct Frame {
+    std::uint64_t page = 0;
+    int pins = 0;
+    bool used = false;
+    bool dirty = false;
+    bool referenced = false;
+  };
+
+  char* frame_data(std::size_t frame) { return memory.get() + frame * kPageSize; }
+
+  /**
+   * @brief Escolhe um quadro livre, despejando uma página pelo CLOCK.
+   */
+  std::size_t victim();
+
+  void write_back(std::size_t frame);
+  void read_in(std::size_t frame, std::uint64_t page);
+  static void verify(const char* data, std::uint64_t page);
+  void unpin(std::uint64_t page, bool dirty);
+
+  int fd;
+  std::uint64_t pages;
+  std::vector<Frame> frames;
+  std::unique_ptr<char[]> memory;
+  std::unordered_map<std::uint64_t, std::size_t> table;  ///< Página -> quadro.
+  std::size_t hand = 0;                                  ///< Ponteiro do CLOCK.
+  std::uint64_t hit_count = 0;
+  std::uint64_t miss_count = 0;
+};
+
+PageRef::~PageRef() {
+  if (pool) pool->unpin(id, dirty);
+}
+
+inline BufferPool::BufferPool(const std::string& path, std::size_t count)
+    : frames(count), memory(new char[count * kPageSize]) {
+  if (count == 0) throw std::invalid_argument("BufferPool sem quadros");
+  fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "open " + path);
+  }
+  struct stat info;
+  if (::fstat(fd, &info) != 0) {
+    int error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(), "fstat " + path);
+  }
+  pages = static_cast<std::uint64_t>(info.st_size) / kPageSize;
+}
+
+inline BufferPool::~BufferPool() {
+  try {
+    flush();
+  } catch (...) {
+    // Destrutores não propagam; quem precisa do erro chama flush() antes.
+  }
+  ::close(fd);
+}
+
+inline std::size_t BufferPool::victim() {
+  for (std::size_t step = 0; step < 2 * frames.size(); ++step) {
+    std::size_t frame = hand;
+    hand = (hand + 1) % frames.size();
+    Frame& f = frames[frame];
+    if (!f.used) return frame;
+    if (f.pins > 0) continue;
+    if (f.referenced) {
+      f.referenced = false;
+      continue;
+    }
+    if (f.dirty) write_back(frame);
+    table.erase(f.page);
+    f.used = false;
+    return frame;
+  }
+  throw std::runtime_error("BufferPool: todas as páginas estão fixadas");
+}
+
+inline void BufferPool::write_back(std::size_t frame) {
+  char* data = frame_data(frame);
+  std::uint32_t crc = crc32(data + kChecksum, kPageSize - kChecksum);
+  std::memcpy(data, &crc, sizeof(crc));
+
+  off_t offset = static_cast<off_t>(frames[frame].page * kPageSize);
+  std::size_t done = 0;
+  while (done < kPageSize) {
+    ssize_t written = ::pwrite(fd, data + done, kPageSize - done,
+                               offset + static_cast<off_t>(done));
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      throw std::system_error(errno, std::generic_category(), "pwrite");
+    }
+    done += static_cast<std::size_t>(written);
+  }
+  frames[frame].dirty = false;
+}
+
+inline void BufferPool::read_in(std::size_t frame, std::uint64_t page) {
+  char* data = frame_data(frame);
+  off_t offset = static_cast<off_t>(page * kPageSize);
+  std::size_t done = 0;
+  while (done < kPageSize) {
+    ssize_t got = ::pread(fd, data + done, kPageSize - done,
+                          offset + static_cast<off_t>(done));
+    if (got < 0) {
+      if (errno == EINTR) continue;
+      throw std::system_error(errno, std::generic_category(), "pread");
+    }
+    if (got == 0) throw std::runtime_error("BufferPool: página além do fim");
+    done += static_cast<std::size_t>(got);
+  }
+  verify(data, page);
+}
+
+inline void BufferPool::verify(const char* data, std::uint64_t page) {
+  std::uint32_t stored = 0;
+  std::memcpy(&stored, data, sizeof(stored));
+  if (stored != crc32(data + kChecksum, kPageSize - kChecksum)) {
+    throw std::runtime_error("BufferPool: checksum inválido na página " +
+                             std::to_string(page));
+  }
+}
+
+inline PageRef BufferPool::fetch(std::uint64_t page) {
+  auto it = table.find(page);
+  std::size_t frame;
+  if (it != table.end()) {
+    frame = it->second;
+    ++hit_count;
+  } else {
+    if (page >= pages) throw std::out_of_range("BufferPool: página inexistente");
+    frame = victim();
+    read_in(frame, page);
+    frames[frame] = Frame{page, 0, true, false, false};
+    table.emplace(page, frame);
+    ++miss_count;
+  }
+  frames[frame].pins++;
+  frames[frame].referenced = true;
+  return PageRef(this, page, frame_data(frame));
+}
+
+inline PageRef BufferPool::lookup(std::uint64_t page) {
+  auto it = table.find(page);
+  if (it == table.end()) return PageRef();
+  return fetch(page);
+}
+
+inline PageRef BufferPool::install(std::uint64_t page, const char* bytes) {
+  if (table.count(page)) return fetch(page);
+  if (page >= pages) throw std::out_of_range("BufferPool: página inexistente");
+  verify(bytes, page);
+  std::size_t frame = victim();
+  std::memcpy(frame_data(frame), bytes, kPageSize);
+  frames[frame] = Frame{page, 1, true, false, true};
+  table.emplace(page, frame);
+  ++miss_count;
+  return PageRef(this, page, frame_data(frame));
+}
+
+inline PageRef BufferPool::allocate() {
+  std::size_t frame = victim();
+  std::uint64_t page = pages++;
+  std::memset(frame_data(frame), 0, kPageSize);
+  frames[frame] = Frame{page, 1, true, true, true};
+  table.emplace(page, frame);
+  return PageRef(this, page, frame_data(frame));
+}
+
+inline void BufferPool::unpin(std::uint64_t page, bool dirty) {
+  Frame& frame = frames[table.at(page)];
+  frame.pins--;
+  if (dirty) frame.dirty = true;
+}
+
+inline void BufferPool::flush() {
+  for (std::size_t frame = 0; frame < frames.size(); ++frame) {
+    if (frames[frame].used && frames[frame].dirty) write_back(frame);
+  }
+  if (::fdatasync(fd) != 0) {
+    throw std::system_error(errno, std::generic_category(), "fdatasync");
+  }
+}
@@ -0,0 +1,429 @@
+#pragma once
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "serial.hpp"
+#include "set.hpp"
+
+/**
+ * @brief Converte uma linha de texto num valor de `T`.
+ *
+ * Especializado para `std::string` (a linha inteira), inteiros e ponto
+ * flutuante. Outros tipos usam a sobrecarga de `BulkLoader::read_lines` que
+ * recebe um conversor.
+ */
+template <class T, class Enable = void>
+struct LineParser;
+
+template <>
+struct LineParser<std::string> {
+  static std::string parse(std::string_view line) { return std::string(line); }
+};
+
+/// Inteiros fora do intervalo de `T` (e negativos, se `T` não tiver sinal)
+/// são rejeitados em vez de truncados.
+template <class T>
+struct LineParser<T, std::enable_if_t<std::is_integral<T>::value>> {
+  static T parse(std::string_view line) {
+    std::string text(line);
+    char* end = nullptr;
+    errno = 0;
+    bool in_range;
+    T value;
+    if constexpr (std::is_signed<T>::value) {
+      long long parsed = std::strtoll(text.c_str(), &end, 10);
+      in_range = parsed >= std::numeric_limits<T>::min() &&
+                 parsed <= std::numeric_limits<T>::max();
+      value = static_cast<T>(parsed);
+    } else {
+      // strtoull aceita '-' e devolve o valor negado módulo 2^64.
+      bool negative = text.find('-') != std::string::npos;
+      unsigned long long parsed = std::strtoull(text.c_str(), &end, 10);
+      in_range = !negative && parsed <= std::numeric_limits<T>::max();
+      value = static_cast<T>(parsed);
+    }
+    if (end == text.c_str() || *end != '\0' || errno == ERANGE || !in_range) {
+      throw std::runtime_error("valor inválido: " + text);
+    }
+    return value;
+  }
+};
+
+template <class T>
+struct LineParser<T, std::enable_if_t<std::is_floating_point<T>::value>> {
+  static T parse(std::string_view line) {
+    std::string text(line);
+    char* end = nullptr;
+    T value = static_cast<T>(std::strtold(text.c_str(), &end));
+    if (end == text.c_str() || *end != '\0') {
+      throw std::runtime_error("valor inválido: " + text);
+    }
+    return value;
+  }
+};
+
+/**
+ * @brief Carrega um `Set` de uma sequência arbitrária de valores com memória
+ * limitada.
+ *
+ * Os valores são acumulados num buffer; quando o buffer passa de `budget`
+ * bytes ele é ordenado, tem duplicatas removidas e é gravado como uma
+ * corrida ordenada num arquivo temporário (via `BinaryCodec`). `finish`
+ * intercala as corridas (k-way merge com heap) e constrói a AVL de baixo
+ * para cima com `Set::assign_sorted`, em O(n), sem descidas por chave.
+ *
+ * Como `assign_sorted` precisa do total antecipadamente e valores repetidos
+ * podem estar em corridas diferentes, a intercalação é feita duas vezes: uma
+ * para contar os valores distintos e outra para construir a árvore. Durante
+ * a intercalação só um bloco de cada corrida fica em memória, de modo que o
+ * pico fica próximo do tamanho da árvore final.
+ *
+ * @tparam T Tipo dos elementos. Deve suportar o operador '<' e ter
+ * `BinaryCodec`.
+ */
+template <class T>
+class BulkLoader {
+ public:
+  static constexpr std::size_t kBlock = 4096;  ///< Elementos lidos por vez.
+
+  /**
+   * @brief Cria um carregador vazio.
+   *
+   * @param budget Memória aproximada do buffer antes de gravar uma corrida.
+   * @param directory Diretório dos arquivos temporários (padrão: `$TMPDIR`
+   * ou `/tmp`).
+   */
+  explicit BulkLoader(std::size_t budget = std::size_t(64) << 20,
+                      std::string directory = std::string());
+
+  /**
+   * @brief Remove os arquivos temporários restantes.
+   */
+  ~BulkLoader();
+
+  BulkLoader(const BulkLoader&) = delete;
+  BulkLoader& operator=(const BulkLoader&) = delete;
+
+  /**
+   * @brief Acrescenta um valor.
+   */
+  void add(const T& value);
+
+  /**
+   * @brief Acrescenta um valor por linha não vazia, usando `LineParser<T>`.
+   *
+   * A entrada é lida em blocos, sem carregar o arquivo inteiro.
+   *
+   * @throw std::runtime_error se uma linha não puder ser convertida.
+   */
+  void read_lines(std::istream& in) {
+    read_lines(in, [](std::string_view line) { return LineParser<T>::parse(line); });
+  }
+
+  /**
+   * @brief Acrescenta um valor por linha não vazia, usando `parse`.
+   *
+   * @param parse Função chamada como `parse(std::string_view)`.
+   */
+  template <class Parse>
+  void read_lines(std::istream& in, Parse parse);
+
+  /**
+   * @brief Acrescenta valores gravados como vetor bruto de `T`.
+   *
+   * Apenas para tipos trivialmente copiáveis.
+   */
+  void read_binary(std::istream& in);
+
+  /**
+   * @brief Quantidade de corridas gravadas em disco até agora.
+   */
+  std::size_t runs() const { return spilled.size(); }
+
+  /**
+   * @brief Substitui o conteúdo de `set` pelos valores distintos recebidos.
+   *
+   * Depois da chamada o carregador fica vazio e pode ser reutilizado.
+   *
+   * @param set Conjunto de destino.
+   */
+  void finish(Set<T>& set);
+
+ private:
+  /**
+   * @brief Corrida ordenada gravada num arquivo temporário.
+   */
+  struct Run {
+    std::string path;
+    std::fstream file;
+    std::uint64_t count = 0;      ///< Elementos gravados.
+    std::uint64_t remaining = 0;  ///< Elementos ainda não lidos.
+    std::vector<T> block;         ///< Bloco atual da leitura.
+    std::size_t position = 0;     ///< Próximo elemento de `block`.
+
+    /**
+     * @brief Volta ao início da corrida.
+     */
+    void rewind();
+
+    /**
+     * @brief Lê o próximo elemento; `false` no fim da corrida.
+     */
+    bool next(T& value);
+  };
+
+  /**
+   * @brief Intercala as corridas devolvendo cada valor distinto uma vez.
+   */
+  class Merger {
+   public:
+    explicit Merger(std::vector<std::unique_ptr<Run>>& runs);
+    bool next(T& value);
+
+   private:
+    using Entry = std::pair<T, std::size_t>;
+    struct Greater {
+      bool operator()(const Entry& a, const Entry& b) const {
+        return b.first < a.first;
+      }
+    };
+
+    std::vector<std::unique_ptr<Run>>& runs;
+    std::priority_queue<Entry, std::vector<Entry>, Greater> heap;
+    T last{};
+    bool has_last = false;
+  };
+
+  static std::size_t footprint(const T& value) {
+    if constexpr (std::is_same<T, std::string>::value) {
+      return sizeof(T) + value.size();
+    } else {
+      return sizeof(T);
+    }
+  }
+
+  /**
+   * @brief Ordena o buffer e remove valores repetidos.
+   */
+  void sort_buffer();
+
+  /**
+   * @brief Grava o buffer como uma nova corrida.
+   */
+  void spill();
+
+  void clear_runs();
+
+  std::size_t budget;
+  std::string directory;
+  std::vector<T> buffer;  ///< Valores ainda não gravados.
+  std::size_t bytes = 0;  ///< Memória aproximada de `buffer`.
+  std::vector<std::unique_ptr<Run>> spilled;
+};
+
+template <class T>
+BulkLoader<T>::BulkLoader(std::size_t b, std::string dir)
+    : budget(b), directory(std::move(dir)) {
+  if (directory.empty()) {
+    const char* tmp = std::getenv("TMPDIR");
+    directory = tmp && *tmp ? tmp : "/tmp";
+  }
+}
+
+template <class T>
+BulkLoader<T>::~BulkLoader() {
+  clear_runs();
+}
+
+template <class T>
+void BulkLoader<T>::clear_runs() {
+  for (auto& run : spilled) {
+    run->file.close();
+    std::remove(run->path.c_str());
+  }
+  spilled.clear();
+}
+
+template <class T>
+void BulkLoader<T>::add(const T& value) {
+  buffer.push_back(value);
+  bytes += footprint(value);
+  if (bytes >= budget) spill();
+}
+
+template <class T>
+template <class Parse>
+void BulkLoader<T>::read_lines(std::istream& in, Parse parse) {
+  std::vector<char> chunk(std::size_t(1) << 20);
+  std::string partial;
+  while (in) {
+    in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+    std::size_t got = static_cast<std::size_t>(in.gcount());
+    if (got == 0) break;
+
+    std::string_view data(chunk.data(), got);
+    std::size_t start = 0;
+    for (std::size_t end = data.find('\n'); end != std::string_view::npos;
+         start = end + 1, end = data.find('\n', start)) {
+      std::string_view line = data.substr(start, end - start);
+      if (!partial.empty()) {
+        partial.append(line.data(), line.size());
+        line = partial;
+      }
+      if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+      if (!line.empty()) add(parse(line));
+      partial.clear();
+    }
+    partial.append(data.data() + start, data.size() - start);
+  }
+  std::string_view line = partial;
+  if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+  if (!line.empty()) add(parse(line));
+}
+
+template <class T>
+void BulkLoader<T>::read_binary(std::istream& in) {
+  static_assert(BinaryCodec<T>::raw, "read_binary exige tipo trivialmente copiável");
+  std::vector<T> chunk(kBlock);
+  while (in) {
+    in.read(reinterpret_cast<char*>(chunk.data()),
+            static_cast<std::streamsize>(chunk.size() * sizeof(T)));
+    std::size_t got = static_cast<std::size_t>(in.gcount()) / sizeof(T);
+    for (std::size_t i = 0; i < got; ++i) add(chunk[i]);
+  }
+}
+
+template <class T>
+void BulkLoader<T>::sort_buffer() {
+  std::sort(buffer.begin(), buffer.end());
+  buffer.erase(std::unique(buffer.begin(), buffer.end(),
+                           [](const T& a, const T& b) { return !(a < b); }),
+               buffer.end());
+}
+
+template <class T>
+void BulkLoader<T>::spill() {
+  sort_buffer();
+
+  auto run = std::make_unique<Run>();
+  std::string name = directory + "/ed_bulk_XXXXXX";
+  int fd = ::mkstemp(&name[0]);
+  if (fd < 0) throw std::runtime_error("não foi possível criar arquivo em " + directory);
+  ::close(fd);
+  run->path = name;
+  run->file.open(name, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+  for (std::size_t i = 0; i < buffer.size(); i += kBlock) {
+    std::size_t n = std::min(kBlock, buffer.size() - i);
+    BinaryCodec<T>::write(run->file, buffer.data() + i, n);
+  }
+  run->file.flush();
+  if (!run->file) {
+    std::remove(name.c_str());
+    throw std::runtime_error("falha ao gravar corrida em " + name);
+  }
+  run->count = buffer.size();
+  spilled.push_back(std::move(run));
+
+  buffer.clear();
+  buffer.shrink_to_fit();
+  bytes = 0;
+}
+
+template <class T>
+void BulkLoader<T>::Run::rewind() {
+  file.clear();
+  file.seekg(0);
+  remaining = count;
+  block.clear();
+  position = 0;
+}
+
+template <class T>
+bool BulkLoader<T>::Run::next(T& value) {
+  if (position == block.size()) {
+    if (remaining == 0) return false;
+    std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(kBlock, remaining));
+    block.assign(n, T());
+    BinaryCodec<T>::read(file, block.data(), n);
+    if (!file) throw std::runtime_error("falha ao ler corrida " + path);
+    remaining -= n;
+    position = 0;
+  }
+  value = std::move(block[position++]);
+  return true;
+}
+
+template <class T>
+BulkLoader<T>::Merger::Merger(std::vector<std::unique_ptr<Run>>& r) : runs(r) {
+  for (std::size_t i = 0; i < runs.size(); ++i) {
+    runs[i]->rewind();
+    T value;
+    if (runs[i]->next(value)) heap.emplace(std::move(value), i);
+  }
+}
+
+template <class T>
+bool BulkLoader<T>::Merger::next(T& value) {
+  while (!heap.empty()) {
+    Entry top = heap.top();
+    heap.pop();
+    T following;
+    if (runs[top.second]->next(following)) {
+      heap.emplace(std::move(following), top.second);
+    }
+    if (has_last && !(last < top.first)) continue;  // repetido entre corridas
+    last = top.first;
+    has_last = true;
+    value = std::move(top.first);
+    return true;
+  }
+  return false;
+}
+
+template <class T>
+void BulkLoader<T>::finish(Set<T>& set) {
+  if (spilled.empty()) {
+    sort_buffer();
+    std::size_t i = 0;
+    set.assign_sorted(buffer.size(), [&] { return buffer[i++]; });
+    buffer.clear();
+    buffer.shrink_to_fit();
+    bytes = 0;
+    return;
+  }
+
+  if (!buffer.empty()) spill();
+
+  std::size_t distinct = 0;
+  {
+    Merger counter(spilled);
+    T value;
+    while (counter.next(value)) ++distinct;
+  }
+
+  Merger merger(spilled);
+  set.assign_sorted(distinct, [&] {
+    T value;
+    merger.next(value);
+    return value;
+  });
+  clear_runs();
+}
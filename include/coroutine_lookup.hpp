@@ -0,0 +1,299 @@
+#pragma once
+#if __cplusplus < 202002L
+#error "coroutine_lookup.hpp exige C++20 (configure com -DED_CXX20=ON)"
+#endif
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <utility>
+#include <vector>
+
+#include "avl.hpp"
+#include "map.hpp"
+#include "prefetch.hpp"
+
+/**
+ * @brief Busca executada como corrotina, retomada por um `Interleaver`.
+ *
+ * A corrotina começa suspensa e, a cada nó que vai visitar, pede o nó ao
+ * cache (prefetch) e se suspende; quando o executor volta a ela, o nó
+ * provavelmente já chegou. Com várias buscas em voo, as faltas de cache de
+ * uma ficam escondidas atrás do trabalho das outras, mesmo que sejam
+ * operações diferentes (busca exata, limite inferior, faixa).
+ *
+ * @tparam R Tipo do resultado.
+ */
+template <class R>
+class Lookup {
+ public:
+  struct promise_type {
+    R value{};
+    std::exception_ptr error;
+
+    Lookup get_return_object() {
+      return Lookup(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_value(R result) { value = std::move(result); }
+    void unhandled_exception() { error = std::current_exception(); }
+  };
+
+  Lookup(Lookup&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+  Lookup& operator=(Lookup&& other) noexcept {
+    std::swap(handle, other.handle);
+    return *this;
+  }
+  Lookup(const Lookup&) = delete;
+  Lookup& operator=(const Lookup&) = delete;
+  ~Lookup() {
+    if (handle) handle.destroy();
+  }
+
+  /**
+   * @brief Indica se a busca terminou.
+   */
+  bool done() const { return handle.done(); }
+
+  /**
+   * @brief Resultado da busca, executando-a até o fim se ainda não terminou.
+   *
+   * @throw O que a busca tiver lançado.
+   */
+  const R& result() {
+    while (!handle.done()) handle.resume();
+    if (handle.promise().error) std::rethrow_exception(handle.promise().error);
+    return handle.promise().value;
+  }
+
+ private:
+  friend class Interleaver;
+  explicit Lookup(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+  std::coroutine_handle<promise_type> handle;
+};
+
+/**
+ * @brief Executor round-robin de buscas em corrotina.
+ *
+ * Mantém até `width` buscas em voo e as retoma em rodízio: cada retomada
+ * avança uma busca um nó e a suspende no prefetch do próximo. Quando uma
+ * termina, a próxima da fila entra no lugar dela.
+ */
+class Interleaver {
+ public:
+  /**
+   * @param width Buscas em voo ao mesmo tempo (1 = uma por vez).
+   */
+  explicit Interleaver(std::size_t width = 16) : width(width ? width : 1) {}
+
+  /**
+   * @brief Agenda uma busca. Ela (e a estrutura consultada) deve continuar
+   * viva até `run` retornar.
+   */
+  template <class R>
+  void add(Lookup<R>& lookup) {
+    pending.push_back(lookup.handle);
+  }
+
+  /**
+   * @brief Executa todas as buscas agendadas até o fim.
+   */
+  void run() {
+    std::vector<std::coroutine_handle<>> active;
+    std::size_t next = 0;
+    while (next < pending.size() && active.size() < width) {
+      active.push_back(pending[next++]);
+    }
+    while (!active.empty()) {
+      for (std::size_t i = 0; i < active.size();) {
+        active[i].resume();
+        if (!active[i].done()) {
+          ++i;
+        } else if (next < pending.size()) {
+          active[i++] = pending[next++];
+        } else {
+          active[i] = active.back();
+          active.pop_back();
+        }
+      }
+    }
+    pending.clear();
+  }
+
+ private:
+  std::size_t width;
+  std::vector<std::coroutine_handle<>> pending;
+};
+
+/**
+ * @brief Ponto de suspensão: pede `node` ao cache e devolve o controle ao
+ * executor.
+ */
+struct NextNode {
+  const void* node;
+
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(std::coroutine_handle<>) const noexcept { prefetch_read(node); }
+  void await_resume() const noexcept {}
+};
+
+/**
+ * @brief Acesso às raízes de `BST`, `AVL` e `Map` para as corrotinas.
+ *
+ * As descidas usam apenas `data`, `left` e `right` dos nós e apenas '<' nos
+ * valores, então servem às duas árvores e aos pares do `Map`.
+ */
+struct CoroutineAccess {
+  template <class Tree>
+  static auto root(const Tree& tree) {
+    return static_cast<const std::remove_pointer_t<decltype(tree.root)>*>(tree.root);
+  }
+
+  template <class K, class V, class A>
+  static const auto& tree(const Map<K, V, A>& map) {
+    return map.data;
+  }
+
+  template <class K, class V, class A>
+  static auto probe(const Map<K, V, A>&, const K& key) {
+    return typename Map<K, V, A>::Pair(key);
+  }
+
+  /// Busca exata; `finish` converte o nó encontrado (ou nulo) no resultado.
+  template <class R, class Node, class T, class Finish>
+  static Lookup<R> find(const Node* node, T value, Finish finish) {
+    while (node) {
+      co_await NextNode{node};
+      if (value < node->data) {
+        node = node->left;
+      } else if (node->data < value) {
+        node = node->right;
+      } else {
+        co_return finish(node);
+      }
+    }
+    co_return finish(static_cast<const Node*>(nullptr));
+  }
+
+  /// Primeiro nó com valor >= `value`.
+  template <class R, class Node, class T, class Finish>
+  static Lookup<R> lower_bound(const Node* node, T value, Finish finish) {
+    const Node* best = nullptr;
+    while (node) {
+      co_await NextNode{node};
+      if (node->data < value) {
+        node = node->right;
+      } else {
+        best = node;
+        node = node->left;
+      }
+    }
+    co_return finish(best);
+  }
+
+  /// Visita, em ordem, os nós com valor em [lo, hi); devolve quantos.
+  template <class Node, class T, class Visit>
+  static Lookup<std::size_t> range(const Node* node, T lo, T hi, Visit visit) {
+    std::vector<const Node*> stack;
+    while (node) {
+      co_await NextNode{node};
+      if (node->data < lo) {
+        node = node->right;
+      } else {
+        stack.push_back(node);
+        node = node->left;
+      }
+    }
+    std::size_t visited = 0;
+    while (!stack.empty()) {
+      node = stack.back();
+      stack.pop_back();
+      if (!(node->data < hi)) break;
+      visit(node->data);
+      ++visited;
+      for (node = node->right; node; node = node->left) {
+        co_await NextNode{node};
+        stack.push_back(node);
+      }
+    }
+    co_return visited;
+  }
+};
+
+/**
+ * @brief Busca exata em corrotina: ponteiro para o elemento ou `nullptr`.
+ */
+template <class T, class A>
+Lookup<const T*> find_async(const AVL<T, A>& tree, const T& value) {
+  return CoroutineAccess::find<const T*>(
+      CoroutineAccess::root(tree), value,
+      [](const auto* node) { return node ? &node->data : nullptr; });
+}
+
+/**
+ * @brief Menor elemento >= `value` em corrotina, ou `nullptr`.
+ */
+template <class T, class A>
+Lookup<const T*> lower_bound_async(const AVL<T, A>& tree, const T& value) {
+  return CoroutineAccess::lower_bound<const T*>(
+      CoroutineAccess::root(tree), value,
+      [](const auto* node) { return node ? &node->data : nullptr; });
+}
+
+/**
+ * @brief Visita em ordem os elementos em [lo, hi) em corrotina.
+ *
+ * @param visit Chamada como `visit(const T&)`.
+ * @return Busca cujo resultado é a quantidade de elementos visitados.
+ */
+template <class T, class A, class Visit>
+Lookup<std::size_t> range_async(const AVL<T, A>& tree, const T& lo, const T& hi,
+                                Visit visit) {
+  return CoroutineAccess::range(CoroutineAccess::root(tree), lo, hi, std::move(visit));
+}
+
+/**
+ * @brief Busca de uma chave do `Map` em corrotina: ponteiro para o valor ou
+ * `nullptr`.
+ */
+template <class K, class V, class A>
+Lookup<const V*> find_async(const Map<K, V, A>& map, const K& key) {
+  return CoroutineAccess::find<const V*>(
+      CoroutineAccess::root(CoroutineAccess::tree(map)),
+      CoroutineAccess::probe(map, key),
+      [](const auto* node) { return node ? &node->data.value : nullptr; });
+}
+
+/**
+ * @brief Menor chave >= `key` do `Map` em corrotina: ponteiros para a chave
+ * e o valor, ou dois `nullptr`.
+ */
+template <class K, class V, class A>
+Lookup<std::pair<const K*, const V*>> lower_bound_async(const Map<K, V, A>& map,
+                                                        const K& key) {
+  return CoroutineAccess::lower_bound<std::pair<const K*, const V*>>(
+      CoroutineAccess::root(CoroutineAccess::tree(map)),
+      CoroutineAccess::probe(map, key), [](const auto* node) {
+        return node ? std::pair<const K*, const V*>(&node->data.key, &node->data.value)
+                    : std::pair<const K*, const V*>(nullptr, nullptr);
+      });
+}
+
+/**
+ * @brief Visita em ordem os pares com chave em [lo, hi) em corrotina.
+ *
+ * @param visit Chamada como `visit(const K&, const V&)`.
+ * @return Busca cujo resultado é a quantidade de pares visitados.
+ */
+template <class K, class V, class A, class Visit>
+Lookup<std::size_t> range_async(const Map<K, V, A>& map, const K& lo, const K& hi,
+                                Visit visit) {
+  return CoroutineAccess::range(
+      CoroutineAccess::root(CoroutineAccess::tree(map)),
+      CoroutineAccess::probe(map, lo), CoroutineAccess::probe(map, hi),
+      [visit = std::move(visit)](const auto& pair) mutable {
+        visit(pair.key, pair.value);
+      });
+}
@@ -0,0 +1,657 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "async_io.hpp"
+#include "buffer_pool.hpp"
+
+/**
+ * @brief Mapa associativo em disco (B+tree) para dados maiores que a memória.
+ *
+ * Os nós são páginas de `BufferPool::kPageSize` bytes num único arquivo;
+ * apenas `frames` páginas ficam em memória, com substituição CLOCK, escrita
+ * adiada das páginas sujas e checksum por página. Folhas guardam os pares em
+ * vetores ordenados e são ligadas entre si para a iteração; nós internos
+ * guardam separadores e filhos.
+ *
+ * A remoção é preguiçosa: o par sai da folha, mas folhas vazias ou pouco
+ * ocupadas não são fundidas (os separadores continuam válidos como limites).
+ * O espaço é reaproveitado pelas inserções seguintes na mesma faixa.
+ *
+ * Layout das páginas (após os 4 bytes do checksum):
+ * - página 0 (meta): magic "EDBT", versão, tamanhos de K e V, raiz, total;
+ * - nó: tipo (u16), quantidade (u32), próxima folha (u64) e, a partir do
+ *   byte 24, os vetores do nó.
+ *
+ * @tparam K Tipo da chave: trivialmente copiável, com '<'.
+ * @tparam V Tipo do valor: trivialmente copiável.
+ */
+template <class K, class V>
+class DiskMap {
+  static_assert(std::is_trivially_copyable<K>::value &&
+                    std::is_trivially_copyable<V>::value,
+                "DiskMap exige chave e valor trivialmente copiáveis");
+  static_assert(alignof(K) <= 8 && alignof(V) <= 8,
+                "DiskMap exige alinhamento de até 8 bytes");
+
+ public:
+  /**
+   * @brief Referência a um valor do mapa, devolvida por `operator[]`.
+   *
+   * Como a página pode ser despejada a qualquer momento, o valor não é
+   * acessado por ponteiro: a leitura e a atribuição refazem a busca.
+   */
+  class Reference {
+   public:
+    operator V() const { return map->get(key); }
+
+    Reference& operator=(const V& value) {
+      map->put(key, value, true);
+      return *this;
+    }
+
+    Reference& operator=(const Reference& other) { return *this = V(other); }
+
+   private:
+    friend class DiskMap;
+    Reference(DiskMap* m, const K& k) : map(m), key(k) {}
+
+    DiskMap* map;
+    K key;
+  };
+
+  /**
+   * @brief Abre (ou cria) o mapa no arquivo indicado.
+   *
+   * @param path Caminho do arquivo.
+   * @param frames Páginas mantidas em memória (mínimo 8).
+   * @throw std::runtime_error se o arquivo for de outro tipo ou estiver
+   * corrompido.
+   */
+  explicit DiskMap(const std::string& path, std::size_t frames = 1024);
+
+  /**
+   * @brief Grava as páginas sujas.
+   */
+  ~DiskMap();
+
+  DiskMap(const DiskMap&) = delete;
+  DiskMap& operator=(const DiskMap&) = delete;
+
+  /**
+   * @brief Acessa o valor associado a uma chave, inserindo `V()` se ela não
+   * existir.
+   */
+  Reference operator[](const K& key);
+
+  /**
+   * @brief Acessa o valor associado a uma chave (versão constante).
+   *
+   * @throw std::out_of_range se a chave não for encontrada.
+   */
+  V operator[](const K& key) const { return get(key); }
+
+  /**
+   * @brief Remove um par chave-valor.
+   *
+   * @return `true` se a chave existia.
+   */
+  bool remove(const K& key);
+
+  /**
+   * @brief Verifica se a chave está presente.
+   */
+  bool contains(const K& key) const;
+
+  /**
+   * @brief Busca várias chaves de uma vez, lendo as páginas ausentes do cache
+   * de forma assíncrona.
+   *
+   * Todas as descidas avançam enquanto encontram páginas em memória; cada
+   * página ausente gera uma única leitura (mesmo que várias buscas precisem
+   * dela), com até `async_depth` leituras em voo. À medida que as páginas
+   * chegam, as buscas que esperavam por elas continuam a descida.
+   *
+   * @param keys Chaves buscadas.
+   * @param count Quantidade de chaves.
+   * @param values Se não nulo, recebe o valor de cada chave encontrada (as
+   * posições das ausentes não são alteradas).
+   * @param found Se não nulo, recebe se cada chave foi encontrada.
+   * @return Quantidade de chaves encontradas.
+   * @throw std::system_error se uma leitura falhar.
+   * @throw std::runtime_error se uma página estiver corrompida.
+   */
+  std::size_t find_many(const K* keys, std::size_t count, V* values,
+                        bool* found) const;
+
+  /**
+   * @brief Verifica a presença de várias chaves (ver `find_many`).
+   */
+  std::size_t contains_many(const K* keys, std::size_t count, bool* found) const {
+    return find_many(keys, count, nullptr, found);
+  }
+
+  /**
+   * @brief Define as leituras em voo e o mecanismo usados por `find_many`.
+   */
+  void set_async_io(std::size_t depth,
+                    AsyncReader::Backend backend = AsyncReader::Backend::kAuto) {
+    reader.reset(new AsyncReader(pool.descriptor(), depth, backend));
+  }
+
+  /**
+   * @brief Mecanismo de leitura assíncrona em uso.
+   */
+  AsyncReader::Backend async_backend() const { return async_reader().backend(); }
+
+  /**
+   * @brief Retorna a quantidade de pares.
+   */
+  std::size_t size() const { return static_cast<std::size_t>(count); }
+
+  /**
+   * @brief Visita os pares em ordem de chave.
+   *
+   * @param f Função chamada como `f(const K&, const V&)`.
+   */
+  template <class F>
+  void for_each(F&& f) const;
+
+  /**
+   * @brief Grava as páginas sujas e sincroniza o arquivo.
+   */
+  void flush();
+
+  /**
+   * @brief Cache de páginas (para estatísticas).
+   */
+  const BufferPool& buffer_pool() const { return pool; }
+
+ private:
+  static constexpr std::size_t kData = 24;  ///< Início dos vetores do nó.
+  static constexpr std::size_t kSpace = BufferPool::kPageSize - kData - 8;
+
+  /// Pares por folha.
+  static constexpr std::size_t kLeaf = kSpace / (sizeof(K) + sizeof(V));
+  /// Separadores por nó interno (com kInner + 1 filhos).
+  static constexpr std::size_t kInner = (kSpace - 8) / (sizeof(K) + 8);
+
+  static_assert(kLeaf >= 3 && kInner >= 3, "chave ou valor grandes demais");
+
+  enum Type : std::uint16_t { kLeafNode = 1, kInnerNode = 2 };
+
+  /**
+   * @brief Visão tipada de uma página de nó.
+   */
+  struct Node {
+    char* bytes;
+
+    std::uint16_t type() const { return load<std::uint16_t>(4); }
+    void set_type(std::uint16_t t) { store(4, t); }
+    std::uint32_t size() const { return load<std::uint32_t>(8); }
+    void set_size(std::uint32_t n) { store(8, n); }
+    std::uint64_t next() const { return load<std::uint64_t>(16); }
+    void set_next(std::uint64_t p) { store(16, p); }
+
+    K* keys() const {
+      std::size_t offset = type() == kLeafNode ? kData : kData + 8 * (kInner + 1);
+      return reinterpret_cast<K*>(bytes + offset);
+    }
+    V* values() const {
+      std::size_t offset = kData + (kLeaf * sizeof(K) + 7) / 8 * 8;
+      return reinterpret_cast<V*>(bytes + offset);
+    }
+    std::uint64_t* children() const {
+      return reinterpret_cast<std::uint64_t*>(bytes + kData);
+    }
+
+    template <class U>
+    U load(std::size_t offset) const {
+      U value;
+      std::memcpy(&value, bytes + offset, sizeof(U));
+      return value;
+    }
+    template <class U>
+    void store(std::size_t offset, U value) {
+      std::memcpy(bytes + offset, &value, sizeof(U));
+    }
+  };
+
+  /**
+   * @brief Índice do filho de um nó interno que contém `key`.
+   */
+  static std::size_t child_index(const Node& node, const K& key) {
+    const K* keys = node.keys();
+    return static_cast<std::size_t>(
+        std::upper_bound(keys, keys + node.size(), key) - keys);
+  }
+
+  /**
+   * @brief Desce da raiz até a folha que contém `key`.
+   *
+   * @param path Se não nulo, recebe as páginas internas do caminho e o
+   * índice do filho seguido em cada uma.
+   */
+  PageRef find_leaf(const K& key,
+                    std::vector<std::pair<std::uint64_t, std::size_t>>* path) const;
+
+  V get(const K& key) const;
+
+  /**
+   * @brief Insere ou, se `overwrite`, substitui o valor de `key`.
+   *
+   * @return `true` se a chave foi inserida.
+   */
+  bool put(const K& key, const V& value, bool overwrite);
+
+  /**
+   * @brief Insere (separador, filho à direita) no pai, dividindo-o se
+   * necessário, subindo pelo caminho.
+   */
+  void insert_parent(std::vector<std::pair<std::uint64_t, std::size_t>>& path,
+                     K separator, std::uint64_t right);
+
+  void write_meta();
+
+  AsyncReader& async_reader() const {
+    if (!reader) reader.reset(new AsyncReader(pool.descriptor()));
+    return *reader;
+  }
+
+  mutable BufferPool pool;
+  mutable std::unique_ptr<AsyncReader> reader;  ///< Criado sob demanda.
+  std::uint64_t root = 0;   ///< Página da raiz.
+  std::uint64_t count = 0;  ///< Quantidade de pares.
+};
+
+template <class K, class V>
+DiskMap<K, V>::DiskMap(const std::string& path, std::size_t frames)
+    : pool(path, std::max<std::size_t>(frames, 8)) {
+  static const char kMagic[4] = {'E', 'D', 'B', 'T'};
+  if (pool.page_count() == 0) {
+    PageRef meta = pool.allocate();
+    PageRef leaf = pool.allocate();
+    Node node{leaf.data()};
+    node.set_type(kLeafNode);
+    root = leaf.page();
+    std::memcpy(meta.data() + 8, kMagic, sizeof(kMagic));
+    meta.mark_dirty();
+    leaf.mark_dirty();
+  } else {
+    PageRef meta = pool.fetch(0);
+    Node view{meta.data()};
+    if (std::memcmp(meta.data() + 8, kMagic, sizeof(kMagic)) != 0 ||
+        view.load<std::uint32_t>(12) != 1 ||
+        view.load<std::uint32_t>(16) != sizeof(K) ||
+        view.load<std::uint32_t>(20) != sizeof(V)) {
+      throw std::runtime_error("DiskMap: arquivo inválido ou de outros tipos");
+    }
+    root = view.load<std::uint64_t>(24);
+    count = view.load<std::uint64_t>(32);
+  }
+  write_meta();
+}
+
+template <class K, class V>
+DiskMap<K, V>::~DiskMap() {
+  try {
+    flush();
+  } catch (...) {
+    // O BufferPool ainda tenta gravar as páginas sujas ao ser destruído.
+  }
+}
+
+template <class K, class V>
+void DiskMap<K, V>::write_meta() {
+  PageRef meta = pool.fetch(0);
+  Node view{meta.data()};
+  view.store<std::uint32_t>(12, 1);
+  view.store<std::uint32_t>(16, sizeof(K));
+  view.store<std::uint32_t>(20, sizeof(V));
+  view.store<std::uint64_t>(24, root);
+  view.store<std::uint64_t>(32, count);
+  meta.mark_dirty();
+}
+
+template <class K, class V>
+void DiskMap<K, V>::flush() {
+  write_meta();
+  pool.flush();
+}
+
+template <class K, class V>
+PageRef DiskMap<K, V>::find_leaf(
+    const K& key,
+    std::vector<std::pair<std::uint64_t, std::size_t>>* path) const {
+  PageRef page = pool.fetch(root);
+  while (true) {
+    Node node{page.data()};
+    if (node.type() == kLeafNode) return page;
+    if (node.type() != kInnerNode) {
+      throw std::runtime_error("DiskMap: página de nó inválida");
+    }
+    std::size_t index = child_index(node, key);
+    if (path) path->emplace_back(page.page(), index);
+    std::uint64_t child = node.children()[index];
+    page = pool.fetch(child);
+  }
+}
+
+template <class K, class V>
+V DiskMap<K, V>::get(const K& key) const {
+  PageRef page = find_leaf(key, nullptr);
+  Node leaf{page.data()};
+  const K* keys = leaf.keys();
+  std::size_t i = static_cast<std::size_t>(
+      std::lower_bound(keys, keys + leaf.size(), key) - keys);
+  if (i == leaf.size() || key < keys[i]) {
+    throw std::out_of_range("chave não encontrada no DiskMap");
+  }
+  return leaf.values()[i];
+}
+
+template <class K, class V>
+bool DiskMap<K, V>::contains(const K& key) const {
+  PageRef page = find_leaf(key, nullptr);
+  Node leaf{page.data()};
+  const K* keys = leaf.keys();
+  const K* it = std::lower_bound(keys, keys + leaf.size(), key);
+  return it != keys + leaf.size() && !(key < *it);
+}
+
+template <class K, class V>
+typename DiskMap<K, V>::Reference DiskMap<K, V>::operator[](const K& key) {
+  put(key, V(), false);
+  return Reference(this, key);
+}
+
+template <class K, class V>
+bool DiskMap<K, V>::put(const K& key, const V& value, bool overwrite) {
+  std::vector<std::pair<std::uint64_t, std::size_t>> path;
+  PageRef page = find_leaf(key, &path);
+  Node leaf{page.data()};
+  K* keys = leaf.keys();
+  V* values = leaf.values();
+  std::size_t n = leaf.size();
+  std::size_t i = static_cast<std::size_t>(std::lower_bound(keys, keys + n, key) - keys);
+
+  if (i < n && !(key < keys[i])) {
+    if (overwrite) {
+      values[i] = value;
+      page.mark_dirty();
+    }
+    return false;
+  }
+
+  ++count;
+  page.mark_dirty();
+  if (n < kLeaf) {
+    std::memmove(keys + i + 1, keys + i, (n - i) * sizeof(K));
+    std::memmove(values + i + 1, values + i, (n - i) * sizeof(V));
+    keys[i] = key;
+    values[i] = value;
+    leaf.set_size(static_cast<std::uint32_t>(n + 1));
+    return true;
+  }
+
+  // Folha cheia: divide ao meio e insere na metade correta.
+  PageRef sibling_page = pool.allocate();
+  Node sibling{sibling_page.data()};
+  sibling.set_type(kLeafNode);
+  std::size_t left = (n + 1) / 2;
+  std::size_t moved = n - left;
+  std::memcpy(sibling.keys(), keys + left, moved * sizeof(K));
+  std::memcpy(sibling.values(), values + left, moved * sizeof(V));
+  sibling.set_size(static_cast<std::uint32_t>(moved));
+  sibling.set_next(leaf.next());
+  leaf.set_size(static_cast<std::uint32_t>(left));
+  leaf.set_next(sibling_page.page());
+
+  Node target = i <= left ? leaf : sibling;
+  std::size_t position = i <= left ? i : i - left;
+  std::size_t size = target.size();
+  K* target_keys = target.keys();
+  V* target_values = target.values();
+  std::memmove(target_keys + position + 1, target_keys + position,
+               (size - position) * sizeof(K));
+  std::memmove(target_values + position + 1, target_values + position,
+               (size - position) * sizeof(V));
+  target_keys[position] = key;
+  target_values[position] = value;
+  target.set_size(static_cast<std::uint32_t>(size + 1));
+
+  K separator = sibling.keys()[0];
+  std::uint64_t right = sibling_page.page();
+  page = PageRef();
+  sibling_page = PageRef();
+  insert_parent(path, separator, right);
+  return true;
+}
+
+template <class K, class V>
+void DiskMap<K, V>::insert_parent(
+    std::vector<std::pair<std::uint64_t, std::size_t>>& path, K separator,
+    std::uint64_t right) {
+  while (true) {
+    if (path.empty()) {
+      // A raiz foi dividida: a árvore cresce um nível.
+      PageRef page = pool.allocate();
+      Node node{page.data()};
+      node.set_type(kInnerNode);
+      node.set_size(1);
+      node.children()[0] = root;
+      node.children()[1] = right;
+      node.keys()[0] = separator;
+      root = page.page();
+      return;
+    }
+
+    auto [parent, index] = path.back();
+    path.pop_back();
+    PageRef page = pool.fetch(parent);
+    page.mark_dirty();
+    Node node{page.data()};
+    K* keys = node.keys();
+    std::uint64_t* children = node.children();
+    std::size_t n = node.size();
+
+    if (n < kInner) {
+      std::memmove(keys + index + 1, keys + index, (n - index) * sizeof(K));
+      std::memmove(children + index + 2, children + index + 1,
+                   (n - index) * sizeof(std::uint64_t));
+      keys[index] = separator;
+      children[index + 1] = right;
+      node.set_size(static_cast<std::uint32_t>(n + 1));
+      return;
+    }
+
+    // Nó interno cheio: monta a sequência completa e divide; a chave do meio
+    // sobe para o pai.
+    std::vector<K> all_keys(keys, keys + n);
+    std::vector<std::uint64_t> all_children(children, children + n + 1);
+    all_keys.insert(all_keys.begin() + static_cast<std::ptrdiff_t>(index), separator);
+    all_children.insert(all_children.begin() + static_cast<std::ptrdiff_t>(index) + 1,
+                        right);
+
+    std::size_t middle = all_keys.size() / 2;
+    PageRef sibling_page = pool.allocate();
+    Node sibling{sibling_page.data()};
+    sibling.set_type(kInnerNode);
+
+    std::copy(all_keys.begin(), all_keys.begin() + static_cast<std::ptrdiff_t>(middle),
+              keys);
+    std::copy(all_children.begin(),
+              all_children.begin() + static_cast<std::ptrdiff_t>(middle) + 1, children);
+    node.set_size(static_cast<std::uint32_t>(middle));
+
+    std::size_t rest = all_keys.size() - middle - 1;
+    std::copy(all_keys.begin() + static_cast<std::ptrdiff_t>(middle) + 1,
+              all_keys.end(), sibling.keys());
+    std::copy(all_children.begin() + static_cast<std::ptrdiff_t>(middle) + 1,
+              all_children.end(), sibling.children());
+    sibling.set_size(static_cast<std::uint32_t>(rest));
+
+    separator = all_keys[middle];
+    right = sibling_page.page();
+  }
+}
+
+template <class K, class V>
+bool DiskMap<K, V>::remove(const K& key) {
+  PageRef page = find_leaf(key, nullptr);
+  Node leaf{page.data()};
+  K* keys = leaf.keys();
+  V* values = leaf.values();
+  std::size_t n = leaf.size();
+  std::size_t i = static_cast<std::size_t>(std::lower_bound(keys, keys + n, key) - keys);
+  if (i == n || key < keys[i]) return false;
+
+  std::memmove(keys + i, keys + i + 1, (n - i - 1) * sizeof(K));
+  std::memmove(values + i, values + i + 1, (n - i - 1) * sizeof(V));
+  leaf.set_size(static_cast<std::uint32_t>(n - 1));
+  page.mark_dirty();
+  --count;
+  return true;
+}
+
+template <class K, class V>
+template <class F>
+void DiskMap<K, V>::for_each(F&& f) const {
+  PageRef page = pool.fetch(root);
+  while (Node{page.data()}.type() == kInnerNode) {
+    std::uint64_t child = Node{page.data()}.children()[0];
+    page = pool.fetch(child);
+  }
+  while (true) {
+    Node leaf{page.data()};
+    for (std::size_t i = 0; i < leaf.size(); ++i) {
+      K key = leaf.keys()[i];
+      V value = leaf.values()[i];
+      f(key, value);
+    }
+    std::uint64_t next = leaf.next();
+    if (next == 0) return;
+    page = pool.fetch(next);
+  }
+}
+
+template <class K, class V>
+std::size_t DiskMap<K, V>::find_many(const K* keys, std::size_t count, V* values,
+                                     bool* found) const {
+  constexpr std::size_t kPage = BufferPool::kPageSize;
+  AsyncReader& io = async_reader();
+  std::size_t depth = io.depth();
+
+  std::vector<std::uint64_t> at(count, root);  // Página atual de cada busca.
+  std::unordered_map<std::uint64_t, std::vector<std::size_t>> waiting;
+  std::vector<std::uint64_t> backlog;  // Páginas à espera de um buffer livre.
+  std::unique_ptr<char[]> buffers(new char[depth * kPage]);
+  std::vector<std::uint64_t> reading(depth);  // Página lida em cada buffer.
+  std::vector<std::size_t> free_buffers;
+  for (std::size_t b = depth; b > 0; --b) free_buffers.push_back(b - 1);
+  std::size_t hits = 0;
+
+  // Processa o nó da busca i: resolve na folha (true) ou passa ao filho.
+  auto visit = [&](std::size_t i, const Node& node) {
+    if (node.type() == kLeafNode) {
+      const K* first = node.keys();
+      const K* last = first + node.size();
+      const K* it = std::lower_bound(first, last, keys[i]);
+      bool hit = it != last && !(keys[i] < *it);
+      if (found) found[i] = hit;
+      if (hit && values) values[i] = node.values()[it - first];
+      hits += hit;
+      return true;
+    }
+    if (node.type() != kInnerNode) {
+      throw std::runtime_error("DiskMap: página de nó inválida");
+    }
+    at[i] = node.children()[child_index(node, keys[i])];
+    return false;
+  };
+
+  auto start = [&](std::uint64_t page) {
+    std::size_t b = free_buffers.back();
+    free_buffers.pop_back();
+    reading[b] = page;
+    io.submit(page * kPage, buffers.get() + b * kPage, kPage, b);
+  };
+
+  // Desce enquanto as páginas estão em memória; na primeira ausente, a busca
+  // entra na fila da página (que é lida uma única vez).
+  auto advance = [&](std::size_t i) {
+    while (true) {
+      PageRef page = pool.lookup(at[i]);
+      if (!page) {
+        std::vector<std::size_t>& list = waiting[at[i]];
+        list.push_back(i);
+        if (list.size() == 1) {
+          if (free_buffers.empty()) {
+            backlog.push_back(at[i]);
+          } else {
+            start(at[i]);
+          }
+        }
+        return;
+      }
+      if (visit(i, Node{page.data()})) return;
+    }
+  };
+
+  // Uma falha não pode interromper a função com leituras em voo: elas
+  // escrevem em `buffers`. Guarda o erro e só drena o que falta.
+  std::exception_ptr failure;
+  try {
+    for (std::size_t i = 0; i < count; ++i) advance(i);
+  } catch (...) {
+    failure = std::current_exception();
+  }
+
+  std::vector<AsyncReader::Completion> done;
+  std::vector<std::size_t> resumed;
+  while (io.in_flight() > 0) {
+    done.clear();
+    io.wait(done);
+    for (const AsyncReader::Completion& c : done) {
+      std::size_t b = static_cast<std::size_t>(c.tag);
+      std::uint64_t page = reading[b];
+      free_buffers.push_back(b);
+      if (failure) continue;
+      try {
+        if (c.error != 0) {
+          throw std::system_error(c.error, std::generic_category(),
+                                  "DiskMap: leitura da página " + std::to_string(page));
+        }
+        resumed.clear();
+        {
+          PageRef ref = pool.install(page, buffers.get() + b * kPage);
+          Node node{ref.data()};
+          for (std::size_t i : waiting[page]) {
+            if (!visit(i, node)) resumed.push_back(i);
+          }
+        }
+        waiting.erase(page);
+        if (!backlog.empty()) {
+          start(backlog.back());
+          backlog.pop_back();
+        }
+        for (std::size_t i : resumed) advance(i);
+      } catch (...) {
+        failure = std::current_exception();
+      }
+    }
+  }
+  if (failure) std::rethrow_exception(failure);
+  return hits;
+}
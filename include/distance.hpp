@@ -0,0 +1,22 @@
+#pragma once
+#include <type_traits>
+
+/**
+ * @brief Diz se `high` está mais perto de `value` do que `low`, com
+ * `low <= value <= high`; no empate, `false` (o menor vence).
+ *
+ * Para inteiros as distâncias são calculadas no tipo sem sinal
+ * correspondente: como `high - value` e `value - low` nunca passam de
+ * `max - min`, a aritmética modular dá o valor exato sem o overflow com sinal
+ * de, por exemplo, `0 - INT_MIN`. Os demais tipos usam a própria subtração.
+ */
+template <class T>
+bool closer_above(const T& low, const T& value, const T& high) {
+  if constexpr (std::is_integral<T>::value && !std::is_same<T, bool>::value) {
+    using U = std::make_unsigned_t<T>;
+    return static_cast<U>(static_cast<U>(high) - static_cast<U>(value)) <
+           static_cast<U>(static_cast<U>(value) - static_cast<U>(low));
+  } else {
+    return (high - value) < (value - low);
+  }
+}
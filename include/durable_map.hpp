@@ -0,0 +1,551 @@
+#pragma once
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "map.hpp"
+#include "serial.hpp"
+
+/**
+ * @brief Quando as escritas de um `DurableMap` chegam ao disco.
+ */
+enum class Durability {
+  kEveryOp,   ///< Cada operação só retorna depois do fsync do seu registro.
+  kBatch,     ///< fsync a cada `batch` operações ou em `sync()`.
+  kPeriodic,  ///< fsync por uma thread de fundo a cada `interval`.
+};
+
+/**
+ * @brief Configuração de um `DurableMap`.
+ */
+struct DurableOptions {
+  Durability durability = Durability::kEveryOp;
+  std::size_t batch = 64;                   ///< Registros por lote (kBatch).
+  std::chrono::milliseconds interval{10};   ///< Período do fsync (kPeriodic).
+  std::uint64_t checkpoint_bytes = 64u << 20;  ///< Log que dispara checkpoint.
+};
+
+/**
+ * @brief `Map` persistente com log de escrita antecipada (WAL) e checkpoints.
+ *
+ * Cada `assign` e `remove` gera um registro no arquivo `wal` do diretório:
+ * `[u32 tamanho][u32 crc32][u8 operação][chave][valor]`, com chave e valor
+ * codificados por `BinaryCodec`. Os registros são acumulados em memória e
+ * gravados com commit em grupo: a primeira thread que precisa de
+ * durabilidade grava e sincroniza tudo o que estiver pendente, enquanto as
+ * demais esperam pelo mesmo fsync.
+ *
+ * `checkpoint()` grava o mapa inteiro com `Map::save` em `checkpoint`
+ * (arquivo temporário + rename atômico) e esvazia o log; é chamado
+ * automaticamente quando o log passa de `checkpoint_bytes`. Na abertura, o
+ * último checkpoint é carregado e o final do log é reaplicado; um registro
+ * incompleto ou com CRC inválido (escrita interrompida) encerra a
+ * recuperação e é descartado.
+ *
+ * Em `kEveryOp`, uma operação só é aplicada ao mapa (e vista por `get`)
+ * depois do fsync do seu registro, na ordem do log. Nos modos `kBatch` e
+ * `kPeriodic` ela é aplicada e retorna antes de chegar ao disco: leituras
+ * veem escritas ainda não sincronizadas.
+ *
+ * Se a gravação de um lote falhar, o log é truncado de volta ao último
+ * fsync bem-sucedido, para que bytes parciais não fiquem entre registros já
+ * confirmados. Em `kEveryOp` o lote é descartado e todas as operações dele
+ * lançam o erro sem alterar o mapa; nos outros modos, em que as operações
+ * já retornaram, o lote volta ao buffer. Se o truncamento também falhar, ou
+ * se a falha for do fsync (o kernel pode já ter descartado as páginas), o
+ * mapa passa a um estado de falha permanente e toda escrita seguinte lança
+ * o erro original. No modo `kPeriodic`, o erro da thread de fundo é
+ * relançado pela próxima chamada de `assign`, `remove`, `sync` ou
+ * `checkpoint`.
+ *
+ * Todas as operações são serializadas por um mutex interno.
+ *
+ * @tparam K Tipo da chave (com `BinaryCodec`).
+ * @tparam V Tipo do valor (com `BinaryCodec`).
+ */
+template <class K, class V>
+class DurableMap {
+ public:
+  /**
+   * @brief Abre (ou cria) o mapa no diretório indicado e recupera seu estado.
+   *
+   * @param directory Diretório dos arquivos `checkpoint` e `wal`.
+   * @param options Modo de durabilidade e limites.
+   * @throw std::system_error em falhas de E/S.
+   * @throw std::runtime_error se o checkpoint for inválido.
+   */
+  explicit DurableMap(const std::string& directory,
+                      DurableOptions options = DurableOptions());
+
+  /**
+   * @brief Sincroniza os registros pendentes e fecha o log.
+   */
+  ~DurableMap();
+
+  DurableMap(const DurableMap&) = delete;
+  DurableMap& operator=(const DurableMap&) = delete;
+
+  /**
+   * @brief Associa `value` à chave `key`.
+   */
+  void assign(const K& key, const V& value);
+
+  /**
+   * @brief Remove a chave `key`.
+   *
+   * @return `true` se a chave existia.
+   */
+  bool remove(const K& key);
+
+  /**
+   * @brief Retorna uma cópia do valor associado à chave.
+   *
+   * @throw std::out_of_range se a chave não for encontrada.
+   */
+  V get(const K& key) const;
+
+  /**
+   * @brief Retorna a quantidade de pares.
+   */
+  std::size_t size() const;
+
+  /**
+   * @brief Garante que todas as operações já retornadas estão no disco.
+   */
+  void sync();
+
+  /**
+   * @brief Grava um checkpoint do mapa e esvazia o log.
+   */
+  void checkpoint();
+
+ private:
+  enum Operation : std::uint8_t { kAssign = 1, kRemove = 2 };
+
+  /**
+   * @brief Codifica um registro no buffer pendente.
+   */
+  void append(Operation operation, const K& key, const V* value);
+
+  /**
+   * @brief Commit em grupo: espera até que os registros até `target` estejam
+   * sincronizados, gravando o lote pendente se nenhuma outra thread estiver
+   * gravando.
+   */
+  void commit(std::unique_lock<std::mutex>& lock, std::uint64_t target);
+
+  /**
+   * @brief Conclui a operação do último registro gerado pelo modo de
+   * durabilidade: em `kEveryOp`, espera o fsync e chama `apply` na vez do
+   * registro; nos outros modos, chama `apply` de imediato.
+   */
+  template <class Apply>
+  void finish(std::unique_lock<std::mutex>& lock, Apply apply);
+
+  /**
+   * @brief Erro do lote descartado que continha o registro `sequence`, se
+   * houver.
+   */
+  std::exception_ptr dropped_error(std::uint64_t sequence) const;
+
+  /**
+   * @brief Relança a falha permanente ou o erro pendente da thread periódica.
+   */
+  void check();
+
+  void checkpoint(std::unique_lock<std::mutex>& lock);
+  void recover();
+  void periodic();
+
+  static void write_all(int fd, const std::string& bytes);
+  static void fsync_path(const std::string& path, bool directory);
+
+  std::string directory;
+  DurableOptions options;
+  Map<K, V> map;
+
+  mutable std::mutex mutex;
+  std::condition_variable flushed;  ///< Sinaliza o fim de cada lote.
+  std::string pending;              ///< Registros ainda não gravados.
+  std::uint64_t appended = 0;       ///< Registros gerados.
+  std::uint64_t durable = 0;        ///< Registros sincronizados ou descartados.
+  std::uint64_t applied = 0;        ///< Registros já resolvidos no mapa.
+  std::size_t unsynced = 0;         ///< Registros desde o último fsync.
+  bool flushing = false;            ///< Há uma thread gravando um lote.
+  std::uint64_t wal_bytes = 0;      ///< Tamanho atual do log.
+  int fd = -1;                      ///< Descritor do log.
+  std::exception_ptr failure;       ///< Falha permanente: rejeita escritas.
+  std::exception_ptr deferred;      ///< Erro da thread periódica a relançar.
+
+  /**
+   * @brief Registros (first, last] de um lote descartado em `kEveryOp`.
+   */
+  struct Dropped {
+    std::uint64_t first;
+    std::uint64_t last;
+    std::exception_ptr error;
+  };
+  std::vector<Dropped> dropped;  ///< Lotes descartados ainda não resolvidos.
+
+  bool stopping = false;
+  std::condition_variable wake;  ///< Acorda a thread periódica.
+  std::thread background;
+};
+
+template <class K, class V>
+DurableMap<K, V>::DurableMap(const std::string& dir, DurableOptions opts)
+    : directory(dir), options(opts) {
+  if (::mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+    throw std::system_error(errno, std::generic_category(), "mkdir " + directory);
+  }
+  recover();
+  if (options.durability == Durability::kPeriodic) {
+    try {
+      background = std::thread(&DurableMap::periodic, this);
+    } catch (...) {
+      ::close(fd);
+      throw;
+    }
+  }
+}
+
+template <class K, class V>
+DurableMap<K, V>::~DurableMap() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  if (background.joinable()) background.join();
+  try {
+    // Ignora o erro pendente da thread periódica para ainda tentar gravar.
+    std::unique_lock<std::mutex> lock(mutex);
+    commit(lock, appended);
+  } catch (...) {
+    // Destrutores não propagam; quem precisa do erro chama sync() antes.
+  }
+  ::close(fd);
+}
+
+template <class K, class V>
+void DurableMap<K, V>::write_all(int fd, const std::string& bytes) {
+  const char* data = bytes.data();
+  std::size_t left = bytes.size();
+  while (left > 0) {
+    ssize_t written = ::write(fd, data, left);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      throw std::system_error(errno, std::generic_category(), "write wal");
+    }
+    data += written;
+    left -= static_cast<std::size_t>(written);
+  }
+}
+
+template <class K, class V>
+void DurableMap<K, V>::fsync_path(const std::string& path, bool directory) {
+  int handle = ::open(path.c_str(), directory ? O_RDONLY | O_DIRECTORY : O_RDONLY);
+  if (handle < 0) {
+    throw std::system_error(errno, std::generic_category(), "open " + path);
+  }
+  int result = ::fsync(handle);
+  int error = errno;
+  ::close(handle);
+  if (result != 0) {
+    throw std::system_error(error, std::generic_category(), "fsync " + path);
+  }
+}
+
+template <class K, class V>
+void DurableMap<K, V>::recover() {
+  std::string snapshot = directory + "/checkpoint";
+  std::ifstream checkpoint_in(snapshot, std::ios::binary);
+  if (checkpoint_in) map.load(checkpoint_in);
+
+  std::string path = directory + "/wal";
+  std::string log;
+  {
+    std::ifstream in(path, std::ios::binary);
+    if (in) {
+      std::ostringstream contents;
+      contents << in.rdbuf();
+      log = contents.str();
+    }
+  }
+
+  // Reaplica os registros íntegros; o primeiro registro inválido marca o fim
+  // de uma escrita interrompida.
+  std::size_t offset = 0;
+  while (log.size() - offset >= 2 * sizeof(std::uint32_t)) {
+    std::uint32_t size = 0;
+    std::uint32_t crc = 0;
+    std::memcpy(&size, log.data() + offset, sizeof(size));
+    std::memcpy(&crc, log.data() + offset + sizeof(size), sizeof(crc));
+    std::size_t start = offset + 2 * sizeof(std::uint32_t);
+    if (size == 0 || log.size() - start < size ||
+        crc32(log.data() + start, size) != crc) {
+      break;
+    }
+
+    std::istringstream record(log.substr(start, size));
+    std::uint8_t operation = 0;
+    K key{};
+    record.read(reinterpret_cast<char*>(&operation), sizeof(operation));
+    BinaryCodec<K>::read(record, &key, 1);
+    if (operation == kAssign) {
+      V value{};
+      BinaryCodec<V>::read(record, &value, 1);
+      if (!record) break;
+      map[key] = value;
+    } else if (operation == kRemove && record) {
+      map.remove(key);
+    } else {
+      break;
+    }
+    offset = start + size;
+  }
+
+  fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "open " + path);
+  }
+  if (offset < log.size()) {
+    if (::ftruncate(fd, static_cast<off_t>(offset)) != 0 || ::fsync(fd) != 0) {
+      // O destrutor não roda se o construtor lançar.
+      int error = errno;
+      ::close(fd);
+      fd = -1;
+      throw std::system_error(error, std::generic_category(), "truncate " + path);
+    }
+  }
+  wal_bytes = offset;
+}
+
+template <class K, class V>
+void DurableMap<K, V>::append(Operation operation, const K& key, const V* value) {
+  std::ostringstream record;
+  record.put(static_cast<char>(operation));
+  BinaryCodec<K>::write(record, &key, 1);
+  if (value) BinaryCodec<V>::write(record, value, 1);
+  std::string payload = record.str();
+
+  std::uint32_t size = static_cast<std::uint32_t>(payload.size());
+  std::uint32_t crc = crc32(payload.data(), payload.size());
+  pending.append(reinterpret_cast<const char*>(&size), sizeof(size));
+  pending.append(reinterpret_cast<const char*>(&crc), sizeof(crc));
+  pending += payload;
+  ++appended;
+  ++unsynced;
+}
+
+template <class K, class V>
+void DurableMap<K, V>::commit(std::unique_lock<std::mutex>& lock,
+                              std::uint64_t target) {
+  while (durable < target) {
+    if (failure) std::rethrow_exception(failure);
+    if (flushing) {
+      flushed.wait(lock);
+      continue;
+    }
+    flushing = true;
+    std::string batch;
+    batch.swap(pending);
+    std::uint64_t upto = appended;
+    unsynced = 0;
+
+    lock.unlock();
+    bool written = false;
+    try {
+      write_all(fd, batch);
+      written = true;
+      if (::fdatasync(fd) != 0) {
+        throw std::system_error(errno, std::generic_category(), "fdatasync wal");
+      }
+    } catch (...) {
+      // Remove os bytes parciais do lote para que a nova tentativa não fique
+      // depois de um registro rasgado. Após uma falha de fsync, as páginas
+      // podem já ter sido descartadas e uma nova tentativa não é confiável.
+      bool truncated = ::ftruncate(fd, static_cast<off_t>(wal_bytes)) == 0;
+      lock.lock();
+      if (written || !truncated) failure = std::current_exception();
+      if (options.durability == Durability::kEveryOp) {
+        // Ninguém recebeu confirmação destes registros: descartá-los mantém
+        // o log e o mapa coerentes com as exceções lançadas.
+        dropped.push_back({durable, upto, std::current_exception()});
+        durable = upto;
+      } else {
+        pending.insert(0, batch);
+      }
+      flushing = false;
+      flushed.notify_all();
+      throw;
+    }
+    lock.lock();
+
+    flushing = false;
+    durable = upto;
+    wal_bytes += batch.size();
+    flushed.notify_all();
+  }
+}
+
+template <class K, class V>
+void DurableMap<K, V>::check() {
+  if (failure) std::rethrow_exception(failure);
+  if (deferred) {
+    std::exception_ptr error = deferred;
+    deferred = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+template <class K, class V>
+std::exception_ptr DurableMap<K, V>::dropped_error(std::uint64_t sequence) const {
+  for (const Dropped& batch : dropped) {
+    if (sequence > batch.first && sequence <= batch.last) return batch.error;
+  }
+  return nullptr;
+}
+
+template <class K, class V>
+template <class Apply>
+void DurableMap<K, V>::finish(std::unique_lock<std::mutex>& lock, Apply apply) {
+  std::uint64_t sequence = appended;
+  if (options.durability != Durability::kEveryOp) {
+    applied = sequence;
+    apply();
+    if (options.durability == Durability::kBatch && unsynced >= options.batch) {
+      commit(lock, appended);
+    }
+  } else {
+    std::exception_ptr error;
+    try {
+      commit(lock, sequence);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    if (!error) error = dropped_error(sequence);
+
+    // Com commit em grupo, as threads de um lote acordam em qualquer ordem;
+    // aplicar na ordem do log mantém o mapa igual ao que a recuperação vê.
+    while (applied + 1 < sequence) flushed.wait(lock);
+    applied = sequence;
+    while (!dropped.empty() && dropped.front().last <= applied) {
+      dropped.erase(dropped.begin());
+    }
+    flushed.notify_all();
+    if (error) std::rethrow_exception(error);
+    apply();
+  }
+  if (wal_bytes >= options.checkpoint_bytes) checkpoint(lock);
+}
+
+template <class K, class V>
+void DurableMap<K, V>::assign(const K& key, const V& value) {
+  std::unique_lock<std::mutex> lock(mutex);
+  check();
+  append(kAssign, key, &value);
+  finish(lock, [&] { map[key] = value; });
+}
+
+template <class K, class V>
+bool DurableMap<K, V>::remove(const K& key) {
+  std::unique_lock<std::mutex> lock(mutex);
+  check();
+  bool found = false;
+  map.contains_many(&key, 1, &found);
+  if (!found) return false;
+  append(kRemove, key, nullptr);
+  finish(lock, [&] { map.remove(key); });
+  return true;
+}
+
+template <class K, class V>
+V DurableMap<K, V>::get(const K& key) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  const Map<K, V>& view = map;
+  return view[key];
+}
+
+template <class K, class V>
+std::size_t DurableMap<K, V>::size() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return map.size();
+}
+
+template <class K, class V>
+void DurableMap<K, V>::sync() {
+  std::unique_lock<std::mutex> lock(mutex);
+  check();
+  commit(lock, appended);
+}
+
+template <class K, class V>
+void DurableMap<K, V>::checkpoint() {
+  std::unique_lock<std::mutex> lock(mutex);
+  check();
+  checkpoint(lock);
+}
+
+template <class K, class V>
+void DurableMap<K, V>::checkpoint(std::unique_lock<std::mutex>& lock) {
+  commit(lock, appended);
+  // O checkpoint substitui o log: todo registro sincronizado precisa já estar
+  // no mapa.
+  while (flushing || applied < durable) flushed.wait(lock);
+
+  std::string path = directory + "/checkpoint";
+  std::string temporary = path + ".tmp";
+  {
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    map.save(out);
+    out.close();
+    if (!out) throw std::runtime_error("falha ao gravar " + temporary);
+  }
+  fsync_path(temporary, false);
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    throw std::system_error(errno, std::generic_category(), "rename " + path);
+  }
+  fsync_path(directory, true);
+
+  // Reaplicar o log antigo sobre o checkpoint novo é inofensivo, então uma
+  // queda entre o rename e o truncamento não perde nem duplica estado.
+  if (::ftruncate(fd, 0) != 0 || ::fsync(fd) != 0) {
+    throw std::system_error(errno, std::generic_category(), "truncate wal");
+  }
+  wal_bytes = 0;
+}
+
+template <class K, class V>
+void DurableMap<K, V>::periodic() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!stopping && !failure) {
+    wake.wait_for(lock, options.interval);
+    if (durable < appended && !deferred) {
+      try {
+        commit(lock, appended);
+      } catch (...) {
+        // Os registros voltam ao buffer; a próxima escrita relança o erro e,
+        // até lá, não há novas tentativas.
+        deferred = std::current_exception();
+      }
+    }
+  }
+}
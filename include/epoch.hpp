@@ -0,0 +1,390 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Domínio de recuperação de memória baseado em épocas (EBR).
+ *
+ * Permite que leitores sem trava percorram estruturas compartilhadas enquanto
+ * escritores removem nós: em vez de `delete` imediato, o escritor "aposenta"
+ * (`retire`) o nó, e ele só é liberado quando nenhuma thread que poderia
+ * enxergá-lo continua fixada (`pin`) numa época antiga. O domínio só cuida
+ * da liberação: a estrutura ainda precisa alterar suas ligações de forma
+ * segura para esses leitores, como faz a `RcuAVL`. Em `BST` e `AVL`
+ * (`set_reclaimer`) ele apenas adia a liberação dos nós removidos.
+ *
+ * Funcionamento:
+ * - Cada thread participante possui um registro com a época em que está
+ *   fixada (0 quando quiescente) e uma lista local de nós aposentados.
+ * - A época global só avança quando todas as threads fixadas já observaram a
+ *   época atual.
+ * - Um nó aposentado na época `e` pode ser liberado quando a época global
+ *   chega a `e + 2`.
+ *
+ * O registro da thread é feito automaticamente no primeiro `pin`/`retire`
+ * (ou explicitamente com `register_thread`) e desfeito em `unregister_thread`
+ * ou no término da thread. A coleta é amortizada: a cada `threshold`
+ * aposentadorias numa thread, o domínio tenta avançar a época e liberar a
+ * lista local.
+ *
+ * O domínio deve ser destruído apenas quando nenhuma outra thread o estiver
+ * usando; o destrutor libera todos os nós ainda pendentes.
+ */
+class EpochDomain {
+ private:
+  /**
+   * @brief Nó aposentado aguardando liberação.
+   */
+  struct Retired {
+    void* ptr;                   ///< Objeto a ser liberado.
+    void (*deleter)(void*);      ///< Função que libera o objeto.
+    std::uint64_t epoch;         ///< Época global no momento da aposentadoria.
+  };
+
+  /**
+   * @brief Registro de uma thread participante.
+   */
+  struct Record {
+    std::atomic<std::uint64_t> epoch{0};  ///< Época fixada, 0 se quiescente.
+    std::atomic<bool> in_use{false};      ///< Registro pertence a uma thread.
+    unsigned nesting = 0;                 ///< Profundidade de `pin` aninhados.
+    std::size_t retires = 0;  ///< Aposentadorias desde a última coleta.
+    std::vector<Retired> limbo;  ///< Lista local de nós aposentados.
+  };
+
+  /**
+   * @brief Estado compartilhado entre o domínio e os caches das threads.
+   *
+   * Fica num `shared_ptr` para que o cache `thread_local` detecte, via
+   * `weak_ptr`, quando o domínio já foi destruído.
+   */
+  struct Registry {
+    std::atomic<std::uint64_t> global{1};  ///< Época global (começa em 1).
+    std::mutex mutex;  ///< Protege `records` e `orphans`.
+    std::vector<std::unique_ptr<Record>> records;  ///< Registros criados.
+    std::vector<Retired> orphans;  ///< Pendências de threads que saíram.
+    std::size_t threshold;         ///< Aposentadorias por coleta amortizada.
+  };
+
+  /**
+   * @brief Entrada do cache por thread que associa um domínio ao registro.
+   */
+  struct CacheEntry {
+    std::weak_ptr<Registry> registry;
+    Record* record;
+  };
+
+  /**
+   * @brief Cache por thread; devolve os registros quando a thread termina.
+   */
+  struct ThreadCache {
+    std::vector<CacheEntry> entries;
+
+    ~ThreadCache() {
+      for (CacheEntry& entry : entries) {
+        if (auto registry = entry.registry.lock()) {
+          release(*registry, *entry.record);
+        }
+      }
+    }
+  };
+
+  static ThreadCache& cache() {
+    thread_local ThreadCache instance;
+    return instance;
+  }
+
+  /**
+   * @brief Retorna o registro da thread atual, criando-o se necessário.
+   */
+  Record& local() const;
+
+  /**
+   * @brief Devolve o registro ao domínio e move suas pendências para os
+   * órfãos.
+   */
+  static void release(Registry& registry, Record& record);
+
+  /**
+   * @brief Tenta avançar a época global.
+   *
+   * @return `true` se a época avançou.
+   */
+  static bool try_advance(Registry& registry);
+
+  /**
+   * @brief Libera os itens de `list` cuja época permite a liberação.
+   *
+   * @return Quantidade de itens liberados.
+   */
+  static std::size_t reclaim(std::vector<Retired>& list, std::uint64_t global);
+
+  void unpin(Record& record) const;
+
+ public:
+  /**
+   * @brief Fixação RAII da thread atual na época corrente.
+   *
+   * Enquanto existir, nenhum nó aposentado depois do início da fixação é
+   * liberado. Fixações podem ser aninhadas.
+   */
+  class Guard {
+   public:
+    Guard(Guard&& other) noexcept
+        : domain(other.domain), record(other.record) {
+      other.record = nullptr;
+    }
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+    Guard& operator=(Guard&&) = delete;
+    ~Guard() {
+      if (record) domain->unpin(*record);
+    }
+
+   private:
+    friend class EpochDomain;
+    Guard(const EpochDomain* d, Record* r) : domain(d), record(r) {}
+
+    const EpochDomain* domain;
+    Record* record;
+  };
+
+  /**
+   * @brief Cria um domínio vazio.
+   *
+   * @param threshold Quantidade de aposentadorias por thread entre tentativas
+   * de coleta amortizada.
+   */
+  explicit EpochDomain(std::size_t threshold = 64);
+
+  /**
+   * @brief Libera todos os nós pendentes.
+   */
+  ~EpochDomain();
+
+  EpochDomain(const EpochDomain&) = delete;
+  EpochDomain& operator=(const EpochDomain&) = delete;
+
+  /**
+   * @brief Registra explicitamente a thread atual no domínio.
+   */
+  void register_thread() const { local(); }
+
+  /**
+   * @brief Remove o registro da thread atual, repassando suas pendências.
+   *
+   * Não pode ser chamado com uma fixação ativa.
+   */
+  void unregister_thread() const;
+
+  /**
+   * @brief Fixa a thread atual na época global corrente.
+   *
+   * @return Guarda que desfaz a fixação ao ser destruída.
+   */
+  Guard pin() const;
+
+  /**
+   * @brief Aposenta um objeto, liberando-o com `deleter` quando seguro.
+   *
+   * @param ptr Objeto já inacessível para novos leitores.
+   * @param deleter Função que libera `ptr`.
+   */
+  void retire(void* ptr, void (*deleter)(void*)) const;
+
+  /**
+   * @brief Reserva espaço na lista local para mais `count` aposentadorias.
+   *
+   * Depois da reserva, as próximas `count` chamadas de `retire` na thread
+   * atual não alocam memória e, portanto, não lançam exceções.
+   */
+  void reserve(std::size_t count) const;
+
+  /**
+   * @brief Aposenta um objeto alocado com `new`.
+   *
+   * @tparam U Tipo do objeto.
+   * @param ptr Objeto já inacessível para novos leitores.
+   */
+  template <class U>
+  void retire(U* ptr) const {
+    retire(static_cast<void*>(ptr),
+           [](void* p) { delete static_cast<U*>(p); });
+  }
+
+  /**
+   * @brief Tenta avançar a época e libera as pendências da thread atual e
+   * das threads que já saíram.
+   *
+   * @return Quantidade de objetos liberados.
+   */
+  std::size_t collect() const;
+
+  /**
+   * @brief Retorna a época global atual.
+   */
+  std::uint64_t epoch() const { return registry->global.load(); }
+
+  /**
+   * @brief Retorna o número de objetos aposentados ainda não liberados.
+   *
+   * Percorre todos os registros sem sincronizar as listas locais; use apenas
+   * com as demais threads paradas (testes e diagnóstico).
+   */
+  std::size_t pending() const;
+
+ private:
+  std::shared_ptr<Registry> registry;  ///< Estado compartilhado do domínio.
+};
+
+inline EpochDomain::EpochDomain(std::size_t threshold)
+    : registry(std::make_shared<Registry>()) {
+  registry->threshold = threshold == 0 ? 1 : threshold;
+}
+
+inline EpochDomain::~EpochDomain() {
+  std::lock_guard<std::mutex> lock(registry->mutex);
+  for (auto& record : registry->records) {
+    for (Retired& item : record->limbo) item.deleter(item.ptr);
+    record->limbo.clear();
+  }
+  for (Retired& item : registry->orphans) item.deleter(item.ptr);
+  registry->orphans.clear();
+}
+
+inline EpochDomain::Record& EpochDomain::local() const {
+  ThreadCache& tc = cache();
+  for (std::size_t i = 0; i < tc.entries.size();) {
+    CacheEntry& entry = tc.entries[i];
+    if (entry.registry.expired()) {
+      entry = tc.entries.back();
+      tc.entries.pop_back();
+      continue;
+    }
+    if (!entry.registry.owner_before(registry) &&
+        !registry.owner_before(entry.registry)) {
+      return *entry.record;
+    }
+    ++i;
+  }
+
+  Record* record = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(registry->mutex);
+    for (auto& candidate : registry->records) {
+      if (!candidate->in_use.load()) {
+        record = candidate.get();
+        break;
+      }
+    }
+    if (!record) {
+      registry->records.push_back(std::make_unique<Record>());
+      record = registry->records.back().get();
+    }
+    record->in_use.store(true);
+  }
+  tc.entries.push_back({registry, record});
+  return *record;
+}
+
+inline void EpochDomain::release(Registry& registry, Record& record) {
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  record.epoch.store(0);
+  record.nesting = 0;
+  record.retires = 0;
+  registry.orphans.insert(registry.orphans.end(), record.limbo.begin(),
+                          record.limbo.end());
+  record.limbo.clear();
+  record.in_use.store(false);
+}
+
+inline void EpochDomain::unregister_thread() const {
+  ThreadCache& tc = cache();
+  for (std::size_t i = 0; i < tc.entries.size(); ++i) {
+    CacheEntry& entry = tc.entries[i];
+    if (!entry.registry.owner_before(registry) &&
+        !registry.owner_before(entry.registry)) {
+      release(*registry, *entry.record);
+      entry = tc.entries.back();
+      tc.entries.pop_back();
+      return;
+    }
+  }
+}
+
+inline EpochDomain::Guard EpochDomain::pin() const {
+  Record& record = local();
+  if (record.nesting++ == 0) {
+    // O store seq_cst ordena a fixação antes de qualquer leitura da estrutura.
+    record.epoch.store(registry->global.load());
+  }
+  return Guard(this, &record);
+}
+
+inline void EpochDomain::unpin(Record& record) const {
+  if (--record.nesting == 0) {
+    record.epoch.store(0, std::memory_order_release);
+  }
+}
+
+inline bool EpochDomain::try_advance(Registry& registry) {
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::uint64_t current = registry.global.load();
+  for (auto& record : registry.records) {
+    if (!record->in_use.load()) continue;
+    std::uint64_t e = record->epoch.load();
+    if (e != 0 && e != current) return false;
+  }
+  return registry.global.compare_exchange_strong(current, current + 1);
+}
+
+inline std::size_t EpochDomain::reclaim(std::vector<Retired>& list,
+                                        std::uint64_t global) {
+  std::size_t kept = 0;
+  std::size_t freed = 0;
+  for (std::size_t i = 0; i < list.size(); ++i) {
+    if (list[i].epoch + 2 <= global) {
+      list[i].deleter(list[i].ptr);
+      ++freed;
+    } else {
+      list[kept++] = list[i];
+    }
+  }
+  list.resize(kept);
+  return freed;
+}
+
+inline void EpochDomain::retire(void* ptr, void (*deleter)(void*)) const {
+  Record& record = local();
+  record.limbo.push_back({ptr, deleter, registry->global.load()});
+  if (++record.retires >= registry->threshold) {
+    record.retires = 0;
+    try_advance(*registry);
+    reclaim(record.limbo, registry->global.load());
+  }
+}
+
+inline void EpochDomain::reserve(std::size_t count) const {
+  Record& record = local();
+  record.limbo.reserve(record.limbo.size() + count);
+}
+
+inline std::size_t EpochDomain::collect() const {
+  Record& record = local();
+  try_advance(*registry);
+  std::uint64_t global = registry->global.load();
+  std::size_t freed = reclaim(record.limbo, global);
+  std::lock_guard<std::mutex> lock(registry->mutex);
+  return freed + reclaim(registry->orphans, global);
+}
+
+inline std::size_t EpochDomain::pending() const {
+  std::lock_guard<std::mutex> lock(registry->mutex);
+  std::size_t total = registry->orphans.size();
+  for (auto& record : registry->records) total += record->limbo.size();
+  return total;
+}
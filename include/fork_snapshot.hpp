@@ -0,0 +1,242 @@
+#pragma once
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "map.hpp"
+#include "serial.hpp"
+
+/**
+ * @brief Snapshot gravado em segundo plano por um processo filho (`fork`).
+ *
+ * O filho recebe, via cópia-na-escrita do kernel, a imagem da memória no
+ * instante do `fork` e serializa a estrutura a partir dela, enquanto o
+ * processo pai continua alterando a sua cópia sem qualquer pausa além do
+ * próprio `fork` (cópia das tabelas de páginas). Páginas tocadas pelo pai
+ * durante o snapshot são duplicadas pelo kernel, então a memória extra é
+ * proporcional às escritas do período, não ao tamanho da estrutura.
+ *
+ * O progresso (bytes gravados) é publicado pelo filho numa página anônima
+ * compartilhada. O arquivo é gravado em `path.tmp`, sincronizado e renomeado
+ * para `path` apenas se tudo der certo.
+ *
+ * `start` deve ser chamado pela thread que altera a estrutura, entre duas
+ * operações: o `fork` copia apenas a thread chamadora, e a estrutura não
+ * pode estar no meio de uma alteração nesse instante.
+ */
+class BackgroundSnapshot {
+ public:
+  /**
+   * @brief Progresso publicado pelo filho.
+   */
+  struct Progress {
+    std::uint64_t bytes;     ///< Bytes gravados até agora.
+    std::uint64_t expected;  ///< Total previsto, ou 0 se desconhecido.
+  };
+
+  /**
+   * @brief Cria o processo filho que grava `path` chamando `write(out)`.
+   *
+   * @param path Arquivo de destino.
+   * @param expected Total de bytes previsto (0 se desconhecido).
+   * @param write Função chamada no filho como `write(std::ostream&)`.
+   * @throw std::system_error se o `fork` falhar.
+   */
+  template <class Writer>
+  static BackgroundSnapshot start(const std::string& path,
+                                  std::uint64_t expected, Writer&& write);
+
+  BackgroundSnapshot(BackgroundSnapshot&& other) noexcept
+      : pid(other.pid), shared(other.shared), status(other.status) {
+    other.pid = -1;
+    other.shared = nullptr;
+  }
+
+  BackgroundSnapshot& operator=(BackgroundSnapshot&& other) noexcept {
+    std::swap(pid, other.pid);
+    std::swap(shared, other.shared);
+    std::swap(status, other.status);
+    return *this;
+  }
+
+  BackgroundSnapshot(const BackgroundSnapshot&) = delete;
+  BackgroundSnapshot& operator=(const BackgroundSnapshot&) = delete;
+
+  /**
+   * @brief Espera o filho, se ainda estiver rodando, e libera a página
+   * compartilhada.
+   */
+  ~BackgroundSnapshot() {
+    if (pid > 0) {
+      int ignored;
+      while (::waitpid(pid, &ignored, 0) < 0 && errno == EINTR) {
+      }
+    }
+    if (shared) ::munmap(shared, sizeof(Shared));
+  }
+
+  /**
+   * @brief Progresso atual do filho.
+   */
+  Progress progress() const {
+    return {shared->bytes.load(std::memory_order_relaxed), shared->expected};
+  }
+
+  /**
+   * @brief Verifica, sem bloquear, se o filho terminou.
+   */
+  bool done() {
+    if (pid <= 0) return true;
+    pid_t result = ::waitpid(pid, &status, WNOHANG);
+    if (result == pid) pid = -1;
+    return pid <= 0;
+  }
+
+  /**
+   * @brief Espera o filho terminar.
+   *
+   * @throw std::runtime_error se o filho não gravou o snapshot.
+   */
+  void wait() {
+    while (pid > 0) {
+      pid_t result = ::waitpid(pid, &status, 0);
+      if (result == pid) pid = -1;
+      if (result < 0 && errno != EINTR) {
+        throw std::system_error(errno, std::generic_category(), "waitpid");
+      }
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      throw std::runtime_error("snapshot em segundo plano falhou");
+    }
+  }
+
+ private:
+  struct Shared {
+    std::atomic<std::uint64_t> bytes;
+    std::uint64_t expected;
+  };
+
+  /**
+   * @brief `streambuf` do filho que repassa a escrita e conta os bytes.
+   */
+  class CountingBuffer : public std::streambuf {
+   public:
+    CountingBuffer(std::streambuf* target, std::atomic<std::uint64_t>& counter)
+        : target(target), counter(counter) {}
+
+   protected:
+    std::streamsize xsputn(const char* data, std::streamsize n) override {
+      std::streamsize written = target->sputn(data, n);
+      counter.fetch_add(static_cast<std::uint64_t>(written),
+                        std::memory_order_relaxed);
+      return written;
+    }
+
+    int_type overflow(int_type c) override {
+      if (traits_type::eq_int_type(c, traits_type::eof())) return 0;
+      char byte = traits_type::to_char_type(c);
+      return xsputn(&byte, 1) == 1 ? c : traits_type::eof();
+    }
+
+    int sync() override { return target->pubsync(); }
+
+   private:
+    std::streambuf* target;
+    std::atomic<std::uint64_t>& counter;
+  };
+
+  BackgroundSnapshot(pid_t pid, Shared* shared)
+      : pid(pid), shared(shared), status(0) {}
+
+  pid_t pid;       ///< Filho ainda não colhido, ou -1.
+  Shared* shared;  ///< Página compartilhada com o filho.
+  int status;      ///< Status de saída do filho.
+};
+
+template <class Writer>
+BackgroundSnapshot BackgroundSnapshot::start(const std::string& path,
+                                             std::uint64_t expected,
+                                             Writer&& write) {
+  void* page = ::mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (page == MAP_FAILED) {
+    throw std::system_error(errno, std::generic_category(), "mmap");
+  }
+  Shared* shared = new (page) Shared{{0}, expected};
+
+  pid_t pid = ::fork();
+  if (pid < 0) {
+    int error = errno;
+    ::munmap(page, sizeof(Shared));
+    throw std::system_error(error, std::generic_category(), "fork");
+  }
+  if (pid > 0) return BackgroundSnapshot(pid, shared);
+
+  // Filho: grava, sincroniza, renomeia e sincroniza o diretório (para que o
+  // rename sobreviva a uma queda); sai com _exit para não executar
+  // destrutores e handlers atexit herdados do pai.
+  int code = 1;
+  try {
+    std::string temporary = path + ".tmp";
+    {
+      std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+      CountingBuffer buffer(file.rdbuf(), shared->bytes);
+      std::ostream out(&buffer);
+      write(out);
+      out.flush();
+      file.close();
+      if (!out || !file) throw std::runtime_error("falha ao gravar");
+    }
+    int fd = ::open(temporary.c_str(), O_RDONLY);
+    bool renamed = fd >= 0 && ::fsync(fd) == 0 &&
+                   std::rename(temporary.c_str(), path.c_str()) == 0;
+    if (fd >= 0) ::close(fd);
+    if (renamed) {
+      std::string::size_type slash = path.find_last_of('/');
+      std::string directory =
+          slash == std::string::npos ? "." : path.substr(0, slash + 1);
+      int dir = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+      if (dir >= 0 && ::fsync(dir) == 0) code = 0;
+      if (dir >= 0) ::close(dir);
+    }
+  } catch (...) {
+  }
+  ::_exit(code);
+}
+
+/**
+ * @brief Grava `map` (formato de `Map::save`) em segundo plano.
+ *
+ * O mapa pode continuar sendo alterado pelo chamador assim que a função
+ * retorna; o snapshot reflete o estado do instante da chamada.
+ *
+ * @param map Mapa de origem.
+ * @param path Arquivo de destino.
+ * @return Handle para acompanhar e esperar o snapshot.
+ */
+template <class K, class V, class A>
+BackgroundSnapshot save_in_background(const Map<K, V, A>& map,
+                                      const std::string& path) {
+  std::uint64_t expected = 0;
+  if (BinaryCodec<K>::raw && BinaryCodec<V>::raw) {
+    expected = SnapshotHeader::encoded_size() +
+               static_cast<std::uint64_t>(map.size()) * (sizeof(K) + sizeof(V));
+  }
+  return BackgroundSnapshot::start(
+      path, expected, [&map](std::ostream& out) { map.save(out); });
+}
@@ -1,17 +1,28 @@
 #pragma once
-#include "bst.hpp"
+#include "avl.hpp"
+#include "distance.hpp"
+#include "serial.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <istream>
+#include <ostream>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 /**
  * @brief Classe que representa um Mapa Associativo (Map).
  *
  * Armazena pares chave-valor, onde cada chave é única. A ordenação e
- * busca são garantidas pelo uso de uma Árvore Binária.
+ * busca são garantidas pelo uso de uma Árvore AVL.
  *
  * @tparam K Tipo da chave. Deve suportar o operadores de comparação '<'.
  * @tparam V Tipo do valor associado à chave.
+ * @tparam Augment Agregado sobre os pares, com `measure(const K&, const V&)`
+ * (ver `augment.hpp`), consultado por `aggregate`; `void` para nenhum.
  */
-template <class K, class V>
+template <class K, class V, class Augment = void>
 class Map {
  private:
   /**
@@ -45,13 +56,73 @@ class Map {
     }
   };
 
+  /**
+   * @brief Adapta `Augment` aos pares guardados na árvore.
+   */
+  template <class A>
+  struct PairMeasure {
+    using value_type = typename A::value_type;
+    static value_type identity() { return A::identity(); }
+    static value_type combine(const value_type& a, const value_type& b) {
+      return A::combine(a, b);
+    }
+    static value_type measure(const Pair& pair) { return A::measure(pair.key, pair.value); }
+  };
+
+  using Tree = AVL<Pair, std::conditional_t<std::is_void<Augment>::value, void,
+                                            PairMeasure<Augment>>>;
+
  public:
+  /**
+   * @brief Referência a um valor, devolvida por `operator[]` quando há
+   * `Augment`.
+   *
+   * Um `V&` deixaria o chamador alterar o valor sem que os agregados da
+   * árvore soubessem; por isso a atribuição passa por `AVL::modify`, que os
+   * recalcula no mesmo momento. A referência guarda a chave, não o nó, e
+   * continua válida depois de outras inserções e remoções (se a chave for
+   * removida, a leitura lança `std::out_of_range` e a atribuição a reinsere).
+   */
+  class Reference {
+   public:
+    operator const V&() const { return static_cast<const Map&>(*map)[key]; }
+
+    Reference& operator=(const V& value) {
+      map->store(key, value);
+      return *this;
+    }
+
+    Reference& operator=(const Reference& other) {
+      return *this = static_cast<const V&>(other);
+    }
+
+   private:
+    friend class Map;
+    Reference(Map* m, const K& k) : map(m), key(k) {}
+
+    Map* map;
+    K key;
+  };
+
+  /// Retorno de `operator[]`: `V&` sem agregado, `Reference` com agregado.
+  using ValueRef = std::conditional_t<std::is_void<Augment>::value, V&, Reference>;
+
   /**
    * @brief Construtor padrão.
    * Cria um mapa vazio.
    */
   Map();
 
+  /**
+   * @brief Troca o conteúdo com outro mapa em O(1).
+   *
+   * Cópia e movimento são delegados à árvore: a cópia é profunda e o
+   * movimento custa O(1).
+   *
+   * @param other Mapa com o qual o conteúdo será trocado.
+   */
+  void swap(Map& other) noexcept;
+
   /**
    * @brief Acessa o valor associado a uma chave.
    *
@@ -59,10 +130,13 @@ class Map {
    * O valor para a nova chave será inicializado usando o construtor padrão de
    * `V`.
    *
+   * Com `Augment`, devolve uma `Reference`, pela qual as atribuições
+   * mantêm os agregados atualizados.
+   *
    * @param key A chave para buscar ou inserir.
    * @return Uma referência ao valor associado à chave.
    */
-  V& operator[](const K& key);
+  ValueRef operator[](const K& key);
 
   /**
    * @brief Acessa o valor associado a uma chave (versão constante).
@@ -75,6 +149,34 @@ class Map {
    */
   const V& operator[](const K& key) const;
 
+  /**
+   * @brief Par encontrado por uma consulta por ordem: ponteiros para a chave e
+   * o valor guardados, ou ambos `nullptr` se não houver.
+   *
+   * Os ponteiros valem até a próxima alteração do mapa.
+   */
+  using Entry = std::pair<const K*, const V*>;
+
+  /**
+   * @name Consultas por ordem
+   *
+   * Em O(log n), sem copiar chaves nem valores (ver `AVL::lower_bound`).
+   * @{
+   */
+  Entry lower_bound(const K& key) const;  ///< Menor chave >= `key`.
+  Entry upper_bound(const K& key) const;  ///< Menor chave > `key`.
+  Entry ceiling(const K& key) const;      ///< Igual a `lower_bound`.
+  Entry floor(const K& key) const;        ///< Maior chave <= `key`.
+  Entry successor(const K& key) const;    ///< Igual a `upper_bound`.
+  Entry predecessor(const K& key) const;  ///< Maior chave < `key`.
+
+  /**
+   * @brief Chave mais próxima de `key`; no empate, a menor. Exige subtração
+   * em `K`.
+   */
+  Entry nearest(const K& key) const;
+  /** @} */
+
   /**
    * @brief Remove um par chave-valor do mapa.
    *
@@ -86,35 +188,333 @@ class Map {
    */
   bool remove(const K& key);
 
+  /**
+   * @brief Remove todos os pares com chave no intervalo [lo, hi).
+   *
+   * Divide a árvore nas duas chaves em vez de remover par a par, em O(log n)
+   * mais a liberação dos pares removidos (ver `AVL::erase_range`).
+   *
+   * @param lo Primeira chave do intervalo (incluída).
+   * @param hi Fim do intervalo (excluído).
+   * @return Quantidade de pares removidos.
+   */
+  std::size_t erase_range(const K& lo, const K& hi);
+
+  /**
+   * @brief Move os pares com chave no intervalo [lo, hi) para um novo mapa,
+   * sem copiá-los.
+   *
+   * @param lo Primeira chave do intervalo (incluída).
+   * @param hi Fim do intervalo (excluído).
+   * @return Mapa com os pares removidos.
+   */
+  Map extract_range(const K& lo, const K& hi);
+
+  /// Tipo do agregado (`void` sem `Augment`).
+  using Summary = typename Tree::Summary;
+
+  /**
+   * @brief Agregado dos pares com chave em [lo, hi), em O(log n).
+   *
+   * Por exemplo, com `Map<timestamp, bytes, SumOf<bytes>>`, o total de bytes
+   * entre dois instantes.
+   *
+   * @param lo Primeira chave do intervalo (incluída).
+   * @param hi Fim do intervalo (excluído).
+   * @return O agregado, ou `Augment::identity()` se não houver pares.
+   */
+  Summary aggregate(const K& lo, const K& hi) const;
+
+  /**
+   * @brief Agregado de todos os pares.
+   */
+  Summary aggregate() const;
+
+  /**
+   * @brief Busca várias chaves de uma vez.
+   *
+   * As descidas avançam intercaladas em grupos, com prefetch do próximo nó
+   * de cada uma, sobrepondo as faltas de cache (ver `AVL::find_many`).
+   *
+   * @param keys Chaves buscadas.
+   * @param n Quantidade de chaves.
+   * @param values Recebe, para cada chave, um ponteiro para o valor ou
+   * `nullptr` se ela não existir.
+   * @return Quantidade de chaves encontradas.
+   */
+  std::size_t find_many(const K* keys, std::size_t n, const V** values) const;
+
+  /**
+   * @brief Verifica a presença de várias chaves (ver `find_many`).
+   *
+   * @param keys Chaves buscadas.
+   * @param n Quantidade de chaves.
+   * @param found Recebe, para cada chave, se ela está presente.
+   * @return Quantidade de chaves encontradas.
+   */
+  std::size_t contains_many(const K* keys, std::size_t n, bool* found) const;
+
+  /**
+   * @brief Retorna a quantidade de pares do mapa.
+   */
+  std::size_t size() const;
+
+  /**
+   * @brief Visita os pares em ordem de chave, sem copiá-los.
+   *
+   * @param f Função chamada como `f(const K&, const V&)`; se devolver `bool`,
+   * `false` interrompe a visita.
+   * @return `true` se todos os pares foram visitados.
+   */
+  template <class F>
+  bool for_each(F&& f) const;
+
+  /**
+   * @brief Exporta os pares em ordem de chave para dois vetores paralelos
+   * (estrutura de vetores), usando várias threads (ver
+   * `AVL::parallel_for_each_in_order`).
+   *
+   * @param keys Buffer com pelo menos `size()` chaves já construídas.
+   * @param values Buffer com pelo menos `size()` valores já construídos.
+   * @param threads Quantidade de threads; 0 escolhe automaticamente.
+   */
+  void parallel_export(K* keys, V* values, unsigned threads = 0) const;
+
+  /**
+   * @brief Grava o mapa num snapshot binário versionado.
+   *
+   * Os pares são gravados em ordem de chave, em blocos com as chaves e depois
+   * os valores do bloco (vetores brutos para tipos trivialmente copiáveis,
+   * prefixo de tamanho para os demais). Veja `SnapshotHeader`.
+   *
+   * @param out Fluxo binário de saída.
+   * @throw std::runtime_error se a escrita falhar.
+   */
+  void save(std::ostream& out) const;
+
+  /**
+   * @brief Substitui o conteúdo pelo de um snapshot gravado com `save`.
+   *
+   * Reconstrói uma árvore balanceada em O(n) diretamente do fluxo, sem
+   * descidas por chave. Em caso de erro o mapa permanece inalterado.
+   *
+   * @param in Fluxo binário de entrada.
+   * @throw std::runtime_error se o snapshot for inválido ou incompatível.
+   */
+  void load(std::istream& in);
+
  private:
-  BST<Pair> data;  ///< A Árvore Binária que armazena os pares chave-valor.
+  friend struct CoroutineAccess;  ///< Buscas intercaladas (C++20).
+
+  /**
+   * @brief Converte o par guardado na árvore numa `Entry`.
+   */
+  static Entry entry(const Pair* pair) {
+    return pair ? Entry(&pair->key, &pair->value) : Entry(nullptr, nullptr);
+  }
+
+  /**
+   * @brief Grava `value` em `key` (inserindo a chave se preciso) e atualiza
+   * os agregados.
+   */
+  void store(const K& key, const V& value);
+
+  Tree data;  ///< A Árvore AVL que armazena os pares chave-valor.
 };
 
-template <class K, class V>
-Map<K, V>::Map() {}
+template <class K, class V, class Augment>
+Map<K, V, Augment>::Map() {}
+
+template <class K, class V, class Augment>
+void Map<K, V, Augment>::swap(Map& other) noexcept {
+  data.swap(other.data);
+}
 
-template <class K, class V>
-V& Map<K, V>::operator[](const K& key) {
-   typename BST<Pair>::TreeNode* node = data.find_node(Pair(key));
-    if (node == nullptr) {
-        data.insert(Pair(key));
-        node = data.find_node(Pair(key));
-        node->data.value = V();
+template <class K, class V, class Augment>
+void swap(Map<K, V, Augment>& a, Map<K, V, Augment>& b) noexcept {
+  a.swap(b);
+}
+
+template <class K, class V, class Augment>
+typename Map<K, V, Augment>::ValueRef Map<K, V, Augment>::operator[](const K& key) {
+  if constexpr (std::is_void<Augment>::value) {
+    Pair* pair = data.find_for_update(Pair(key));
+    if (pair == nullptr) {
+      data.insert(Pair(key));
+      pair = data.find_for_update(Pair(key));
     }
-    return node->data.value;
+    return pair->value;
+  } else {
+    if (!data.find(Pair(key))) data.insert(Pair(key));
+    return Reference(this, key);
+  }
 }
 
-template <class K, class V>
-const V& Map<K, V>::operator[](const K& key) const {
-  typename BST<Pair>::TreeNode* node = data.find_node(Pair(key));
-  if (node == nullptr) {
+template <class K, class V, class Augment>
+void Map<K, V, Augment>::store(const K& key, const V& value) {
+  auto assign = [&value](Pair& pair) { pair.value = value; };
+  if (!data.modify(Pair(key), assign)) {
+    data.insert(Pair(key));
+    data.modify(Pair(key), assign);
+  }
+}
+
+template <class K, class V, class Augment>
+const V& Map<K, V, Augment>::operator[](const K& key) const {
+  const Pair* pair = data.find(Pair(key));
+  if (pair == nullptr) {
       throw std::out_of_range("chave não encontrada no Map");
   }
-  return node->data.value;
+  return pair->value;
+}
+
+template <class K, class V, class Augment>
+typename Map<K, V, Augment>::Entry Map<K, V, Augment>::lower_bound(const K& key) const {
+  return entry(data.lower_bound(Pair(key)));
+}
+
+template <class K, class V, class Augment>
+typename Map<K, V, Augment>::Entry Map<K, V, Augment>::upper_bound(const K& key) const {
+  return entry(data.upper_bound(Pair(key)));
+}
+
+template <class K, class V, class Augment>
+typename Map<K, V, Augment>::Entry Map<K, V, Augment>::ceiling(const K& key) const {
+  return entry(data.ceiling(Pair(key)));
 }
 
-template <class K, class V>
-bool Map<K, V>::remove(const K& key) {
+template <class K, class V, class Augment>
+typename Map<K, V, Augment>::Entry Map<K, V, Augment>::floor(const K& key) const {
+  return entry(data.floor(Pair(key)));
+}
+
+template <class K, class V, class Augment>
+typename Map<K, V, Augment>::Entry Map<K, V, Augment>::successor(const K& key) const {
+  return entry(data.successor(Pair(key)));
+}
+
+template <class K, class V, class Augment>
+typename Map<K, V, Augment>::Entry Map<K, V, Augment>::predecessor(const K& key) const {
+  return entry(data.predecessor(Pair(key)));
+}
+
+template <class K, class V, class Augment>
+typename Map<K, V, Augment>::Entry Map<K, V, Augment>::nearest(const K& key) const {
+  const Pair* low = data.floor(Pair(key));
+  const Pair* high = data.ceiling(Pair(key));
+  if (!low) return entry(high);
+  if (!high) return entry(low);
+  return entry(closer_above(low->key, key, high->key) ? high : low);
+}
+
+template <class K, class V, class Augment>
+bool Map<K, V, Augment>::remove(const K& key) {
   return data.remove(Pair(key));
 
-}
\ No newline at end of file
+}
+
+template <class K, class V, class Augment>
+std::size_t Map<K, V, Augment>::erase_range(const K& lo, const K& hi) {
+  return data.erase_range(Pair(lo), Pair(hi));
+}
+
+template <class K, class V, class Augment>
+Map<K, V, Augment> Map<K, V, Augment>::extract_range(const K& lo, const K& hi) {
+  Map result;
+  result.data = data.extract_range(Pair(lo), Pair(hi));
+  return result;
+}
+
+template <class K, class V, class Augment>
+typename Map<K, V, Augment>::Summary Map<K, V, Augment>::aggregate(const K& lo,
+                                                                   const K& hi) const {
+  return data.aggregate(Pair(lo), Pair(hi));
+}
+
+template <class K, class V, class Augment>
+typename Map<K, V, Augment>::Summary Map<K, V, Augment>::aggregate() const {
+  return data.aggregate();
+}
+
+template <class K, class V, class Augment>
+std::size_t Map<K, V, Augment>::find_many(const K* keys, std::size_t n,
+                                 const V** values) const {
+  constexpr std::size_t kGroup = Tree::kBatchGroup;
+  std::vector<Pair> probes;
+  probes.reserve(kGroup);
+  const Pair* nodes[kGroup];
+  std::size_t hits = 0;
+  for (std::size_t first = 0; first < n; first += kGroup) {
+    std::size_t m = std::min(kGroup, n - first);
+    probes.clear();
+    for (std::size_t i = 0; i < m; ++i) probes.emplace_back(keys[first + i]);
+    hits += data.find_many(probes.data(), m, nodes);
+    for (std::size_t i = 0; i < m; ++i) {
+      values[first + i] = nodes[i] ? &nodes[i]->value : nullptr;
+    }
+  }
+  return hits;
+}
+
+template <class K, class V, class Augment>
+std::size_t Map<K, V, Augment>::contains_many(const K* keys, std::size_t n,
+                                     bool* found) const {
+  constexpr std::size_t kGroup = Tree::kBatchGroup;
+  const V* values[kGroup];
+  std::size_t hits = 0;
+  for (std::size_t first = 0; first < n; first += kGroup) {
+    std::size_t m = std::min(kGroup, n - first);
+    hits += find_many(keys + first, m, values);
+    for (std::size_t i = 0; i < m; ++i) found[first + i] = values[i] != nullptr;
+  }
+  return hits;
+}
+
+template <class K, class V, class Augment>
+std::size_t Map<K, V, Augment>::size() const {
+  return data.size();
+}
+
+template <class K, class V, class Augment>
+template <class F>
+bool Map<K, V, Augment>::for_each(F&& f) const {
+  return data.for_each_in_order(
+      [&f](const Pair& pair) { return keep_visiting(f, pair.key, pair.value); });
+}
+
+template <class K, class V, class Augment>
+void Map<K, V, Augment>::parallel_export(K* keys, V* values, unsigned threads) const {
+  data.parallel_for_each_in_order(
+      [keys, values](const Pair& pair, std::size_t i) {
+        keys[i] = pair.key;
+        values[i] = pair.value;
+      },
+      threads);
+}
+
+template <class K, class V, class Augment>
+void Map<K, V, Augment>::save(std::ostream& out) const {
+  SnapshotHeader header =
+      SnapshotHeader::make<K, V>(SnapshotHeader::kMap, data.size());
+  header.write(out);
+  SnapshotWriter<K, V> writer(out, header);
+  data.for_each_in_order(
+      [&writer](const Pair& pair) { writer.push(pair.key, pair.value); });
+  writer.flush();
+  if (!out) throw std::runtime_error("falha ao gravar snapshot do Map");
+}
+
+template <class K, class V, class Augment>
+void Map<K, V, Augment>::load(std::istream& in) {
+  SnapshotHeader header = SnapshotHeader::read(
+      in, SnapshotHeader::make<K, V>(SnapshotHeader::kMap, 0));
+  SnapshotReader<K, V> reader(in, header);
+  Tree loaded;
+  loaded.assign_sorted(header.count, [&] {
+    reader.advance();
+    Pair pair(reader.key());
+    pair.value = reader.value();
+    return pair;
+  });
+  data.swap(loaded);
+}
@@ -0,0 +1,496 @@
+#pragma once
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "map.hpp"
+
+/**
+ * @brief Representação de um tipo dentro de um arquivo mapeado.
+ *
+ * Tipos trivialmente copiáveis têm largura fixa e são lidos diretamente como
+ * um vetor; `std::string` tem largura variável e é gravada como tabela de
+ * deslocamentos (n + 1 entradas) seguida dos bytes concatenados, lida como
+ * `std::string_view`.
+ *
+ * @tparam T Tipo armazenado.
+ */
+template <class T, class Enable = void>
+struct MappedField;
+
+template <class T>
+struct MappedField<T, std::enable_if_t<std::is_trivially_copyable<T>::value>> {
+  static constexpr std::uint32_t kind = 0;  ///< Largura fixa.
+  using view = const T&;                    ///< Acesso sem cópia.
+
+  static view get(const char* base, std::uint64_t offset, std::uint64_t,
+                  std::size_t i) {
+    return reinterpret_cast<const T*>(base + offset)[i];
+  }
+};
+
+template <>
+struct MappedField<std::string> {
+  static constexpr std::uint32_t kind = 1;  ///< Largura variável.
+  using view = std::string_view;            ///< Acesso sem cópia.
+
+  static view get(const char* base, std::uint64_t offset, std::uint64_t data,
+                  std::size_t i) {
+    const std::uint64_t* offsets =
+        reinterpret_cast<const std::uint64_t*>(base + offset);
+    return std::string_view(base + data + offsets[i],
+                            static_cast<std::size_t>(offsets[i + 1] - offsets[i]));
+  }
+};
+
+/**
+ * @brief Mapa somente leitura servido diretamente de um arquivo mapeado.
+ *
+ * `write` serializa um `Map<K, V>` num layout estático de busca; o construtor
+ * apenas faz `mmap` do arquivo e valida o cabeçalho em O(1), de modo que a
+ * abertura é instantânea e as páginas são compartilhadas entre processos que
+ * abrem o mesmo arquivo. As consultas trabalham sobre a própria memória
+ * mapeada, sem desserialização.
+ *
+ * Layout (ordem de bytes da máquina que gravou, seções alinhadas a 16):
+ * - cabeçalho (`Header`);
+ * - amostras: uma a cada `kStride` chaves, para chaves de largura fixa; a
+ *   busca binária nas amostras cabe em cache e limita a busca final a um
+ *   bloco de `kStride` chaves;
+ * - chaves: vetor de largura fixa, ou tabela de deslocamentos + bytes;
+ * - valores: idem.
+ *
+ * A abertura valida, em O(1), o cabeçalho e se cada seção cabe inteira no
+ * arquivo antes da seção seguinte: amostras, vetores de largura fixa,
+ * tabelas de deslocamentos e o último deslocamento de cada tabela. As
+ * entradas intermediárias das tabelas não são percorridas; para elas o
+ * arquivo é considerado confiável.
+ *
+ * `write` grava num arquivo temporário e o renomeia sobre o destino, de modo
+ * que processos com o arquivo antigo mapeado continuam lendo o inode antigo.
+ *
+ * @tparam K Tipo da chave (trivialmente copiável ou `std::string`).
+ * @tparam V Tipo do valor (trivialmente copiável ou `std::string`).
+ */
+template <class K, class V>
+class MappedMap {
+ public:
+  using key_view = typename MappedField<K>::view;    ///< Chave sem cópia.
+  using value_view = typename MappedField<V>::view;  ///< Valor sem cópia.
+
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+  static constexpr std::size_t kStride = 64;  ///< Chaves por amostra.
+
+  /**
+   * @brief Grava `map` em `path` no layout mapeável.
+   *
+   * Percorre o mapa em ordem uma vez por coluna, sem copiá-lo para a
+   * memória. O arquivo é gravado em `path + ".tmp"`, sincronizado e
+   * renomeado sobre `path`; mapeamentos existentes de `path` não mudam.
+   *
+   * @param map Mapa de origem.
+   * @param path Caminho do arquivo (substituído).
+   * @throw std::runtime_error se a escrita falhar.
+   * @throw std::system_error se a sincronização ou o rename falharem.
+   */
+  template <class A>
+  static void write(const Map<K, V, A>& map, const std::string& path);
+
+  /**
+   * @brief Abre e mapeia um arquivo gravado por `write`.
+   *
+   * @param path Caminho do arquivo.
+   * @throw std::system_error se o arquivo não puder ser aberto ou mapeado.
+   * @throw std::runtime_error se o arquivo for inválido ou de outros tipos.
+   */
+  explicit MappedMap(const std::string& path);
+
+  /**
+   * @brief Desfaz o mapeamento.
+   */
+  ~MappedMap();
+
+  MappedMap(MappedMap&& other) noexcept;
+  MappedMap& operator=(MappedMap&& other) noexcept;
+  MappedMap(const MappedMap&) = delete;
+  MappedMap& operator=(const MappedMap&) = delete;
+
+  /**
+   * @brief Retorna a quantidade de pares.
+   */
+  std::size_t size() const { return static_cast<std::size_t>(header().count); }
+
+  /**
+   * @brief Retorna a chave na posição `i` (ordem crescente).
+   */
+  key_view key(std::size_t i) const {
+    return MappedField<K>::get(base, header().keys, header().key_data, i);
+  }
+
+  /**
+   * @brief Retorna o valor na posição `i`.
+   */
+  value_view value(std::size_t i) const {
+    return MappedField<V>::get(base, header().values, header().value_data, i);
+  }
+
+  /**
+   * @brief Retorna a posição da primeira chave >= `key`, ou `size()`.
+   */
+  template <class Q>
+  std::size_t lower_bound(const Q& key) const;
+
+  /**
+   * @brief Retorna a posição da chave `key`, ou `npos` se ausente.
+   */
+  template <class Q>
+  std::size_t find(const Q& key) const;
+
+  /**
+   * @brief Verifica se a chave está presente.
+   */
+  template <class Q>
+  bool contains(const Q& key) const {
+    return find(key) != npos;
+  }
+
+  /**
+   * @brief Visita, em ordem, os pares com chave em [`lo`, `hi`).
+   *
+   * @param f Função chamada como `f(key_view, value_view)`; se devolver
+   * `bool`, `false` interrompe a varredura.
+   */
+  template <class Q, class F>
+  void scan(const Q& lo, const Q& hi, F&& f) const;
+
+ private:
+  /**
+   * @brief Cabeçalho do arquivo; deslocamentos em bytes desde o início.
+   */
+  struct Header {
+    char magic[4];
+    std::uint16_t version;
+    std::uint16_t reserved;
+    std::uint32_t key_kind;
+    std::uint32_t value_kind;
+    std::uint32_t key_size;
+    std::uint32_t value_size;
+    std::uint64_t count;
+    std::uint64_t samples;     ///< Vetor de amostras (largura fixa).
+    std::uint64_t keys;        ///< Vetor de chaves ou tabela de offsets.
+    std::uint64_t key_data;    ///< Bytes das chaves variáveis.
+    std::uint64_t values;      ///< Vetor de valores ou tabela de offsets.
+    std::uint64_t value_data;  ///< Bytes dos valores variáveis.
+    std::uint64_t file_size;   ///< Tamanho total esperado.
+  };
+
+  static constexpr char kMagic[4] = {'E', 'D', 'M', 'M'};
+  static constexpr std::uint16_t kVersion = 1;
+  static constexpr std::uint64_t kAlign = 16;
+
+  const Header& header() const {
+    return *reinterpret_cast<const Header*>(base);
+  }
+
+  template <class T>
+  static std::uint32_t field_size() {
+    return MappedField<T>::kind == 0 ? sizeof(T) : 0;
+  }
+
+  /**
+   * @brief Grava uma coluna e devolve (offset, offset dos dados variáveis).
+   *
+   * `each(sink)` deve chamar `sink(const T&)` para cada valor da coluna, em
+   * ordem; colunas de tamanho variável a chamam duas vezes (posições e
+   * bytes), então nada precisa ser copiado para a memória.
+   */
+  template <class T, class Each>
+  static std::pair<std::uint64_t, std::uint64_t> write_column(
+      std::ofstream& out, Each each);
+
+  static void pad(std::ofstream& out);
+
+  /**
+   * @brief fsync de um arquivo ou diretório.
+   */
+  static void sync_path(const std::string& path, bool directory);
+
+  /**
+   * @brief Verifica se `n` itens de `size` bytes a partir de `offset` cabem
+   * antes de `limit`, sem estourar a aritmética.
+   */
+  static bool fits(std::uint64_t offset, std::uint64_t n, std::uint64_t size,
+                   std::uint64_t limit) {
+    return offset <= limit && offset % kAlign == 0 &&
+           n <= (limit - offset) / size;
+  }
+
+  /**
+   * @brief Verifica se uma coluna começando em `offset` (com dados variáveis
+   * em `data`) cabe inteira antes de `limit`.
+   */
+  template <class T>
+  bool column_fits(std::uint64_t offset, std::uint64_t data,
+                   std::uint64_t limit) const;
+
+  const char* base;    ///< Início do mapeamento.
+  std::size_t length;  ///< Tamanho do mapeamento.
+};
+
+template <class K, class V>
+void MappedMap<K, V>::pad(std::ofstream& out) {
+    static const char zeros[kAlign] = {};
+    std::uint64_t position = static_cast<std::uint64_t>(out.tellp());
+    std::uint64_t padding = (kAlign - position % kAlign) % kAlign;
+    out.write(zeros, static_cast<std::streamsize>(padding));
+}
+
+template <class K, class V>
+template <class T, class Each>
+std::pair<std::uint64_t, std::uint64_t> MappedMap<K, V>::write_column(
+    std::ofstream& out, Each each) {
+    pad(out);
+    std::uint64_t offset = static_cast<std::uint64_t>(out.tellp());
+    if constexpr (MappedField<T>::kind == 0) {
+        each([&](const T& value) {
+            out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        });
+        return {offset, 0};
+    } else {
+        std::uint64_t position = 0;
+        out.write(reinterpret_cast<const char*>(&position), sizeof(position));
+        each([&](const T& value) {
+            position += value.size();
+            out.write(reinterpret_cast<const char*>(&position), sizeof(position));
+        });
+        pad(out);
+        std::uint64_t data = static_cast<std::uint64_t>(out.tellp());
+        each([&](const T& value) {
+            out.write(value.data(), static_cast<std::streamsize>(value.size()));
+        });
+        return {offset, data};
+    }
+}
+
+template <class K, class V>
+template <class A>
+void MappedMap<K, V>::write(const Map<K, V, A>& map, const std::string& path) {
+    std::size_t n = map.size();
+
+    std::string temporary = path + ".tmp";
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("não foi possível criar " + temporary);
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.key_kind = MappedField<K>::kind;
+    header.value_kind = MappedField<V>::kind;
+    header.key_size = field_size<K>();
+    header.value_size = field_size<V>();
+    header.count = n;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Cada coluna é uma passada em ordem pelo Map, sem cópia intermediária.
+    if constexpr (MappedField<K>::kind == 0) {
+        header.samples = write_column<K>(out, [&](auto&& sink) {
+            std::size_t i = 0;
+            map.for_each([&](const K& key, const V&) {
+                if (i++ % kStride == 0) sink(key);
+            });
+        }).first;
+    }
+    auto keys = write_column<K>(out, [&](auto&& sink) {
+        map.for_each([&](const K& key, const V&) { sink(key); });
+    });
+    auto values = write_column<V>(out, [&](auto&& sink) {
+        map.for_each([&](const K&, const V& value) { sink(value); });
+    });
+    header.keys = keys.first;
+    header.key_data = keys.second;
+    header.values = values.first;
+    header.value_data = values.second;
+    header.file_size = static_cast<std::uint64_t>(out.tellp());
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out) throw std::runtime_error("falha ao gravar " + temporary);
+
+    // Renomear em vez de sobrescrever: quem já mapeou `path` mantém o inode
+    // antigo, intacto, até desfazer o mapeamento.
+    sync_path(temporary, false);
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        throw std::system_error(errno, std::generic_category(), "rename " + path);
+    }
+    std::string::size_type slash = path.find_last_of('/');
+    sync_path(slash == std::string::npos ? "." : path.substr(0, slash + 1), true);
+}
+
+template <class K, class V>
+void MappedMap<K, V>::sync_path(const std::string& path, bool directory) {
+    int fd = ::open(path.c_str(), directory ? O_RDONLY | O_DIRECTORY : O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "open " + path);
+    }
+    int result = ::fsync(fd);
+    int error = errno;
+    ::close(fd);
+    if (result != 0) {
+        throw std::system_error(error, std::generic_category(), "fsync " + path);
+    }
+}
+
+template <class K, class V>
+template <class T>
+bool MappedMap<K, V>::column_fits(std::uint64_t offset, std::uint64_t data,
+                                  std::uint64_t limit) const {
+    std::uint64_t count = header().count;
+    if constexpr (MappedField<T>::kind == 0) {
+        return fits(offset, count, sizeof(T), limit);
+    } else {
+        // Tabela de count + 1 deslocamentos, depois os bytes; o último
+        // deslocamento é o tamanho total dos bytes.
+        if (!fits(offset, count, sizeof(std::uint64_t), limit) ||
+            !fits(offset, count + 1, sizeof(std::uint64_t), data) ||
+            data > limit) {
+            return false;
+        }
+        std::uint64_t total = 0;
+        std::memcpy(&total, base + offset + count * sizeof(std::uint64_t),
+                    sizeof(total));
+        return total <= limit - data;
+    }
+}
+
+template <class K, class V>
+MappedMap<K, V>::MappedMap(const std::string& path) : base(nullptr), length(0) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "open " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "fstat " + path);
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    if (length < sizeof(Header)) {
+        ::close(fd);
+        throw std::runtime_error("arquivo mapeado inválido: " + path);
+    }
+    void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::system_error(error, std::generic_category(), "mmap " + path);
+    }
+    base = static_cast<const char*>(mapping);
+
+    const Header& h = header();
+    bool valid = std::memcmp(h.magic, kMagic, sizeof(kMagic)) == 0 &&
+                 h.version == kVersion && h.file_size == length &&
+                 h.key_kind == MappedField<K>::kind &&
+                 h.value_kind == MappedField<V>::kind &&
+                 h.key_size == field_size<K>() &&
+                 h.value_size == field_size<V>() && h.count < length;
+    if (valid && MappedField<K>::kind == 0) {
+        std::uint64_t samples = (h.count + kStride - 1) / kStride;
+        valid = h.samples >= sizeof(Header) &&
+                fits(h.samples, samples, sizeof(K), h.keys);
+    } else if (valid) {
+        valid = h.keys >= sizeof(Header);
+    }
+    valid = valid && column_fits<K>(h.keys, h.key_data, h.values) &&
+            column_fits<V>(h.values, h.value_data, length);
+    if (!valid) {
+        ::munmap(const_cast<char*>(base), length);
+        throw std::runtime_error("arquivo mapeado inválido ou de outros tipos: " + path);
+    }
+}
+
+template <class K, class V>
+MappedMap<K, V>::~MappedMap() {
+    if (base) ::munmap(const_cast<char*>(base), length);
+}
+
+template <class K, class V>
+MappedMap<K, V>::MappedMap(MappedMap&& other) noexcept
+    : base(other.base), length(other.length) {
+    other.base = nullptr;
+    other.length = 0;
+}
+
+template <class K, class V>
+MappedMap<K, V>& MappedMap<K, V>::operator=(MappedMap&& other) noexcept {
+    std::swap(base, other.base);
+    std::swap(length, other.length);
+    return *this;
+}
+
+template <class K, class V>
+template <class Q>
+std::size_t MappedMap<K, V>::lower_bound(const Q& query) const {
+    std::size_t first = 0;
+    std::size_t last = size();
+
+    if constexpr (MappedField<K>::kind == 0) {
+        // Primeiro nível: amostras, depois um único bloco de kStride chaves.
+        const K* samples = reinterpret_cast<const K*>(base + header().samples);
+        std::size_t count = (last + kStride - 1) / kStride;
+        std::size_t j = static_cast<std::size_t>(
+            std::upper_bound(samples, samples + count, query,
+                             [](const Q& q, const K& k) { return q < k; }) -
+            samples);
+        if (j == 0) return 0;
+        first = (j - 1) * kStride;
+        last = std::min(last, j * kStride);
+    }
+
+    while (first < last) {
+        std::size_t middle = first + (last - first) / 2;
+        if (key(middle) < query) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    return first;
+}
+
+template <class K, class V>
+template <class Q>
+std::size_t MappedMap<K, V>::find(const Q& query) const {
+    std::size_t i = lower_bound(query);
+    if (i < size() && !(query < key(i))) return i;
+    return npos;
+}
+
+template <class K, class V>
+template <class Q, class F>
+void MappedMap<K, V>::scan(const Q& lo, const Q& hi, F&& f) const {
+    for (std::size_t i = lower_bound(lo); i < size() && key(i) < hi; ++i) {
+        if constexpr (std::is_same<decltype(f(key(i), value(i))), bool>::value) {
+            if (!f(key(i), value(i))) return;
+        } else {
+            f(key(i), value(i));
+        }
+    }
+}
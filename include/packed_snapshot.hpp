@@ -0,0 +1,538 @@
+#pragma once
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "serial.hpp"
+#include "set.hpp"
+
+/**
+ * @brief Snapshot compactado de conjuntos de inteiros: deltas empacotados em
+ * bits, por bloco, com índice de blocos.
+ *
+ * Formato (ordem de bytes da máquina que gravou):
+ * - cabeçalho: `magic` "EDPK", `version` (u16), `key_size` (u8), `is_signed`
+ *   (u8), `block` (u32), `reserved` (u32), `count` (u64);
+ * - blocos de até `block` valores: primeiro valor (u64), largura `w` (u8) e
+ *   os `n - 1` deltas menos um (a sequência é estritamente crescente), com
+ *   `w` bits cada, do bit menos significativo para o mais significativo;
+ * - índice: para cada bloco, primeiro valor (u64) e deslocamento (u64).
+ *
+ * Valores com sinal são mapeados para sem sinal invertendo o bit de sinal,
+ * o que preserva a ordem. Ids densos ocupam poucos bits por valor em vez de
+ * `sizeof(T)` bytes.
+ *
+ * A restauração completa lê os blocos em sequência; o índice, no fim do
+ * arquivo, permite consultar um valor decodificando um único bloco
+ * (`PackedSetFile`).
+ *
+ * @tparam T Tipo inteiro dos valores.
+ */
+template <class T>
+class PackedCodec {
+  static_assert(std::is_integral<T>::value && sizeof(T) <= 8,
+                "PackedCodec exige um tipo inteiro de até 64 bits");
+
+ public:
+  static constexpr char kMagic[4] = {'E', 'D', 'P', 'K'};
+  static constexpr std::uint16_t kVersion = 1;
+  static constexpr std::uint32_t kBlock = 128;  ///< Valores por bloco.
+  static constexpr std::size_t kHeaderSize = 24;
+
+  /**
+   * @brief Mapeia um valor para u64 preservando a ordem.
+   */
+  static std::uint64_t encode(T value) {
+    if constexpr (std::is_signed<T>::value) {
+      return static_cast<std::uint64_t>(static_cast<std::int64_t>(value)) ^
+             (std::uint64_t(1) << 63);
+    } else {
+      return static_cast<std::uint64_t>(value);
+    }
+  }
+
+  /**
+   * @brief Inverso de `encode`.
+   */
+  static T decode(std::uint64_t value) {
+    if constexpr (std::is_signed<T>::value) {
+      return static_cast<T>(
+          static_cast<std::int64_t>(value ^ (std::uint64_t(1) << 63)));
+    } else {
+      return static_cast<T>(value);
+    }
+  }
+
+  /**
+   * @brief Gravação incremental: recebe os valores um a um (por exemplo, de
+   * uma travessia em ordem) e mantém em memória apenas o bloco corrente e o
+   * índice.
+   */
+  class Writer {
+   public:
+    /**
+     * @brief Grava o cabeçalho de um snapshot com `n` valores.
+     */
+    Writer(std::ostream& out, std::size_t n);
+
+    /**
+     * @brief Acrescenta o próximo valor (maior que o anterior).
+     *
+     * @throw std::runtime_error se a sequência não for crescente.
+     */
+    void add(T value);
+
+    /**
+     * @brief Grava o último bloco e o índice.
+     *
+     * @throw std::runtime_error se a quantidade de valores não for a
+     * anunciada ou se a escrita falhar.
+     */
+    void finish();
+
+   private:
+    void flush();
+
+    std::ostream& out;
+    std::size_t expected;
+    std::size_t added = 0;
+    std::uint64_t offset = kHeaderSize;
+    std::vector<std::uint64_t> values;  ///< Bloco corrente.
+    std::string bytes;
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> index;
+  };
+
+  /**
+   * @brief Grava `n` valores em ordem estritamente crescente.
+   *
+   * @param next Gerador chamado `n` vezes.
+   * @throw std::runtime_error se a escrita falhar.
+   */
+  template <class Generator>
+  static void write(std::ostream& out, std::size_t n, Generator&& next);
+
+  /**
+   * @brief Lê o cabeçalho e devolve a quantidade de valores.
+   *
+   * @throw std::runtime_error se o cabeçalho for inválido ou de outro tipo.
+   */
+  static std::uint64_t read_header(std::istream& in);
+
+  /**
+   * @brief Lê um bloco do fluxo e acrescenta seus valores a `values`.
+   *
+   * @param n Quantidade de valores do bloco.
+   * @throw std::runtime_error se o bloco estiver truncado ou se algum valor
+   * sair do intervalo de `T` (o que inclui somas de deltas que estouram).
+   */
+  static void read_block(std::istream& in, std::size_t n,
+                         std::vector<std::uint64_t>& values);
+
+  /**
+   * @brief Decodifica um bloco já em memória, parando no primeiro valor
+   * >= `target`.
+   *
+   * @return `true` se `target` está no bloco.
+   */
+  static bool find_in_block(const unsigned char* block, std::size_t n,
+                            std::uint64_t target);
+
+  /**
+   * @brief Tamanho em bytes de um bloco com `n` valores e largura `width`.
+   */
+  static std::size_t block_bytes(std::size_t n, int width) {
+    return 9 + ((n - 1) * static_cast<std::size_t>(width) + 7) / 8;
+  }
+
+ private:
+  static std::uint64_t mask(int bits) {
+    return bits >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << bits) - 1;
+  }
+
+  static void encode_block(const std::vector<std::uint64_t>& values,
+                           std::string& out);
+};
+
+/**
+ * @brief Consulta de pertinência diretamente sobre um arquivo gravado com
+ * `PackedCodec`, sem restaurar o conjunto.
+ *
+ * A abertura carrega apenas o cabeçalho e o índice de blocos (16 bytes a
+ * cada `kBlock` valores); cada consulta faz uma busca binária no índice, lê
+ * um bloco com `pread` e o decodifica.
+ *
+ * @tparam T Tipo inteiro dos valores.
+ */
+template <class T>
+class PackedSetFile {
+ public:
+  /**
+   * @brief Abre o arquivo e carrega o índice.
+   *
+   * @throw std::system_error se o arquivo não puder ser lido.
+   * @throw std::runtime_error se o arquivo for inválido ou de outro tipo.
+   */
+  explicit PackedSetFile(const std::string& path);
+
+  ~PackedSetFile();
+
+  PackedSetFile(const PackedSetFile&) = delete;
+  PackedSetFile& operator=(const PackedSetFile&) = delete;
+
+  /**
+   * @brief Quantidade de valores do arquivo.
+   */
+  std::size_t size() const { return static_cast<std::size_t>(count); }
+
+  /**
+   * @brief Verifica se `value` está no arquivo.
+   */
+  bool contains(const T& value) const;
+
+ private:
+  using Codec = PackedCodec<T>;
+
+  void read_exact(void* buffer, std::size_t size, std::uint64_t offset) const;
+
+  int fd = -1;
+  std::uint64_t count = 0;
+  std::vector<std::uint64_t> firsts;   ///< Primeiro valor de cada bloco.
+  std::vector<std::uint64_t> offsets;  ///< Início de cada bloco (+ fim).
+};
+
+template <class T>
+PackedCodec<T>::Writer::Writer(std::ostream& o, std::size_t n)
+    : out(o), expected(n) {
+  out.write(kMagic, sizeof(kMagic));
+  SnapshotHeader::put(out, kVersion);
+  SnapshotHeader::put(out, static_cast<std::uint8_t>(sizeof(T)));
+  SnapshotHeader::put(out, static_cast<std::uint8_t>(std::is_signed<T>::value));
+  SnapshotHeader::put(out, kBlock);
+  SnapshotHeader::put(out, std::uint32_t(0));
+  SnapshotHeader::put(out, static_cast<std::uint64_t>(n));
+  values.reserve(kBlock);
+}
+
+template <class T>
+void PackedCodec<T>::Writer::add(T value) {
+  values.push_back(encode(value));
+  ++added;
+  if (values.size() == kBlock) flush();
+}
+
+template <class T>
+void PackedCodec<T>::Writer::flush() {
+  bytes.clear();
+  encode_block(values, bytes);
+  out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  index.emplace_back(values.front(), offset);
+  offset += bytes.size();
+  values.clear();
+}
+
+template <class T>
+void PackedCodec<T>::Writer::finish() {
+  if (!values.empty()) flush();
+  if (added != expected) {
+    throw std::runtime_error("snapshot compactado: quantidade de valores incorreta");
+  }
+  for (const auto& entry : index) {
+    SnapshotHeader::put(out, entry.first);
+    SnapshotHeader::put(out, entry.second);
+  }
+  if (!out) throw std::runtime_error("falha ao gravar snapshot compactado");
+}
+
+template <class T>
+template <class Generator>
+void PackedCodec<T>::write(std::ostream& out, std::size_t n, Generator&& next) {
+  Writer writer(out, n);
+  for (std::size_t i = 0; i < n; ++i) writer.add(next());
+  writer.finish();
+}
+
+template <class T>
+void PackedCodec<T>::encode_block(const std::vector<std::uint64_t>& values,
+                                  std::string& out) {
+  std::uint64_t widest = 0;
+  for (std::size_t i = 1; i < values.size(); ++i) {
+    if (!(values[i - 1] < values[i])) {
+      throw std::runtime_error("snapshot compactado exige valores crescentes");
+    }
+    widest |= values[i] - values[i - 1] - 1;
+  }
+  int width = 0;
+  while (width < 64 && (widest >> width) != 0) ++width;
+
+  out.append(reinterpret_cast<const char*>(&values.front()), sizeof(std::uint64_t));
+  out.push_back(static_cast<char>(width));
+
+  std::uint64_t accumulator = 0;
+  int bits = 0;
+  for (std::size_t i = 1; i < values.size(); ++i) {
+    std::uint64_t delta = values[i] - values[i - 1] - 1;
+    for (int done = 0; done < width;) {
+      int take = std::min(width - done, 64 - bits);
+      accumulator |= ((delta >> done) & mask(take)) << bits;
+      bits += take;
+      done += take;
+      while (bits >= 8) {
+        out.push_back(static_cast<char>(accumulator & 0xFF));
+        accumulator >>= 8;
+        bits -= 8;
+      }
+    }
+  }
+  if (bits > 0) out.push_back(static_cast<char>(accumulator & 0xFF));
+}
+
+template <class T>
+std::uint64_t PackedCodec<T>::read_header(std::istream& in) {
+  char magic[sizeof(kMagic)];
+  std::uint16_t version = 0;
+  std::uint8_t key_size = 0;
+  std::uint8_t is_signed = 0;
+  std::uint32_t block = 0;
+  std::uint32_t reserved = 0;
+  std::uint64_t count = 0;
+  in.read(magic, sizeof(magic));
+  SnapshotHeader::get(in, version);
+  SnapshotHeader::get(in, key_size);
+  SnapshotHeader::get(in, is_signed);
+  SnapshotHeader::get(in, block);
+  SnapshotHeader::get(in, reserved);
+  SnapshotHeader::get(in, count);
+  if (!in || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+      version != kVersion) {
+    throw std::runtime_error("snapshot compactado inválido: cabeçalho");
+  }
+  if (key_size != sizeof(T) || is_signed != std::is_signed<T>::value ||
+      block != kBlock) {
+    throw std::runtime_error("snapshot compactado inválido: tipos incompatíveis");
+  }
+  return count;
+}
+
+template <class T>
+void PackedCodec<T>::read_block(std::istream& in, std::size_t n,
+                                std::vector<std::uint64_t>& values) {
+  std::uint64_t value = 0;
+  std::uint8_t width = 0;
+  SnapshotHeader::get(in, value);
+  SnapshotHeader::get(in, width);
+  // Valores codificados válidos ficam em [encode(min), encode(max)].
+  const std::uint64_t lowest = encode(std::numeric_limits<T>::min());
+  const std::uint64_t highest = encode(std::numeric_limits<T>::max());
+  if (!in || width > 64 || value < lowest || value > highest) {
+    throw std::runtime_error("snapshot compactado inválido: bloco");
+  }
+  std::vector<unsigned char> packed(block_bytes(n, width) - 9);
+  in.read(reinterpret_cast<char*>(packed.data()),
+          static_cast<std::streamsize>(packed.size()));
+  if (!in) throw std::runtime_error("snapshot compactado inválido: fim inesperado");
+
+  values.push_back(value);
+  const unsigned char* cursor = packed.data();
+  std::uint64_t accumulator = 0;
+  int bits = 0;
+  for (std::size_t i = 1; i < n; ++i) {
+    std::uint64_t delta = 0;
+    for (int done = 0; done < width;) {
+      if (bits == 0) {
+        accumulator = *cursor++;
+        bits = 8;
+      }
+      int take = std::min<int>(width - done, bits);
+      delta |= (accumulator & mask(take)) << done;
+      accumulator >>= take;
+      bits -= take;
+      done += take;
+    }
+    if (delta >= highest - value) {
+      throw std::runtime_error("snapshot compactado inválido: valor fora do tipo");
+    }
+    value += delta + 1;
+    values.push_back(value);
+  }
+}
+
+template <class T>
+bool PackedCodec<T>::find_in_block(const unsigned char* block, std::size_t n,
+                                   std::uint64_t target) {
+  std::uint64_t value = 0;
+  std::memcpy(&value, block, sizeof(value));
+  int width = block[8];
+  const unsigned char* cursor = block + 9;
+  std::uint64_t accumulator = 0;
+  int bits = 0;
+  for (std::size_t i = 1; i < n && value < target; ++i) {
+    std::uint64_t delta = 0;
+    for (int done = 0; done < width;) {
+      if (bits == 0) {
+        accumulator = *cursor++;
+        bits = 8;
+      }
+      int take = std::min(width - done, bits);
+      delta |= (accumulator & mask(take)) << done;
+      accumulator >>= take;
+      bits -= take;
+      done += take;
+    }
+    value += delta + 1;
+  }
+  return value == target;
+}
+
+template <class T>
+PackedSetFile<T>::PackedSetFile(const std::string& path) {
+  fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "open " + path);
+  }
+  try {
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+      throw std::system_error(errno, std::generic_category(), "fstat " + path);
+    }
+    std::uint64_t file_size = static_cast<std::uint64_t>(info.st_size);
+
+    std::string header(Codec::kHeaderSize, '\0');
+    if (file_size < header.size()) {
+      throw std::runtime_error("snapshot compactado inválido: " + path);
+    }
+    read_exact(&header[0], header.size(), 0);
+    std::istringstream in(header);
+    count = Codec::read_header(in);
+
+    std::uint64_t blocks = (count + Codec::kBlock - 1) / Codec::kBlock;
+    std::uint64_t index_bytes = blocks * 2 * sizeof(std::uint64_t);
+    if (file_size < Codec::kHeaderSize + index_bytes) {
+      throw std::runtime_error("snapshot compactado inválido: " + path);
+    }
+    std::uint64_t index_start = file_size - index_bytes;
+    std::vector<std::uint64_t> index(static_cast<std::size_t>(blocks * 2));
+    if (!index.empty()) {
+      read_exact(index.data(), static_cast<std::size_t>(index_bytes), index_start);
+    }
+    for (std::size_t b = 0; b < blocks; ++b) {
+      firsts.push_back(index[2 * b]);
+      offsets.push_back(index[2 * b + 1]);
+    }
+    offsets.push_back(index_start);
+    for (std::size_t b = 0; b + 1 < offsets.size(); ++b) {
+      if (offsets[b] >= offsets[b + 1]) {
+        throw std::runtime_error("snapshot compactado inválido: " + path);
+      }
+    }
+  } catch (...) {
+    ::close(fd);
+    throw;
+  }
+}
+
+template <class T>
+PackedSetFile<T>::~PackedSetFile() {
+  ::close(fd);
+}
+
+template <class T>
+void PackedSetFile<T>::read_exact(void* buffer, std::size_t size,
+                                  std::uint64_t offset) const {
+  char* data = static_cast<char*>(buffer);
+  while (size > 0) {
+    ssize_t got = ::pread(fd, data, size, static_cast<off_t>(offset));
+    if (got < 0 && errno == EINTR) continue;
+    if (got < 0) throw std::system_error(errno, std::generic_category(), "pread");
+    if (got == 0) throw std::runtime_error("snapshot compactado inválido: fim inesperado");
+    data += got;
+    size -= static_cast<std::size_t>(got);
+    offset += static_cast<std::uint64_t>(got);
+  }
+}
+
+template <class T>
+bool PackedSetFile<T>::contains(const T& value) const {
+  std::uint64_t target = Codec::encode(value);
+  auto it = std::upper_bound(firsts.begin(), firsts.end(), target);
+  if (it == firsts.begin()) return false;
+  std::size_t block = static_cast<std::size_t>(it - firsts.begin()) - 1;
+  if (firsts[block] == target) return true;
+
+  std::size_t n = std::min<std::uint64_t>(Codec::kBlock,
+                                          count - block * std::uint64_t(Codec::kBlock));
+  std::vector<unsigned char> bytes(
+      static_cast<std::size_t>(offsets[block + 1] - offsets[block]));
+  read_exact(bytes.data(), bytes.size(), offsets[block]);
+  if (bytes.size() < 9 || bytes[8] > 64 ||
+      bytes.size() < Codec::block_bytes(n, bytes[8])) {
+    throw std::runtime_error("snapshot compactado inválido: bloco");
+  }
+  return Codec::find_in_block(bytes.data(), n, target);
+}
+
+/**
+ * @brief Grava o conjunto num snapshot compactado (apenas tipos inteiros).
+ *
+ * Os valores são gravados como deltas empacotados em bits, em blocos com
+ * índice, o que permite consultas diretas no arquivo com `PackedSetFile`.
+ * Veja `PackedCodec`.
+ *
+ * @param set Conjunto a gravar.
+ * @param out Fluxo binário de saída.
+ * @throw std::runtime_error se a escrita falhar.
+ */
+template <class T>
+void save_packed(const Set<T>& set, std::ostream& out) {
+  typename PackedCodec<T>::Writer writer(out, set.size());
+  set.for_each([&](const T& value) { writer.add(value); });
+  writer.finish();
+}
+
+/**
+ * @brief Substitui o conteúdo de `set` pelo de um snapshot gravado com
+ * `save_packed`, em O(n). Em caso de erro o conjunto permanece inalterado.
+ *
+ * @param set Conjunto de destino.
+ * @param in Fluxo binário de entrada.
+ * @throw std::runtime_error se o snapshot for inválido ou incompatível.
+ */
+template <class T>
+void load_packed(Set<T>& set, std::istream& in) {
+  using Codec = PackedCodec<T>;
+  std::uint64_t remaining = Codec::read_header(in);
+  std::vector<std::uint64_t> block;
+  std::size_t position = 0;
+  set.assign_sorted(static_cast<std::size_t>(remaining), [&] {
+    if (position == block.size()) {
+      std::size_t n = static_cast<std::size_t>(
+          std::min<std::uint64_t>(Codec::kBlock, remaining));
+      // Dentro do bloco a ordem vem dos deltas; entre blocos, é verificada.
+      bool first = block.empty();
+      std::uint64_t last = first ? 0 : block.back();
+      block.clear();
+      Codec::read_block(in, n, block);
+      if (!first && block.front() <= last) {
+        throw std::runtime_error("snapshot compactado inválido: fora de ordem");
+      }
+      remaining -= n;
+      position = 0;
+    }
+    return Codec::decode(block[position++]);
+  });
+}
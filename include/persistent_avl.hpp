@@ -0,0 +1,435 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Árvore AVL persistente (cópia de caminho) com snapshots em O(1).
+ *
+ * `insert` e `remove` copiam apenas os nós do caminho raiz-folha que ainda
+ * são compartilhados com algum snapshot; o restante da árvore é
+ * compartilhado. Nós exclusivos da árvore (contagem de referências igual a
+ * 1) são alterados diretamente, de modo que, sem snapshots vivos, o custo é o
+ * mesmo de uma AVL comum.
+ *
+ * `snapshot()` apenas incrementa a contagem da raiz e devolve um
+ * `Snapshot`, um handle somente leitura com as mesmas consultas da árvore.
+ * Snapshots podem ser lidos, copiados e destruídos em outras threads enquanto
+ * a árvore continua sendo modificada; a própria árvore admite um único
+ * escritor por vez.
+ *
+ * @tparam T Tipo dos elementos. Deve suportar o operador '<'.
+ */
+template <class T>
+class PersistentAVL {
+ private:
+  /**
+   * @brief Nó com contagem de referências.
+   *
+   * Cada ponteiro de um pai, da árvore ou de um snapshot conta como uma
+   * referência.
+   */
+  struct Node {
+    T data;              ///< Valor armazenado no nó.
+    const Node* left;    ///< Filho à esquerda.
+    const Node* right;   ///< Filho à direita.
+    int height;          ///< Altura do nó (folha = 1).
+    mutable std::atomic<std::size_t> refs;  ///< Referências ao nó.
+
+    explicit Node(const T& value)
+        : data(value), left(nullptr), right(nullptr), height(1), refs(1) {}
+  };
+
+  static const Node* acquire(const Node* node) {
+    if (node) node->refs.fetch_add(1, std::memory_order_relaxed);
+    return node;
+  }
+
+  /**
+   * @brief Solta uma referência, liberando o nó e descendo nos filhos quando
+   * ela era a última.
+   */
+  static void release(const Node* node);
+
+  static int height(const Node* node) { return node ? node->height : 0; }
+
+  static void update(Node* node) {
+    node->height = std::max(height(node->left), height(node->right)) + 1;
+  }
+
+  /**
+   * @brief Torna exclusivo o nó apontado por `slot`.
+   *
+   * `slot` deve pertencer a um nó exclusivo (ou à própria árvore). Se o nó
+   * apontado só é referenciado por `slot`, é devolvido para alteração
+   * direta; caso contrário, é copiado e `slot` passa a apontar para a cópia.
+   */
+  static Node* own(const Node*& slot);
+
+  static void rotate_left(const Node*& slot);
+  static void rotate_right(const Node*& slot);
+  static void balance(const Node*& slot);
+
+  static void insert(const Node*& slot, const T& value);
+  static void remove(const Node*& slot, const T& value);
+  static void remove_min(const Node*& slot, T& min);
+
+  static bool contain(const Node* node, const T& value);
+  static void in_order(const Node* node, std::vector<T>& result);
+  static void pre_order(const Node* node, std::vector<T>& result);
+  static void post_order(const Node* node, std::vector<T>& result);
+  static std::pair<bool, int> is_balanced(const Node* node);
+
+ public:
+  /**
+   * @brief Visão somente leitura e imutável da árvore num instante.
+   *
+   * Copiar um snapshot custa O(1). Os nós compartilhados são liberados
+   * quando o último snapshot ou árvore que os referencia é destruído.
+   */
+  class Snapshot {
+   public:
+    Snapshot() : root(nullptr) {}
+    Snapshot(const Snapshot& other) : root(acquire(other.root)) {}
+    Snapshot(Snapshot&& other) noexcept : root(other.root) {
+      other.root = nullptr;
+    }
+    Snapshot& operator=(Snapshot other) noexcept {
+      std::swap(root, other.root);
+      return *this;
+    }
+    ~Snapshot() { release(root); }
+
+    /**
+     * @brief Verifica se um valor está presente no snapshot.
+     */
+    bool contain(const T& value) const {
+      return PersistentAVL::contain(root, value);
+    }
+
+    /**
+     * @brief Retorna os valores do snapshot em ordem (in-order).
+     */
+    std::vector<T> in_order() const;
+
+    /**
+     * @brief Retorna os valores do snapshot em pré-ordem (pre-order).
+     */
+    std::vector<T> pre_order() const;
+
+    /**
+     * @brief Retorna os valores do snapshot em pós-ordem (post-order).
+     */
+    std::vector<T> post_order() const;
+
+    /**
+     * @brief Verifica se o snapshot está balanceado (propriedade da AVL).
+     */
+    bool is_balanced() const {
+      return PersistentAVL::is_balanced(root).first;
+    }
+
+   private:
+    friend class PersistentAVL;
+    explicit Snapshot(const Node* r) : root(r) {}
+
+    const Node* root;  ///< Raiz compartilhada (uma referência).
+  };
+
+  /**
+   * @brief Construtor da árvore (inicialmente vazia).
+   */
+  PersistentAVL();
+
+  /**
+   * @brief Destrutor; solta a referência à raiz.
+   */
+  ~PersistentAVL();
+
+  PersistentAVL(const PersistentAVL&) = delete;
+  PersistentAVL& operator=(const PersistentAVL&) = delete;
+
+  /**
+   * @brief Insere um novo valor na árvore.
+   *
+   * @param value Valor a ser inserido.
+   * @return `true` se inserido com sucesso, `false` se o valor já existia.
+   */
+  bool insert(const T& value);
+
+  /**
+   * @brief Remove um valor da árvore.
+   *
+   * @param value Valor a ser removido.
+   * @return `true` se o valor foi removido, `false` se não estava presente.
+   */
+  bool remove(const T& value);
+
+  /**
+   * @brief Verifica se um valor está presente na árvore.
+   */
+  bool contain(const T& value) const { return contain(root, value); }
+
+  /**
+   * @brief Retorna os valores da árvore em ordem (in-order).
+   */
+  std::vector<T> in_order() const;
+
+  /**
+   * @brief Retorna os valores da árvore em pré-ordem (pre-order).
+   */
+  std::vector<T> pre_order() const;
+
+  /**
+   * @brief Retorna os valores da árvore em pós-ordem (post-order).
+   */
+  std::vector<T> post_order() const;
+
+  /**
+   * @brief Verifica se a árvore está balanceada (propriedade da AVL).
+   */
+  bool is_balanced() const { return is_balanced(root).first; }
+
+  /**
+   * @brief Captura o estado atual da árvore em O(1).
+   *
+   * @return Snapshot que não é afetado por modificações posteriores.
+   */
+  Snapshot snapshot() const { return Snapshot(acquire(root)); }
+
+ private:
+  const Node* root;  ///< Raiz da versão atual (uma referência).
+};
+
+template <class T>
+PersistentAVL<T>::PersistentAVL() : root(nullptr) {}
+
+template <class T>
+PersistentAVL<T>::~PersistentAVL() {
+    release(root);
+}
+
+template <class T>
+void PersistentAVL<T>::release(const Node* node) {
+    while (node && node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        const Node* right = node->right;
+        release(node->left);
+        delete node;
+        node = right;
+    }
+}
+
+template <class T>
+typename PersistentAVL<T>::Node* PersistentAVL<T>::own(const Node*& slot) {
+    if (slot->refs.load(std::memory_order_acquire) == 1) {
+        return const_cast<Node*>(slot);
+    }
+    Node* copy = new Node(slot->data);
+    copy->left = acquire(slot->left);
+    copy->right = acquire(slot->right);
+    copy->height = slot->height;
+    release(slot);
+    slot = copy;
+    return copy;
+}
+
+template <class T>
+void PersistentAVL<T>::rotate_left(const Node*& slot) {
+    Node* node = own(slot);
+    Node* rightChild = own(node->right);
+    node->right = rightChild->left;
+    rightChild->left = node;
+    update(node);
+    update(rightChild);
+    slot = rightChild;
+}
+
+template <class T>
+void PersistentAVL<T>::rotate_right(const Node*& slot) {
+    Node* node = own(slot);
+    Node* leftChild = own(node->left);
+    node->left = leftChild->right;
+    leftChild->right = node;
+    update(node);
+    update(leftChild);
+    slot = leftChild;
+}
+
+template <class T>
+void PersistentAVL<T>::balance(const Node*& slot) {
+    Node* node = own(slot);
+    update(node);
+    int balanceFactor = height(node->left) - height(node->right);
+
+    if (balanceFactor > 1) {
+        if (height(node->left->right) > height(node->left->left)) {
+            rotate_left(node->left);
+        }
+        rotate_right(slot);
+    } else if (balanceFactor < -1) {
+        if (height(node->right->left) > height(node->right->right)) {
+            rotate_right(node->right);
+        }
+        rotate_left(slot);
+    }
+}
+
+template <class T>
+void PersistentAVL<T>::insert(const Node*& slot, const T& value) {
+    if (!slot) {
+        slot = new Node(value);
+        return;
+    }
+    Node* node = own(slot);
+    if (value < node->data) {
+        insert(node->left, value);
+    } else {
+        insert(node->right, value);
+    }
+    balance(slot);
+}
+
+template <class T>
+void PersistentAVL<T>::remove_min(const Node*& slot, T& min) {
+    Node* node = own(slot);
+    if (!node->left) {
+        min = node->data;
+        slot = node->right;
+        node->right = nullptr;
+        release(node);
+        return;
+    }
+    remove_min(node->left, min);
+    balance(slot);
+}
+
+template <class T>
+void PersistentAVL<T>::remove(const Node*& slot, const T& value) {
+    Node* node = own(slot);
+    if (value < node->data) {
+        remove(node->left, value);
+    } else if (node->data < value) {
+        remove(node->right, value);
+    } else if (!node->left) {
+        slot = node->right;
+        node->right = nullptr;
+        release(node);
+        return;
+    } else if (!node->right) {
+        slot = node->left;
+        node->left = nullptr;
+        release(node);
+        return;
+    } else {
+        remove_min(node->right, node->data);
+    }
+    balance(slot);
+}
+
+template <class T>
+bool PersistentAVL<T>::insert(const T& value) {
+    // A verificação prévia evita copiar o caminho quando nada muda.
+    if (contain(root, value)) return false;
+    insert(root, value);
+    return true;
+}
+
+template <class T>
+bool PersistentAVL<T>::remove(const T& value) {
+    if (!contain(root, value)) return false;
+    remove(root, value);
+    return true;
+}
+
+template <class T>
+bool PersistentAVL<T>::contain(const Node* node, const T& value) {
+    while (node) {
+        if (value < node->data) {
+            node = node->left;
+        } else if (node->data < value) {
+            node = node->right;
+        } else {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <class T>
+void PersistentAVL<T>::in_order(const Node* node, std::vector<T>& result) {
+    if (!node) return;
+    in_order(node->left, result);
+    result.push_back(node->data);
+    in_order(node->right, result);
+}
+
+template <class T>
+void PersistentAVL<T>::pre_order(const Node* node, std::vector<T>& result) {
+    if (!node) return;
+    result.push_back(node->data);
+    pre_order(node->left, result);
+    pre_order(node->right, result);
+}
+
+template <class T>
+void PersistentAVL<T>::post_order(const Node* node, std::vector<T>& result) {
+    if (!node) return;
+    post_order(node->left, result);
+    post_order(node->right, result);
+    result.push_back(node->data);
+}
+
+template <class T>
+std::pair<bool, int> PersistentAVL<T>::is_balanced(const Node* node) {
+    if (!node) return {true, 0};
+    auto left = is_balanced(node->left);
+    auto right = is_balanced(node->right);
+    bool balanced = left.first && right.first &&
+                    std::abs(left.second - right.second) <= 1;
+    return {balanced, std::max(left.second, right.second) + 1};
+}
+
+template <class T>
+std::vector<T> PersistentAVL<T>::in_order() const {
+    std::vector<T> result;
+    in_order(root, result);
+    return result;
+}
+
+template <class T>
+std::vector<T> PersistentAVL<T>::pre_order() const {
+    std::vector<T> result;
+    pre_order(root, result);
+    return result;
+}
+
+template <class T>
+std::vector<T> PersistentAVL<T>::post_order() const {
+    std::vector<T> result;
+    post_order(root, result);
+    return result;
+}
+
+template <class T>
+std::vector<T> PersistentAVL<T>::Snapshot::in_order() const {
+    std::vector<T> result;
+    PersistentAVL::in_order(root, result);
+    return result;
+}
+
+template <class T>
+std::vector<T> PersistentAVL<T>::Snapshot::pre_order() const {
+    std::vector<T> result;
+    PersistentAVL::pre_order(root, result);
+    return result;
+}
+
+template <class T>
+std::vector<T> PersistentAVL<T>::Snapshot::post_order() const {
+    std::vector<T> result;
+    PersistentAVL::post_order(root, result);
+    return result;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+/**
+ * @brief Pede ao processador que traga para o cache a linha de `address`,
+ * sem esperar por ela.
+ *
+ * Usado pelas buscas em lote: o endereço do próximo nó de cada descida é
+ * pedido antes de avançar as demais, e as faltas de cache se sobrepõem.
+ * Não tem efeito em compiladores sem `__builtin_prefetch`.
+ */
+inline void prefetch_read(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(address, 0, 3);
+#else
+  (void)address;
+#endif
+}
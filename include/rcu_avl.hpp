@@ -0,0 +1,452 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "epoch.hpp"
+
+/**
+ * @brief Árvore AVL com publicação no estilo RCU (read-copy-update).
+ *
+ * Cada versão publicada da árvore é imutável. Leitores carregam a raiz com
+ * uma leitura atômica e percorrem a versão sem qualquer trava; escritores
+ * (serializados entre si por um mutex) copiam apenas os O(log n) nós do
+ * caminho que alteram, publicam a nova raiz com um único store atômico e
+ * aposentam os nós substituídos num `EpochDomain`, que os libera quando os
+ * leitores da versão antiga terminam.
+ *
+ * @tparam T Tipo dos elementos. Deve suportar o operador '<'.
+ */
+template <class T>
+class RcuAVL {
+ private:
+  /**
+   * @brief Nó imutável depois de publicado.
+   */
+  struct Node {
+    T data;              ///< Valor armazenado no nó.
+    const Node* left;    ///< Filho à esquerda.
+    const Node* right;   ///< Filho à direita.
+    int height;          ///< Altura do nó (folha = 1).
+    std::uint64_t version;  ///< Escrita que criou o nó.
+
+    Node(const T& value, const Node* l, const Node* r, std::uint64_t v)
+        : data(value), left(l), right(r), height(1), version(v) {}
+  };
+
+  static int height(const Node* node) { return node ? node->height : 0; }
+
+  static void update(Node* node) {
+    node->height = std::max(height(node->left), height(node->right)) + 1;
+  }
+
+  /**
+   * @brief Retorna uma versão mutável de `node` para a escrita corrente.
+   *
+   * Nós criados pela escrita corrente ainda não foram publicados e podem ser
+   * alterados diretamente; os demais são copiados e o original é marcado
+   * para aposentadoria.
+   */
+  Node* own(const Node* node);
+
+  /**
+   * @brief Cria um nó da escrita corrente, registrado em `created`.
+   */
+  Node* fresh(const T& value, const Node* left, const Node* right);
+
+  Node* rotate_left(Node* node);
+  Node* rotate_right(Node* node);
+
+  /**
+   * @brief Recalcula a altura e rebalanceia um nó da escrita corrente.
+   *
+   * @return Nova raiz da subárvore.
+   */
+  Node* balance(Node* node);
+
+  const Node* insert(const Node* node, const T& value, bool assign,
+                     bool& changed);
+  const Node* remove(const Node* node, const T& value, bool& removed);
+  const Node* remove_min(const Node* node, const Node*& min);
+  static const Node* find(const Node* node, const T& value);
+
+  /**
+   * @brief Publica a nova raiz e aposenta os nós substituídos.
+   *
+   * Só pode lançar antes de publicar; a partir do store da raiz, os nós de
+   * `created` já não são da escrita corrente e nunca são liberados por ela.
+   */
+  void publish(const Node* next);
+
+  /**
+   * @brief Executa uma escrita sob o mutex dos escritores.
+   *
+   * Se `body` lançar uma exceção antes de publicar, os nós criados pela
+   * escrita são apagados e a lista de substituídos é esvaziada (esses nós
+   * continuam publicados), e a exceção é propagada; a versão publicada não
+   * muda.
+   */
+  template <class F>
+  bool write(F&& body);
+
+  static void destroy(const Node* node);
+  static void in_order(const Node* node, std::vector<T>& result);
+  static std::pair<bool, int> is_balanced(const Node* node);
+
+ public:
+  /**
+   * @brief Construtor da árvore (inicialmente vazia).
+   */
+  RcuAVL();
+
+  /**
+   * @brief Destrutor; não pode haver leitores ou escritores ativos.
+   */
+  ~RcuAVL();
+
+  RcuAVL(const RcuAVL&) = delete;
+  RcuAVL& operator=(const RcuAVL&) = delete;
+
+  /**
+   * @brief Insere um valor, publicando uma nova versão.
+   *
+   * @param value Valor a ser inserido.
+   * @return `true` se inserido, `false` se um valor equivalente já existia.
+   */
+  bool insert(const T& value);
+
+  /**
+   * @brief Insere um valor ou substitui o valor equivalente já existente.
+   *
+   * @param value Valor a ser gravado.
+   * @return `true` se inserido, `false` se substituiu um valor existente.
+   */
+  bool insert_or_assign(const T& value);
+
+  /**
+   * @brief Remove um valor, publicando uma nova versão.
+   *
+   * @param value Valor a ser removido.
+   * @return `true` se removido, `false` se não estava presente.
+   */
+  bool remove(const T& value);
+
+  /**
+   * @brief Verifica se um valor está presente, sem travas.
+   *
+   * @param value Valor a ser buscado.
+   * @return `true` se presente na versão publicada no início da busca.
+   */
+  bool contain(const T& value) const;
+
+  /**
+   * @brief Busca um valor e, se encontrado, chama `f` com o elemento.
+   *
+   * O elemento só é válido durante a chamada de `f`; copie o que precisar.
+   *
+   * @param value Valor a ser buscado.
+   * @param f Função chamada como `f(const T&)`.
+   * @return `true` se o valor foi encontrado.
+   */
+  template <class F>
+  bool visit(const T& value, F&& f) const;
+
+  /**
+   * @brief Retorna os valores de uma única versão em ordem.
+   */
+  std::vector<T> in_order() const;
+
+  /**
+   * @brief Verifica a propriedade AVL na versão publicada.
+   */
+  bool is_balanced() const;
+
+ private:
+  std::atomic<const Node*> root;  ///< Raiz da versão publicada.
+  std::mutex writer;              ///< Serializa os escritores.
+  mutable EpochDomain domain;     ///< Libera os nós substituídos.
+  std::uint64_t version;          ///< Identificador da escrita corrente.
+  std::vector<const Node*> replaced;  ///< Nós substituídos na escrita.
+  std::vector<Node*> created;         ///< Nós criados pela escrita.
+};
+
+template <class T>
+RcuAVL<T>::RcuAVL() : root(nullptr), version(1) {}
+
+template <class T>
+RcuAVL<T>::~RcuAVL() {
+    destroy(root.load());
+}
+
+template <class T>
+void RcuAVL<T>::destroy(const Node* node) {
+    if (!node) return;
+    destroy(node->left);
+    destroy(node->right);
+    delete node;
+}
+
+template <class T>
+typename RcuAVL<T>::Node* RcuAVL<T>::own(const Node* node) {
+    if (node->version == version) {
+        return const_cast<Node*>(node);
+    }
+    replaced.push_back(node);
+    Node* copy = fresh(node->data, node->left, node->right);
+    copy->height = node->height;
+    return copy;
+}
+
+template <class T>
+typename RcuAVL<T>::Node* RcuAVL<T>::fresh(const T& value, const Node* left,
+                                           const Node* right) {
+    created.push_back(nullptr);
+    created.back() = new Node(value, left, right, version);
+    return created.back();
+}
+
+template <class T>
+typename RcuAVL<T>::Node* RcuAVL<T>::rotate_left(Node* node) {
+    Node* rightChild = own(node->right);
+    node->right = rightChild->left;
+    rightChild->left = node;
+    update(node);
+    update(rightChild);
+    return rightChild;
+}
+
+template <class T>
+typename RcuAVL<T>::Node* RcuAVL<T>::rotate_right(Node* node) {
+    Node* leftChild = own(node->left);
+    node->left = leftChild->right;
+    leftChild->right = node;
+    update(node);
+    update(leftChild);
+    return leftChild;
+}
+
+template <class T>
+typename RcuAVL<T>::Node* RcuAVL<T>::balance(Node* node) {
+    update(node);
+    int balanceFactor = height(node->left) - height(node->right);
+
+    if (balanceFactor > 1) {
+        if (height(node->left->right) > height(node->left->left)) {
+            node->left = rotate_left(own(node->left));
+        }
+        return rotate_right(node);
+    }
+    if (balanceFactor < -1) {
+        if (height(node->right->left) > height(node->right->right)) {
+            node->right = rotate_right(own(node->right));
+        }
+        return rotate_left(node);
+    }
+    return node;
+}
+
+template <class T>
+const typename RcuAVL<T>::Node* RcuAVL<T>::insert(const Node* node,
+                                                  const T& value, bool assign,
+                                                  bool& changed) {
+    if (!node) {
+        changed = true;
+        return fresh(value, nullptr, nullptr);
+    }
+
+    if (value < node->data) {
+        const Node* left = insert(node->left, value, assign, changed);
+        if (!changed) return node;
+        Node* copy = own(node);
+        copy->left = left;
+        return balance(copy);
+    }
+    if (node->data < value) {
+        const Node* right = insert(node->right, value, assign, changed);
+        if (!changed) return node;
+        Node* copy = own(node);
+        copy->right = right;
+        return balance(copy);
+    }
+    if (!assign) return node;
+
+    changed = true;
+    Node* copy = own(node);
+    copy->data = value;
+    return copy;
+}
+
+template <class T>
+const typename RcuAVL<T>::Node* RcuAVL<T>::remove_min(const Node* node,
+                                                      const Node*& min) {
+    if (!node->left) {
+        min = node;
+        return node->right;
+    }
+    const Node* left = remove_min(node->left, min);
+    Node* copy = own(node);
+    copy->left = left;
+    return balance(copy);
+}
+
+template <class T>
+const typename RcuAVL<T>::Node* RcuAVL<T>::remove(const Node* node,
+                                                  const T& value,
+                                                  bool& removed) {
+    if (!node) return nullptr;
+
+    if (value < node->data) {
+        const Node* left = remove(node->left, value, removed);
+        if (!removed) return node;
+        Node* copy = own(node);
+        copy->left = left;
+        return balance(copy);
+    }
+    if (node->data < value) {
+        const Node* right = remove(node->right, value, removed);
+        if (!removed) return node;
+        Node* copy = own(node);
+        copy->right = right;
+        return balance(copy);
+    }
+
+    removed = true;
+    replaced.push_back(node);
+    if (!node->left) return node->right;
+    if (!node->right) return node->left;
+
+    const Node* min = nullptr;
+    const Node* right = remove_min(node->right, min);
+    Node* successor = own(min);
+    successor->left = node->left;
+    successor->right = right;
+    return balance(successor);
+}
+
+template <class T>
+void RcuAVL<T>::publish(const Node* next) {
+    // Única etapa que pode lançar, ainda antes de os nós novos ficarem
+    // visíveis; depois do store eles pertencem aos leitores.
+    domain.reserve(replaced.size());
+    root.store(next, std::memory_order_release);
+    created.clear();
+    ++version;
+    for (const Node* node : replaced) {
+        domain.retire(const_cast<Node*>(node));
+    }
+    replaced.clear();
+}
+
+template <class T>
+template <class F>
+bool RcuAVL<T>::write(F&& body) {
+    std::lock_guard<std::mutex> lock(writer);
+    try {
+        return body();
+    } catch (...) {
+        for (Node* node : created) delete node;
+        created.clear();
+        replaced.clear();
+        throw;
+    }
+}
+
+template <class T>
+bool RcuAVL<T>::insert(const T& value) {
+    return write([&] {
+        bool changed = false;
+        const Node* next = insert(root.load(), value, false, changed);
+        if (changed) publish(next);
+        return changed;
+    });
+}
+
+template <class T>
+bool RcuAVL<T>::insert_or_assign(const T& value) {
+    return write([&] {
+        bool changed = false;
+        const Node* current = root.load();
+        bool existed = find(current, value) != nullptr;
+        const Node* next = insert(current, value, true, changed);
+        publish(next);
+        return !existed;
+    });
+}
+
+template <class T>
+bool RcuAVL<T>::remove(const T& value) {
+    return write([&] {
+        bool removed = false;
+        const Node* next = remove(root.load(), value, removed);
+        if (removed) publish(next);
+        return removed;
+    });
+}
+
+template <class T>
+const typename RcuAVL<T>::Node* RcuAVL<T>::find(const Node* node,
+                                                const T& value) {
+    while (node) {
+        if (value < node->data) {
+            node = node->left;
+        } else if (node->data < value) {
+            node = node->right;
+        } else {
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+template <class T>
+bool RcuAVL<T>::contain(const T& value) const {
+    auto guard = domain.pin();
+    return find(root.load(std::memory_order_acquire), value) != nullptr;
+}
+
+template <class T>
+template <class F>
+bool RcuAVL<T>::visit(const T& value, F&& f) const {
+    auto guard = domain.pin();
+    const Node* node = find(root.load(std::memory_order_acquire), value);
+    if (!node) return false;
+    f(node->data);
+    return true;
+}
+
+template <class T>
+void RcuAVL<T>::in_order(const Node* node, std::vector<T>& result) {
+    if (!node) return;
+    in_order(node->left, result);
+    result.push_back(node->data);
+    in_order(node->right, result);
+}
+
+template <class T>
+std::vector<T> RcuAVL<T>::in_order() const {
+    auto guard = domain.pin();
+    std::vector<T> result;
+    in_order(root.load(std::memory_order_acquire), result);
+    return result;
+}
+
+template <class T>
+std::pair<bool, int> RcuAVL<T>::is_balanced(const Node* node) {
+    if (!node) return {true, 0};
+    auto left = is_balanced(node->left);
+    auto right = is_balanced(node->right);
+    bool balanced = left.first && right.first &&
+                    std::abs(left.second - right.second) <= 1 &&
+                    node->height == std::max(left.second, right.second) + 1;
+    return {balanced, std::max(left.second, right.second) + 1};
+}
+
+template <class T>
+bool RcuAVL<T>::is_balanced() const {
+    auto guard = domain.pin();
+    return is_balanced(root.load(std::memory_order_acquire)).first;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <stdexcept>
+
+#include "rcu_avl.hpp"
+
+/**
+ * @brief Mapa Associativo com leituras sem trava sobre versões imutáveis.
+ *
+ * Variante de `Map` para cargas dominadas por leituras. Como as versões
+ * publicadas são imutáveis, não há `operator[]` que devolva referência
+ * mutável: escritas usam `assign` e `remove`, e as leituras (`operator[]`
+ * constante e `contains`) devolvem cópias obtidas sem travas.
+ *
+ * @tparam K Tipo da chave. Deve suportar o operadores de comparação '<'.
+ * @tparam V Tipo do valor associado à chave. Deve ser copiável e ter
+ * construtor padrão.
+ */
+template <class K, class V>
+class RcuMap {
+ private:
+  /**
+   * @brief Par chave-valor ordenado apenas pela chave.
+   */
+  struct Pair {
+    K key;    ///< A chave única.
+    V value;  ///< O valor associado.
+
+    explicit Pair(const K& k) : key(k), value() {}
+    Pair(const K& k, const V& v) : key(k), value(v) {}
+
+    bool operator<(const Pair& other) const { return key < other.key; }
+  };
+
+ public:
+  /**
+   * @brief Construtor padrão.
+   * Cria um mapa vazio.
+   */
+  RcuMap();
+
+  /**
+   * @brief Associa `value` à chave, inserindo-a se necessário.
+   *
+   * @param key A chave.
+   * @param value O valor a ser gravado.
+   * @return `true` se a chave foi inserida, `false` se já existia e teve o
+   * valor substituído.
+   */
+  bool assign(const K& key, const V& value);
+
+  /**
+   * @brief Retorna uma cópia do valor associado a uma chave, sem travas.
+   *
+   * @param key A chave para buscar.
+   * @return Cópia do valor associado à chave.
+   * @throw std::out_of_range se a chave não for encontrada.
+   */
+  V operator[](const K& key) const;
+
+  /**
+   * @brief Verifica se a chave está presente, sem travas.
+   */
+  bool contains(const K& key) const;
+
+  /**
+   * @brief Remove um par chave-valor do mapa.
+   *
+   * @param key A chave do elemento a ser removido.
+   * @return `true` se o elemento foi encontrado e removido, `false` caso
+   * contrário.
+   */
+  bool remove(const K& key);
+
+ private:
+  RcuAVL<Pair> data;  ///< Árvore com versões imutáveis dos pares.
+};
+
+template <class K, class V>
+RcuMap<K, V>::RcuMap() {}
+
+template <class K, class V>
+bool RcuMap<K, V>::assign(const K& key, const V& value) {
+  return data.insert_or_assign(Pair(key, value));
+}
+
+template <class K, class V>
+V RcuMap<K, V>::operator[](const K& key) const {
+  V result;
+  if (!data.visit(Pair(key), [&](const Pair& pair) { result = pair.value; })) {
+    throw std::out_of_range("chave não encontrada no Map");
+  }
+  return result;
+}
+
+template <class K, class V>
+bool RcuMap<K, V>::contains(const K& key) const {
+  return data.contain(Pair(key));
+}
+
+template <class K, class V>
+bool RcuMap<K, V>::remove(const K& key) {
+  return data.remove(Pair(key));
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <vector>
+
+#include "rcu_avl.hpp"
+
+/**
+ * @brief Conjunto (Set) com leituras sem trava sobre versões imutáveis.
+ *
+ * Variante de `Set` para cargas dominadas por leituras: `search` apenas lê
+ * atomicamente a raiz publicada e percorre uma versão imutável, sem bloquear
+ * nem ser bloqueado por escritores. `insert` e `remove` são serializados,
+ * copiam o caminho alterado e publicam uma nova versão.
+ *
+ * @tparam T Tipo dos elementos a serem armazenados no conjunto.
+ * O tipo T deve suportar o operadores de '<'.
+ */
+template <class T>
+class RcuSet {
+ public:
+  /**
+   * @brief Construtor padrão.
+   * * Cria um conjunto vazio.
+   */
+  RcuSet();
+
+  /**
+   * @brief Insere um elemento no conjunto.
+   *
+   * @param value O valor a ser inserido.
+   * @return `true` se o elemento foi inserido com sucesso (não existia antes),
+   * `false` se o elemento já existe no conjunto.
+   */
+  bool insert(const T& value);
+
+  /**
+   * @brief Remove um elemento do conjunto.
+   *
+   * @param value O valor a ser removido.
+   * @return `true` se o elemento foi removido com sucesso,
+   * `false` se o elemento não foi encontrado no conjunto.
+   */
+  bool remove(const T& value);
+
+  /**
+   * @brief Verifica se um elemento está contido no conjunto, sem travas.
+   *
+   * @param value O valor a ser buscado.
+   * @return `true` se o elemento estiver presente na versão lida,
+   * `false` caso contrário.
+   */
+  bool search(const T& value) const;
+
+  /**
+   * @brief Retorna os elementos de uma única versão, em ordem.
+   */
+  std::vector<T> in_order() const;
+
+ private:
+  RcuAVL<T> data;  ///< Árvore com versões imutáveis.
+};
+
+template <class T>
+RcuSet<T>::RcuSet() {}
+
+template <class T>
+bool RcuSet<T>::insert(const T& value) {
+  return data.insert(value);
+}
+
+template <class T>
+bool RcuSet<T>::remove(const T& value) {
+  return data.remove(value);
+}
+
+template <class T>
+bool RcuSet<T>::search(const T& value) const {
+  return data.contain(value);
+}
+
+template <class T>
+std::vector<T> RcuSet<T>::in_order() const {
+  return data.in_order();
+}
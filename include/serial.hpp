@@ -0,0 +1,427 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief CRC-32 (polinômio IEEE 802.3, refletido) de um bloco de bytes.
+ *
+ * @param data Início do bloco.
+ * @param size Tamanho em bytes.
+ * @param crc Valor anterior, para calcular o CRC de blocos em sequência.
+ * @return CRC acumulado.
+ */
+inline std::uint32_t crc32(const void* data, std::size_t size,
+                           std::uint32_t crc = 0) {
+  struct Table {
+    std::uint32_t entries[256];
+    Table() {
+      for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t c = i;
+        for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        entries[i] = c;
+      }
+    }
+  };
+  static const Table table;
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  crc = ~crc;
+  for (std::size_t i = 0; i < size; ++i) {
+    crc = table.entries[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+/**
+ * @brief Bytes que ainda podem ser lidos de `in`.
+ *
+ * Usado para validar tamanhos lidos de arquivos antes de alocar memória.
+ *
+ * @return Bytes restantes, ou o maior `std::uint64_t` se o fluxo não permitir
+ * reposicionamento.
+ */
+inline std::uint64_t remaining_bytes(std::istream& in) {
+  const std::uint64_t unknown = std::numeric_limits<std::uint64_t>::max();
+  std::streambuf* buffer = in.rdbuf();
+  if (!in || !buffer) return unknown;
+  std::streampos here = buffer->pubseekoff(0, std::ios::cur, std::ios::in);
+  if (here == std::streampos(-1)) return unknown;
+  std::streampos end = buffer->pubseekoff(0, std::ios::end, std::ios::in);
+  buffer->pubseekpos(here, std::ios::in);
+  if (end == std::streampos(-1) || end < here) return unknown;
+  return static_cast<std::uint64_t>(end - here);
+}
+
+/**
+ * @brief Codificação binária de um tipo para os snapshots das estruturas.
+ *
+ * Tipos trivialmente copiáveis são gravados como vetores brutos (cópia de
+ * memória, ordem de bytes da máquina). `std::string` é gravada com prefixo de
+ * tamanho. Outros tipos podem especializar `BinaryCodec` fornecendo `raw`,
+ * `write` e `read` com as mesmas assinaturas.
+ *
+ * @tparam T Tipo a ser codificado.
+ */
+template <class T, class Enable = void>
+struct BinaryCodec;
+
+template <class T>
+struct BinaryCodec<T, std::enable_if_t<std::is_trivially_copyable<T>::value>> {
+  static constexpr bool raw = true;  ///< Gravado como vetor bruto.
+
+  static void write(std::ostream& out, const T* values, std::size_t n) {
+    out.write(reinterpret_cast<const char*>(values),
+              static_cast<std::streamsize>(n * sizeof(T)));
+  }
+
+  static void read(std::istream& in, T* values, std::size_t n) {
+    in.read(reinterpret_cast<char*>(values),
+            static_cast<std::streamsize>(n * sizeof(T)));
+  }
+};
+
+template <>
+struct BinaryCodec<std::string> {
+  static constexpr bool raw = false;  ///< Gravado com prefixo de tamanho.
+  static constexpr std::uint64_t kSmall = 4096;  ///< Lido sem verificar o fluxo.
+
+  static void write(std::ostream& out, const std::string* values,
+                    std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      std::uint64_t size = values[i].size();
+      out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+      out.write(values[i].data(), static_cast<std::streamsize>(size));
+    }
+  }
+
+  static void read(std::istream& in, std::string* values, std::size_t n) {
+    for (std::size_t i = 0; i < n && in; ++i) {
+      std::uint64_t size = 0;
+      in.read(reinterpret_cast<char*>(&size), sizeof(size));
+      if (!in) return;
+      // O tamanho vem do arquivo: só aloca o que o fluxo ainda pode conter.
+      if (size > kSmall && size > remaining_bytes(in)) {
+        in.setstate(std::ios::failbit);
+        return;
+      }
+      values[i].resize(static_cast<std::size_t>(size));
+      in.read(&values[i][0], static_cast<std::streamsize>(size));
+    }
+  }
+};
+
+/**
+ * @brief Cabeçalho versionado dos snapshots binários de `Set` e `Map`.
+ *
+ * Formato (ordem de bytes da máquina que gravou):
+ * - `magic` "EDSN", `version` (u16), `kind` (u8), `flags` (u8);
+ * - `key_size` e `value_size` (u32, 0 para tipos com prefixo de tamanho);
+ * - `block` (u32) e `count` (u64).
+ *
+ * Os elementos seguem em blocos de até `block` elementos: primeiro as chaves
+ * do bloco e, para mapas, depois os valores do mesmo bloco. Assim cada bloco
+ * é um par de vetores brutos quando os tipos são trivialmente copiáveis, e a
+ * leitura pode reconstruir a árvore em fluxo, sem carregar tudo antes.
+ */
+struct SnapshotHeader {
+  static constexpr char kMagic[4] = {'E', 'D', 'S', 'N'};
+  static constexpr std::uint16_t kVersion = 1;
+  static constexpr std::uint32_t kBlock = 4096;
+
+  enum Kind : std::uint8_t {
+    kSet = 1,    ///< Conjunto em ordem.
+    kMap = 2,    ///< Mapa em ordem.
+    kShape = 3,  ///< Árvore em pré-ordem com bits de forma.
+  };
+  enum Flags : std::uint8_t {
+    kRawKeys = 1,     ///< Chaves gravadas como vetores brutos.
+    kRawValues = 2,   ///< Valores gravados como vetores brutos.
+    kBigEndian = 4,   ///< Gravado numa máquina big-endian.
+  };
+
+  std::uint8_t kind = 0;
+  std::uint8_t flags = 0;
+  std::uint32_t key_size = 0;
+  std::uint32_t value_size = 0;
+  std::uint32_t block = kBlock;
+  std::uint64_t count = 0;
+
+  /**
+   * @brief Indica se esta máquina é big-endian.
+   */
+  static bool big_endian() {
+    const std::uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 0;
+  }
+
+  /**
+   * @brief Monta o cabeçalho esperado para chaves `K` e valores `V`.
+   *
+   * @tparam K Tipo das chaves.
+   * @tparam V Tipo dos valores, ou `void` para conjuntos.
+   */
+  template <class K, class V = void>
+  static SnapshotHeader make(Kind kind, std::uint64_t count) {
+    SnapshotHeader header;
+    header.kind = kind;
+    header.count = count;
+    if (BinaryCodec<K>::raw) {
+      header.flags |= kRawKeys;
+      header.key_size = sizeof(K);
+    }
+    if constexpr (!std::is_void<V>::value) {
+      if (BinaryCodec<V>::raw) {
+        header.flags |= kRawValues;
+        header.value_size = sizeof(V);
+      }
+    }
+    if (big_endian()) header.flags |= kBigEndian;
+    return header;
+  }
+
+  /**
+   * @brief Quantidade de bytes gravados por `write`.
+   */
+  static constexpr std::size_t encoded_size() {
+    return sizeof(kMagic) + sizeof(kVersion) + sizeof(kind) + sizeof(flags) +
+           sizeof(key_size) + sizeof(value_size) + sizeof(block) + sizeof(count);
+  }
+
+  /**
+   * @brief Grava o cabeçalho.
+   */
+  void write(std::ostream& out) const {
+    out.write(kMagic, sizeof(kMagic));
+    put(out, kVersion);
+    put(out, kind);
+    put(out, flags);
+    put(out, key_size);
+    put(out, value_size);
+    put(out, block);
+    put(out, count);
+  }
+
+  /**
+   * @brief Lê um cabeçalho e confere se é compatível com `expected`.
+   *
+   * @param in Fluxo de entrada.
+   * @param expected Cabeçalho montado com `make` para os tipos de destino;
+   * seu `count` é ignorado.
+   * @return Cabeçalho lido.
+   * @throw std::runtime_error se o fluxo não contiver um snapshot compatível.
+   */
+  static SnapshotHeader read(std::istream& in, const SnapshotHeader& expected) {
+    char magic[sizeof(kMagic)];
+    in.read(magic, sizeof(magic));
+    std::uint16_t version = 0;
+    SnapshotHeader header;
+    get(in, version);
+    get(in, header.kind);
+    get(in, header.flags);
+    get(in, header.key_size);
+    get(in, header.value_size);
+    get(in, header.block);
+    get(in, header.count);
+
+    if (!in || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+      throw std::runtime_error("snapshot inválido: cabeçalho ausente");
+    }
+    if (version != kVersion) {
+      throw std::runtime_error("snapshot inválido: versão não suportada");
+    }
+    if (header.kind != expected.kind || header.flags != expected.flags ||
+        header.key_size != expected.key_size ||
+        header.value_size != expected.value_size || header.block == 0 ||
+        header.block > kBlock) {
+      throw std::runtime_error("snapshot inválido: tipos incompatíveis");
+    }
+    return header;
+  }
+
+  /**
+   * @brief Limita `count` ao número de elementos que ainda cabem em `in`.
+   *
+   * Para reservar memória a partir de um cabeçalho não confiável: um `count`
+   * corrompido não deve provocar uma alocação maior que o próprio arquivo.
+   * Em fluxos sem reposicionamento, o limite é um bloco.
+   */
+  std::size_t reserve_hint(std::istream& in) const {
+    std::uint64_t record = key_size ? key_size : sizeof(std::uint64_t);
+    if (kind != kSet) record += value_size ? value_size : sizeof(std::uint64_t);
+    std::uint64_t bytes = remaining_bytes(in);
+    std::uint64_t fits = bytes == std::numeric_limits<std::uint64_t>::max()
+                             ? block
+                             : bytes / record;
+    return static_cast<std::size_t>(count < fits ? count : fits);
+  }
+
+  template <class U>
+  static void put(std::ostream& out, const U& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(U));
+  }
+
+  template <class U>
+  static void get(std::istream& in, U& value) {
+    in.read(reinterpret_cast<char*>(&value), sizeof(U));
+  }
+};
+
+/**
+ * @brief Lê os blocos de um snapshot um elemento por vez.
+ *
+ * Usado como gerador por `assign_sorted` das árvores: cada chamada devolve o
+ * próximo elemento e, por padrão, verifica se a sequência é estritamente
+ * crescente.
+ *
+ * @tparam K Tipo das chaves.
+ * @tparam V Tipo dos valores, ou `void` para conjuntos.
+ */
+template <class K, class V = void>
+class SnapshotReader {
+ public:
+  /**
+   * @param in Fluxo posicionado após o cabeçalho.
+   * @param header Cabeçalho lido.
+   * @param ordered Se as chaves devem estar em ordem estritamente crescente
+   * (`false` para sequências em pré-ordem).
+   */
+  SnapshotReader(std::istream& in, const SnapshotHeader& header,
+                 bool ordered = true)
+      : in(in), header(header), remaining(header.count), position(0),
+        ordered(ordered) {}
+
+  /**
+   * @brief Avança para o próximo elemento.
+   *
+   * @throw std::runtime_error se o fluxo terminar antes do esperado ou se as
+   * chaves não estiverem em ordem estritamente crescente.
+   */
+  void advance() {
+    if (position == keys.size()) fill();
+    if (!ordered) {
+      ++position;
+      return;
+    }
+    const K* previous = position > 0 ? &keys[position - 1]
+                                     : (has_last ? &last : nullptr);
+    if (previous && !(*previous < keys[position])) {
+      throw std::runtime_error("snapshot inválido: chaves fora de ordem");
+    }
+    ++position;
+  }
+
+  /**
+   * @brief Chave do elemento atual (após `advance`).
+   */
+  const K& key() const { return keys[position - 1]; }
+
+  /**
+   * @brief Valor do elemento atual (após `advance`); apenas para mapas.
+   */
+  template <class U = V>
+  const U& value() const {
+    return values[position - 1];
+  }
+
+ private:
+  void fill() {
+    std::size_t n = static_cast<std::size_t>(
+        remaining < header.block ? remaining : header.block);
+    if (n == 0) {
+      throw std::runtime_error("snapshot inválido: elementos a mais");
+    }
+    if (!keys.empty()) {
+      last = keys.back();
+      has_last = true;
+    }
+    keys.assign(n, K());
+    BinaryCodec<K>::read(in, keys.data(), n);
+    if constexpr (!std::is_void<V>::value) {
+      values.assign(n, V());
+      BinaryCodec<V>::read(in, values.data(), n);
+    }
+    if (!in) {
+      throw std::runtime_error("snapshot inválido: fim inesperado");
+    }
+    remaining -= n;
+    position = 0;
+  }
+
+  using ValueStore =
+      std::vector<std::conditional_t<std::is_void<V>::value, char, V>>;
+
+  std::istream& in;
+  SnapshotHeader header;
+  std::uint64_t remaining;   ///< Elementos ainda não lidos do fluxo.
+  std::size_t position;      ///< Próximo elemento do bloco atual.
+  std::vector<K> keys;       ///< Chaves do bloco atual.
+  ValueStore values;         ///< Valores do bloco atual.
+  K last{};                  ///< Última chave do bloco anterior.
+  bool has_last = false;     ///< Se `last` é válida.
+  bool ordered;              ///< Se a ordem crescente é verificada.
+};
+
+/**
+ * @brief Grava os elementos de um snapshot em blocos.
+ *
+ * @tparam K Tipo das chaves.
+ * @tparam V Tipo dos valores, ou `void` para conjuntos.
+ */
+template <class K, class V = void>
+class SnapshotWriter {
+ public:
+  SnapshotWriter(std::ostream& out, const SnapshotHeader& header)
+      : out(out), block(header.block) {
+    keys.reserve(block);
+    if constexpr (!std::is_void<V>::value) values.reserve(block);
+  }
+
+  /**
+   * @brief Acrescenta uma chave (conjuntos).
+   */
+  void push(const K& key) {
+    keys.push_back(key);
+    if (keys.size() == block) flush();
+  }
+
+  /**
+   * @brief Acrescenta um par chave-valor (mapas).
+   */
+  template <class U = V>
+  void push(const K& key, const U& value) {
+    keys.push_back(key);
+    values.push_back(value);
+    if (keys.size() == block) flush();
+  }
+
+  /**
+   * @brief Grava o bloco parcial pendente.
+   */
+  void flush() {
+    if (keys.empty()) return;
+    BinaryCodec<K>::write(out, keys.data(), keys.size());
+    if constexpr (!std::is_void<V>::value) {
+      BinaryCodec<V>::write(out, values.data(), values.size());
+      values.clear();
+    }
+    keys.clear();
+  }
+
+ private:
+  using ValueStore =
+      std::vector<std::conditional_t<std::is_void<V>::value, char, V>>;
+
+  std::ostream& out;
+  std::size_t block;
+  std::vector<K> keys;
+  ValueStore values;
+};
@@ -1,5 +1,11 @@
 #pragma once
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
 #include "avl.hpp"
+#include "serial.hpp"
 
 /**
  * @brief Classe que representa um Conjunto (Set) baseado em uma Árvore AVL.
@@ -20,6 +26,16 @@ class Set {
    */
   Set();
 
+  /**
+   * @brief Troca o conteúdo com outro conjunto em O(1).
+   *
+   * Cópia e movimento são delegados à árvore: a cópia é profunda e o
+   * movimento custa O(1).
+   *
+   * @param other Conjunto com o qual o conteúdo será trocado.
+   */
+  void swap(Set& other) noexcept;
+
   /**
    * @brief Insere um elemento no conjunto.
    *
@@ -32,6 +48,25 @@ class Set {
    */
   bool insert(const T& value);
 
+  /// Posição guardada entre inserções próximas (ver `AVL::Finger`).
+  using Finger = typename AVL<T>::Finger;
+
+  /**
+   * @brief Insere um elemento partindo da posição guardada em `hint`, em
+   * O(1) amortizado para elementos próximos do anterior.
+   *
+   * @return `true` se o elemento foi inserido, `false` se já existia.
+   */
+  bool insert(Finger& hint, const T& value);
+
+  /**
+   * @brief Insere um elemento maior que todos os do conjunto, em O(1)
+   * amortizado (cargas em ordem crescente).
+   *
+   * @throw std::invalid_argument se `value` não for maior que o máximo.
+   */
+  void append_max(const T& value);
+
   /**
    * @brief Remove um elemento do conjunto.
    *
@@ -44,6 +79,26 @@ class Set {
    */
   bool remove(const T& value);
 
+  /**
+   * @brief Remove todos os elementos do intervalo [lo, hi), em O(log n) mais
+   * a liberação dos k elementos removidos (ver `AVL::erase_range`).
+   *
+   * @param lo Início do intervalo (incluído).
+   * @param hi Fim do intervalo (excluído).
+   * @return Quantidade de elementos removidos.
+   */
+  std::size_t erase_range(const T& lo, const T& hi);
+
+  /**
+   * @brief Move os elementos do intervalo [lo, hi) para um novo conjunto, sem
+   * copiá-los.
+   *
+   * @param lo Início do intervalo (incluído).
+   * @param hi Fim do intervalo (excluído).
+   * @return Conjunto com os elementos removidos.
+   */
+  Set extract_range(const T& lo, const T& hi);
+
   /**
    * @brief Verifica se um elemento está contido no conjunto.
    *
@@ -53,6 +108,117 @@ class Set {
    */
   bool search(const T& value) const;
 
+  /**
+   * @name Consultas por ordem
+   *
+   * Em O(log n), sem copiar: devolvem um ponteiro para o elemento guardado,
+   * válido até a próxima alteração do conjunto, ou `nullptr` se não houver
+   * (ver `AVL::lower_bound`).
+   * @{
+   */
+  const T* lower_bound(const T& value) const;  ///< Menor elemento >= `value`.
+  const T* upper_bound(const T& value) const;  ///< Menor elemento > `value`.
+  const T* ceiling(const T& value) const;      ///< Igual a `lower_bound`.
+  const T* floor(const T& value) const;        ///< Maior elemento <= `value`.
+  const T* successor(const T& value) const;    ///< Igual a `upper_bound`.
+  const T* predecessor(const T& value) const;  ///< Maior elemento < `value`.
+  const T* nearest(const T& value) const;      ///< Mais próximo; no empate, o menor.
+  /** @} */
+
+  /**
+   * @brief Verifica a presença de vários elementos de uma vez.
+   *
+   * As descidas avançam intercaladas em grupos, com prefetch do próximo nó
+   * de cada uma, sobrepondo as faltas de cache (ver `AVL::find_many`).
+   *
+   * @param values Valores buscados.
+   * @param n Quantidade de valores.
+   * @param found Recebe, para cada valor, se ele está presente.
+   * @return Quantidade de valores encontrados.
+   */
+  std::size_t contains_many(const T* values, std::size_t n, bool* found) const;
+
+  /**
+   * @brief Busca vários elementos de uma vez.
+   *
+   * @param values Valores buscados.
+   * @param n Quantidade de valores.
+   * @param found Recebe, para cada valor, um ponteiro para o elemento
+   * armazenado ou `nullptr` se ausente.
+   * @return Quantidade de valores encontrados.
+   */
+  std::size_t find_many(const T* values, std::size_t n, const T** found) const;
+
+  /**
+   * @brief Verifica a presença de um lote já ordenado numa única passada
+   * pela árvore, em O(k log(n/k)) para k valores (ver `AVL::search_sorted`).
+   *
+   * @param values Valores em ordem não decrescente.
+   * @param n Quantidade de valores.
+   * @param found Recebe, para cada valor, se ele está presente.
+   * @return Quantidade de valores encontrados.
+   * @throw std::invalid_argument se `values` não estiver ordenado.
+   */
+  std::size_t search_sorted(const T* values, std::size_t n, bool* found) const;
+
+  /**
+   * @brief Retorna a quantidade de elementos do conjunto.
+   */
+  std::size_t size() const;
+
+  /**
+   * @brief Visita os elementos em ordem crescente, sem copiá-los.
+   *
+   * @param f Função chamada como `f(const T&)`; se devolver `bool`, `false`
+   * interrompe a visita.
+   * @return `true` se todos os elementos foram visitados.
+   */
+  template <class F>
+  bool for_each(F&& f) const;
+
+  /**
+   * @brief Copia os elementos em ordem para `out` usando várias threads (ver
+   * `AVL::parallel_export`).
+   *
+   * @param out Buffer com pelo menos `size()` elementos já construídos.
+   * @param threads Quantidade de threads; 0 escolhe automaticamente.
+   * @return `out + size()`.
+   */
+  T* parallel_export(T* out, unsigned threads = 0) const;
+
+  /**
+   * @brief Grava o conjunto num snapshot binário versionado.
+   *
+   * Os elementos são gravados em ordem, em blocos (vetores brutos para tipos
+   * trivialmente copiáveis, prefixo de tamanho para os demais). Veja
+   * `SnapshotHeader`.
+   *
+   * @param out Fluxo binário de saída.
+   * @throw std::runtime_error se a escrita falhar.
+   */
+  void save(std::ostream& out) const;
+
+  /**
+   * @brief Substitui o conteúdo pelo de um snapshot gravado com `save`.
+   *
+   * Reconstrói uma AVL balanceada em O(n) diretamente do fluxo, sem descidas
+   * por chave. Em caso de erro o conjunto permanece inalterado.
+   *
+   * @param in Fluxo binário de entrada.
+   * @throw std::runtime_error se o snapshot for inválido ou incompatível.
+   */
+  void load(std::istream& in);
+
+  /**
+   * @brief Substitui o conteúdo por `n` elementos já ordenados, em O(n).
+   *
+   * @param n Quantidade de elementos.
+   * @param next Gerador chamado `n` vezes, devolvendo os elementos em ordem
+   * estritamente crescente.
+   */
+  template <class Generator>
+  void assign_sorted(std::size_t n, Generator&& next);
+
  private:
   /**
    * @brief A Árvore AVL utilizada para armazenar os dados do conjunto.
@@ -65,17 +231,150 @@ class Set {
 template <class T>
 Set<T>::Set() {}
 
+template <class T>
+void Set<T>::swap(Set& other) noexcept {
+  data.swap(other.data);
+}
+
+template <class T>
+void swap(Set<T>& a, Set<T>& b) noexcept {
+  a.swap(b);
+}
+
 template <class T>
 bool Set<T>::insert(const T& value) {
   return data.insert(value);
 }
 
+template <class T>
+bool Set<T>::insert(Finger& hint, const T& value) {
+  return data.insert(hint, value);
+}
+
+template <class T>
+void Set<T>::append_max(const T& value) {
+  data.append_max(value);
+}
+
 template <class T>
 bool Set<T>::remove(const T& value) {
   return data.remove(value);
 }
 
+template <class T>
+std::size_t Set<T>::erase_range(const T& lo, const T& hi) {
+  return data.erase_range(lo, hi);
+}
+
+template <class T>
+Set<T> Set<T>::extract_range(const T& lo, const T& hi) {
+  Set result;
+  result.data = data.extract_range(lo, hi);
+  return result;
+}
+
 template <class T>
 bool Set<T>::search(const T& value) const {
   return data.contain(value);
-}
\ No newline at end of file
+}
+
+template <class T>
+const T* Set<T>::lower_bound(const T& value) const {
+  return data.lower_bound(value);
+}
+
+template <class T>
+const T* Set<T>::upper_bound(const T& value) const {
+  return data.upper_bound(value);
+}
+
+template <class T>
+const T* Set<T>::ceiling(const T& value) const {
+  return data.ceiling(value);
+}
+
+template <class T>
+const T* Set<T>::floor(const T& value) const {
+  return data.floor(value);
+}
+
+template <class T>
+const T* Set<T>::successor(const T& value) const {
+  return data.successor(value);
+}
+
+template <class T>
+const T* Set<T>::predecessor(const T& value) const {
+  return data.predecessor(value);
+}
+
+template <class T>
+const T* Set<T>::nearest(const T& value) const {
+  return data.nearest(value);
+}
+
+template <class T>
+std::size_t Set<T>::contains_many(const T* values, std::size_t n,
+                                  bool* found) const {
+  return data.contains_many(values, n, found);
+}
+
+template <class T>
+std::size_t Set<T>::find_many(const T* values, std::size_t n,
+                              const T** found) const {
+  return data.find_many(values, n, found);
+}
+
+template <class T>
+std::size_t Set<T>::search_sorted(const T* values, std::size_t n,
+                                  bool* found) const {
+  return data.search_sorted(values, n, found);
+}
+
+template <class T>
+std::size_t Set<T>::size() const {
+  return data.size();
+}
+
+template <class T>
+template <class F>
+bool Set<T>::for_each(F&& f) const {
+  return data.for_each_in_order(std::forward<F>(f));
+}
+
+template <class T>
+T* Set<T>::parallel_export(T* out, unsigned threads) const {
+  return data.parallel_export(out, threads);
+}
+
+template <class T>
+void Set<T>::save(std::ostream& out) const {
+  SnapshotHeader header =
+      SnapshotHeader::make<T>(SnapshotHeader::kSet, data.size());
+  header.write(out);
+  SnapshotWriter<T> writer(out, header);
+  data.for_each_in_order([&writer](const T& value) { writer.push(value); });
+  writer.flush();
+  if (!out) throw std::runtime_error("falha ao gravar snapshot do Set");
+}
+
+template <class T>
+void Set<T>::load(std::istream& in) {
+  SnapshotHeader header =
+      SnapshotHeader::read(in, SnapshotHeader::make<T>(SnapshotHeader::kSet, 0));
+  SnapshotReader<T> reader(in, header);
+  AVL<T> loaded;
+  loaded.assign_sorted(header.count, [&] {
+    reader.advance();
+    return reader.key();
+  });
+  data.swap(loaded);
+}
+
+template <class T>
+template <class Generator>
+void Set<T>::assign_sorted(std::size_t n, Generator&& next) {
+  AVL<T> built;
+  built.assign_sorted(n, next);
+  data.swap(built);
+}
@@ -0,0 +1,527 @@
+#pragma once
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Mapa associativo num segmento de memória compartilhada POSIX,
+ * acessível por vários processos.
+ *
+ * Os nós (uma AVL) ficam dentro do segmento e se referem uns aos outros por
+ * deslocamentos a partir do início do segmento, não por ponteiros, então
+ * cada processo pode mapeá-lo em qualquer endereço. Um processo escritor
+ * mantém o mapa e os demais o leem diretamente da mesma memória física,
+ * sem cópias.
+ *
+ * O acesso é protegido por um `pthread_rwlock_t` com
+ * `PTHREAD_PROCESS_SHARED` guardado no próprio segmento: leituras
+ * concorrentes entre si, escritas exclusivas. O travamento não é robusto:
+ * um processo que morra no meio de uma operação deixa o lock preso.
+ *
+ * O segmento tem capacidade fixa, escolhida por quem o cria; nós removidos
+ * vão para uma lista livre e são reaproveitados. Chave e valor precisam ser
+ * trivialmente copiáveis (nada de ponteiros para a memória de um processo).
+ *
+ * @tparam K Tipo da chave: trivialmente copiável, com '<'.
+ * @tparam V Tipo do valor: trivialmente copiável.
+ */
+template <class K, class V>
+class SharedMap {
+  static_assert(std::is_trivially_copyable<K>::value &&
+                    std::is_trivially_copyable<V>::value,
+                "SharedMap exige chave e valor trivialmente copiáveis");
+
+ public:
+  /**
+   * @brief Referência a um valor do mapa, devolvida por `operator[]`.
+   *
+   * Outro processo pode alterar o mapa entre duas operações, então o valor
+   * não é exposto por ponteiro: a leitura e a atribuição refazem a busca sob
+   * o lock. Nada é inserido antes disso: a atribuição grava o valor numa
+   * única operação, de modo que outros leitores nunca veem um `V()`
+   * provisório, e a leitura de uma chave ausente insere `V()`.
+   */
+  class Reference {
+   public:
+    operator V() const { return map->fetch(key); }
+
+    Reference& operator=(const V& value) {
+      map->put(key, value, true);
+      return *this;
+    }
+
+    Reference& operator=(const Reference& other) { return *this = V(other); }
+
+   private:
+    friend class SharedMap;
+    Reference(SharedMap* m, const K& k) : map(m), key(k) {}
+
+    SharedMap* map;
+    K key;
+  };
+
+  /**
+   * @brief Cria o segmento `name` ou, se ele já existir, conecta-se a ele.
+   *
+   * @param name Nome POSIX do segmento (por exemplo, "/meu_mapa").
+   * @param capacity Tamanho do segmento em bytes, usado só na criação.
+   * @throw std::system_error se o segmento não puder ser criado ou mapeado.
+   * @throw std::runtime_error se o segmento existente for de outro tipo.
+   */
+  SharedMap(const std::string& name, std::size_t capacity);
+
+  /**
+   * @brief Conecta-se a um segmento já existente.
+   *
+   * @throw std::system_error se o segmento não existir.
+   * @throw std::runtime_error se o segmento for de outro tipo.
+   */
+  explicit SharedMap(const std::string& name);
+
+  SharedMap(SharedMap&& other) noexcept
+      : base(std::exchange(other.base, nullptr)),
+        length(std::exchange(other.length, 0)) {}
+
+  SharedMap& operator=(SharedMap&& other) noexcept {
+    std::swap(base, other.base);
+    std::swap(length, other.length);
+    return *this;
+  }
+
+  SharedMap(const SharedMap&) = delete;
+  SharedMap& operator=(const SharedMap&) = delete;
+
+  /**
+   * @brief Desfaz o mapeamento; o segmento continua existindo.
+   */
+  ~SharedMap() {
+    if (base) ::munmap(base, length);
+  }
+
+  /**
+   * @brief Remove o nome do segmento. Processos conectados continuam com
+   * acesso até se desconectarem.
+   *
+   * @return `true` se o segmento existia.
+   */
+  static bool unlink(const std::string& name) { return ::shm_unlink(name.c_str()) == 0; }
+
+  /**
+   * @brief Acessa o valor associado a uma chave; ler uma chave ausente pela
+   * referência insere `V()`.
+   *
+   * A referência não toca o mapa até ser lida ou atribuída; essas operações
+   * lançam `std::length_error` se o segmento estiver cheio.
+   */
+  Reference operator[](const K& key) { return Reference(this, key); }
+
+  /**
+   * @brief Acessa o valor associado a uma chave (versão constante).
+   *
+   * @throw std::out_of_range se a chave não for encontrada.
+   */
+  V operator[](const K& key) const { return get(key); }
+
+  /**
+   * @brief Remove um par chave-valor.
+   *
+   * @return `true` se a chave existia.
+   */
+  bool remove(const K& key);
+
+  /**
+   * @brief Verifica se a chave está presente.
+   */
+  bool contains(const K& key) const;
+
+  /**
+   * @brief Retorna a quantidade de pares.
+   */
+  std::size_t size() const;
+
+  /**
+   * @brief Visita os pares em ordem de chave, sob o lock de leitura.
+   *
+   * @param f Função chamada como `f(const K&, const V&)`; não pode alterar o
+   * mapa.
+   */
+  template <class F>
+  void for_each(F&& f) const;
+
+  /**
+   * @brief Tamanho do segmento em bytes.
+   */
+  std::size_t capacity() const { return length; }
+
+ private:
+  struct Header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t key_size;
+    std::uint32_t value_size;
+    std::atomic<std::uint32_t> ready;  ///< 1 depois de inicializado.
+    pthread_rwlock_t lock;
+    std::uint64_t root;       ///< Deslocamento da raiz (0 = vazio).
+    std::uint64_t count;      ///< Quantidade de pares.
+    std::uint64_t top;        ///< Início da área ainda não usada.
+    std::uint64_t free_list;  ///< Nós removidos, ligados por `left`.
+  };
+
+  struct Node {
+    K key;
+    V value;
+    std::uint64_t left;   ///< Deslocamento do filho esquerdo (0 = nenhum).
+    std::uint64_t right;  ///< Deslocamento do filho direito (0 = nenhum).
+    std::int32_t height;
+  };
+
+  /**
+   * @brief Lock de leitura ou escrita pelo tempo de vida do objeto.
+   */
+  class Guard {
+   public:
+    Guard(pthread_rwlock_t* lock, bool write) : lock(lock) {
+      int error = write ? pthread_rwlock_wrlock(lock) : pthread_rwlock_rdlock(lock);
+      if (error != 0) throw std::system_error(error, std::generic_category(), "rwlock");
+    }
+    ~Guard() { pthread_rwlock_unlock(lock); }
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+
+   private:
+    pthread_rwlock_t* lock;
+  };
+
+  static constexpr std::uint64_t kFirstNode =
+      (sizeof(Header) + alignof(Node) - 1) / alignof(Node) * alignof(Node);
+
+  Header* header() const { return reinterpret_cast<Header*>(base); }
+  Node* node(std::uint64_t offset) const {
+    return reinterpret_cast<Node*>(static_cast<char*>(base) + offset);
+  }
+
+  void attach(int fd, bool create, std::size_t capacity);
+
+  V get(const K& key) const;
+  std::uint64_t find(const K& key) const;
+
+  /**
+   * @brief Devolve o valor de `key`, inserindo `V()` se ela não existir.
+   */
+  V fetch(const K& key);
+
+  /**
+   * @brief Insere ou, se `overwrite`, substitui o valor de `key`.
+   */
+  void put(const K& key, const V& value, bool overwrite);
+
+  std::uint64_t allocate(const K& key, const V& value);
+  std::int32_t height(std::uint64_t n) const { return n ? node(n)->height : 0; }
+  void update(std::uint64_t n) const {
+    node(n)->height = 1 + std::max(height(node(n)->left), height(node(n)->right));
+  }
+  std::uint64_t rotate_left(std::uint64_t n);
+  std::uint64_t rotate_right(std::uint64_t n);
+  std::uint64_t balance(std::uint64_t n);
+  std::uint64_t insert(std::uint64_t n, const K& key, const V& value,
+                       bool overwrite);
+  std::uint64_t erase(std::uint64_t n, const K& key, bool& removed);
+
+  void* base = nullptr;
+  std::size_t length = 0;
+};
+
+template <class K, class V>
+SharedMap<K, V>::SharedMap(const std::string& name, std::size_t capacity) {
+  if (capacity < kFirstNode + sizeof(Node)) {
+    throw std::invalid_argument("SharedMap: capacidade pequena demais");
+  }
+  int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  bool create = fd >= 0;
+  if (!create && errno == EEXIST) fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd < 0) throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+  attach(fd, create, capacity);
+}
+
+template <class K, class V>
+SharedMap<K, V>::SharedMap(const std::string& name) {
+  int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd < 0) throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+  attach(fd, false, 0);
+}
+
+template <class K, class V>
+void SharedMap<K, V>::attach(int fd, bool create, std::size_t capacity) {
+  static const char kMagic[4] = {'E', 'D', 'S', 'M'};
+  auto fail = [fd](const char* what) {
+    int error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(), what);
+  };
+
+  if (create) {
+    if (::ftruncate(fd, static_cast<off_t>(capacity)) != 0) fail("ftruncate");
+    length = capacity;
+  } else {
+    // O criador pode ainda não ter dimensionado o segmento.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    struct stat info;
+    while (true) {
+      if (::fstat(fd, &info) != 0) fail("fstat");
+      if (info.st_size > 0) break;
+      if (std::chrono::steady_clock::now() > deadline) {
+        ::close(fd);
+        throw std::runtime_error("SharedMap: segmento não inicializado");
+      }
+      std::this_thread::yield();
+    }
+    length = static_cast<std::size_t>(info.st_size);
+  }
+
+  base = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    base = nullptr;
+    fail("mmap");
+  }
+  ::close(fd);  // O mapeamento se mantém sem o descritor.
+
+  Header* h = header();
+  if (create) {
+    std::memcpy(h->magic, kMagic, sizeof(kMagic));
+    h->version = 1;
+    h->key_size = sizeof(K);
+    h->value_size = sizeof(V);
+    h->root = 0;
+    h->count = 0;
+    h->top = kFirstNode;
+    h->free_list = 0;
+    pthread_rwlockattr_t attributes;
+    pthread_rwlockattr_init(&attributes);
+    pthread_rwlockattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+#ifdef __GLIBC__
+    // Sem isto o glibc prefere leitores e um fluxo contínuo de leituras
+    // impede o escritor de entrar.
+    pthread_rwlockattr_setkind_np(&attributes,
+                                  PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    pthread_rwlock_init(&h->lock, &attributes);
+    pthread_rwlockattr_destroy(&attributes);
+    new (&h->ready) std::atomic<std::uint32_t>(0);
+    h->ready.store(1, std::memory_order_release);
+    return;
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (length >= sizeof(Header) && h->ready.load(std::memory_order_acquire) == 0) {
+    if (std::chrono::steady_clock::now() > deadline) break;
+    std::this_thread::yield();
+  }
+  if (length < sizeof(Header) || h->ready.load(std::memory_order_acquire) != 1 ||
+      std::memcmp(h->magic, kMagic, sizeof(kMagic)) != 0 || h->version != 1 ||
+      h->key_size != sizeof(K) || h->value_size != sizeof(V)) {
+    ::munmap(base, length);
+    base = nullptr;
+    throw std::runtime_error("SharedMap: segmento inválido ou de outros tipos");
+  }
+}
+
+template <class K, class V>
+std::uint64_t SharedMap<K, V>::find(const K& key) const {
+  std::uint64_t n = header()->root;
+  while (n) {
+    const Node* current = node(n);
+    if (key < current->key) {
+      n = current->left;
+    } else if (current->key < key) {
+      n = current->right;
+    } else {
+      return n;
+    }
+  }
+  return 0;
+}
+
+template <class K, class V>
+V SharedMap<K, V>::get(const K& key) const {
+  Guard guard(&header()->lock, false);
+  std::uint64_t n = find(key);
+  if (!n) throw std::out_of_range("SharedMap: chave não encontrada");
+  return node(n)->value;
+}
+
+template <class K, class V>
+V SharedMap<K, V>::fetch(const K& key) {
+  Guard guard(&header()->lock, true);
+  if (std::uint64_t n = find(key)) return node(n)->value;
+  header()->root = insert(header()->root, key, V(), false);
+  return V();
+}
+
+template <class K, class V>
+bool SharedMap<K, V>::contains(const K& key) const {
+  Guard guard(&header()->lock, false);
+  return find(key) != 0;
+}
+
+template <class K, class V>
+std::size_t SharedMap<K, V>::size() const {
+  Guard guard(&header()->lock, false);
+  return static_cast<std::size_t>(header()->count);
+}
+
+template <class K, class V>
+void SharedMap<K, V>::put(const K& key, const V& value, bool overwrite) {
+  Guard guard(&header()->lock, true);
+  header()->root = insert(header()->root, key, value, overwrite);
+}
+
+template <class K, class V>
+bool SharedMap<K, V>::remove(const K& key) {
+  Guard guard(&header()->lock, true);
+  bool removed = false;
+  header()->root = erase(header()->root, key, removed);
+  return removed;
+}
+
+template <class K, class V>
+template <class F>
+void SharedMap<K, V>::for_each(F&& f) const {
+  Guard guard(&header()->lock, false);
+  std::vector<std::uint64_t> stack;
+  std::uint64_t n = header()->root;
+  while (n || !stack.empty()) {
+    while (n) {
+      stack.push_back(n);
+      n = node(n)->left;
+    }
+    n = stack.back();
+    stack.pop_back();
+    const Node* current = node(n);
+    f(current->key, current->value);
+    n = current->right;
+  }
+}
+
+template <class K, class V>
+std::uint64_t SharedMap<K, V>::allocate(const K& key, const V& value) {
+  Header* h = header();
+  std::uint64_t n = h->free_list;
+  if (n) {
+    h->free_list = node(n)->left;
+  } else {
+    if (h->top + sizeof(Node) > length) {
+      throw std::length_error("SharedMap: segmento cheio");
+    }
+    n = h->top;
+    h->top += (sizeof(Node) + alignof(Node) - 1) / alignof(Node) * alignof(Node);
+  }
+  new (node(n)) Node{key, value, 0, 0, 1};
+  h->count++;
+  return n;
+}
+
+template <class K, class V>
+std::uint64_t SharedMap<K, V>::rotate_left(std::uint64_t n) {
+  std::uint64_t r = node(n)->right;
+  node(n)->right = node(r)->left;
+  node(r)->left = n;
+  update(n);
+  update(r);
+  return r;
+}
+
+template <class K, class V>
+std::uint64_t SharedMap<K, V>::rotate_right(std::uint64_t n) {
+  std::uint64_t l = node(n)->left;
+  node(n)->left = node(l)->right;
+  node(l)->right = n;
+  update(n);
+  update(l);
+  return l;
+}
+
+template <class K, class V>
+std::uint64_t SharedMap<K, V>::balance(std::uint64_t n) {
+  update(n);
+  std::int32_t factor = height(node(n)->left) - height(node(n)->right);
+  if (factor > 1) {
+    std::uint64_t l = node(n)->left;
+    if (height(node(l)->left) < height(node(l)->right)) {
+      node(n)->left = rotate_left(l);
+    }
+    return rotate_right(n);
+  }
+  if (factor < -1) {
+    std::uint64_t r = node(n)->right;
+    if (height(node(r)->right) < height(node(r)->left)) {
+      node(n)->right = rotate_right(r);
+    }
+    return rotate_left(n);
+  }
+  return n;
+}
+
+template <class K, class V>
+std::uint64_t SharedMap<K, V>::insert(std::uint64_t n, const K& key,
+                                      const V& value, bool overwrite) {
+  if (!n) return allocate(key, value);
+  if (key < node(n)->key) {
+    std::uint64_t child = insert(node(n)->left, key, value, overwrite);
+    node(n)->left = child;
+  } else if (node(n)->key < key) {
+    std::uint64_t child = insert(node(n)->right, key, value, overwrite);
+    node(n)->right = child;
+  } else {
+    if (overwrite) node(n)->value = value;
+    return n;
+  }
+  return balance(n);
+}
+
+template <class K, class V>
+std::uint64_t SharedMap<K, V>::erase(std::uint64_t n, const K& key,
+                                     bool& removed) {
+  if (!n) return 0;
+  if (key < node(n)->key) {
+    node(n)->left = erase(node(n)->left, key, removed);
+  } else if (node(n)->key < key) {
+    node(n)->right = erase(node(n)->right, key, removed);
+  } else {
+    removed = true;
+    Node* current = node(n);
+    if (current->left && current->right) {
+      // Dois filhos: herda o par do sucessor e remove-o da subárvore direita.
+      std::uint64_t successor = current->right;
+      while (node(successor)->left) successor = node(successor)->left;
+      current->key = node(successor)->key;
+      current->value = node(successor)->value;
+      bool ignored = false;
+      current->right = erase(current->right, current->key, ignored);
+    } else {
+      std::uint64_t child = current->left ? current->left : current->right;
+      current->left = header()->free_list;
+      header()->free_list = n;
+      header()->count--;
+      return child;
+    }
+  }
+  return balance(n);
+}
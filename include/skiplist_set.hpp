@@ -0,0 +1,361 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#include "epoch.hpp"
+
+/**
+ * @brief Conjunto ordenado concorrente e livre de travas baseado em skip list.
+ *
+ * Alternativa a `Set` para misturas muito concorrentes de inserções e
+ * remoções, onde as rotações da AVL dificultam algoritmos sem trava. Segue o
+ * algoritmo de Herlihy e Shavit: cada nível é uma lista ligada cujos
+ * ponteiros carregam, no bit menos significativo, a marca de remoção lógica
+ * do nó de origem. `remove` marca o nó do topo para a base; quem marca o
+ * nível 0 é o responsável pela remoção, e qualquer busca desliga nós marcados
+ * que encontra pelo caminho.
+ *
+ * Nós desligados são aposentados num `EpochDomain`. Como inserção e remoção
+ * do mesmo nó podem se sobrepor, cada nó conta dois "donos" (quem inseriu e
+ * quem removeu); o último a terminar refaz a busca para garantir que o nó
+ * saiu de todos os níveis e então o aposenta.
+ *
+ * `search` é livre de espera; `insert` e `remove` são livres de trava. A
+ * iteração ordenada é fracamente consistente: vê cada elemento presente
+ * durante toda a iteração e pode ou não ver alterações concorrentes.
+ *
+ * @tparam T Tipo dos elementos. Deve suportar o operador '<'.
+ */
+template <class T>
+class SkipListSet {
+ private:
+  static constexpr int kMaxLevel = 24;  ///< Níveis máximos (~16M elementos).
+
+  using Link = std::atomic<std::uintptr_t>;  ///< Ponteiro com bit de marca.
+
+  /**
+   * @brief Nó da skip list com `levels` ponteiros de próximo.
+   *
+   * O vetor `next` é alocado no mesmo bloco, logo após o nó, para que cada
+   * passo da busca toque uma única linha de cache.
+   */
+  struct Node {
+    T data;                     ///< Valor armazenado no nó.
+    int levels;                 ///< Quantidade de níveis do nó.
+    std::atomic<int> owners;    ///< Inserção e remoção ainda pendentes.
+    Link* next;                 ///< Próximo nó em cada nível.
+
+    Node(const T& value, int l, Link* links)
+        : data(value), levels(l), owners(2), next(links) {}
+  };
+
+  /**
+   * @brief Aloca um nó e seu vetor de níveis num único bloco.
+   */
+  static Node* create(const T& value, int levels);
+
+  /**
+   * @brief Libera um nó criado por `create`.
+   */
+  static void destroy(void* node);
+
+  static Node* pointer(std::uintptr_t link) {
+    return reinterpret_cast<Node*>(link & ~std::uintptr_t(1));
+  }
+  static bool marked(std::uintptr_t link) { return link & 1; }
+  static std::uintptr_t raw(Node* node) {
+    return reinterpret_cast<std::uintptr_t>(node);
+  }
+
+  /**
+   * @brief Sorteia a quantidade de níveis de um novo nó (p = 1/2).
+   */
+  static int random_level();
+
+  /**
+   * @brief Localiza, em cada nível, o predecessor e o sucessor de `value`,
+   * desligando os nós marcados encontrados no caminho.
+   *
+   * @param preds Vetores `next` dos predecessores em cada nível.
+   * @param succs Sucessores (primeiro nó não marcado >= `value`).
+   * @return `true` se `succs[0]` contém `value`.
+   */
+  bool find(const T& value, Link** preds, Node** succs) const;
+
+  /**
+   * @brief Encerra a participação de quem inseriu ou removeu o nó.
+   */
+  void finish(Node* node) const;
+
+ public:
+  /**
+   * @brief Construtor padrão; cria um conjunto vazio.
+   */
+  SkipListSet();
+
+  /**
+   * @brief Destrutor; não pode haver operações concorrentes.
+   */
+  ~SkipListSet();
+
+  SkipListSet(const SkipListSet&) = delete;
+  SkipListSet& operator=(const SkipListSet&) = delete;
+
+  /**
+   * @brief Insere um elemento no conjunto.
+   *
+   * @param value O valor a ser inserido.
+   * @return `true` se o elemento foi inserido, `false` se já existia.
+   */
+  bool insert(const T& value);
+
+  /**
+   * @brief Remove um elemento do conjunto.
+   *
+   * @param value O valor a ser removido.
+   * @return `true` se esta chamada removeu o elemento, `false` se ele não
+   * estava presente.
+   */
+  bool remove(const T& value);
+
+  /**
+   * @brief Verifica se um elemento está contido no conjunto.
+   *
+   * @param value O valor a ser buscado.
+   * @return `true` se o elemento estiver presente, `false` caso contrário.
+   */
+  bool search(const T& value) const;
+
+  /**
+   * @brief Visita os elementos em ordem crescente.
+   *
+   * @param f Função chamada como `f(const T&)` para cada elemento.
+   */
+  template <class F>
+  void for_each(F&& f) const;
+
+  /**
+   * @brief Retorna os elementos em ordem crescente.
+   */
+  std::vector<T> in_order() const;
+
+  /**
+   * @brief Retorna a quantidade de elementos (aproximada sob concorrência).
+   */
+  std::size_t size() const { return count.load(std::memory_order_relaxed); }
+
+ private:
+  Link head[kMaxLevel];               ///< Ponteiros da sentinela inicial.
+  std::atomic<std::size_t> count;     ///< Quantidade de elementos.
+  mutable EpochDomain domain;         ///< Libera nós desligados.
+};
+
+template <class T>
+SkipListSet<T>::SkipListSet() : count(0) {
+    for (Link& link : head) link.store(0, std::memory_order_relaxed);
+}
+
+template <class T>
+SkipListSet<T>::~SkipListSet() {
+    Node* node = pointer(head[0].load());
+    while (node) {
+        Node* next = pointer(node->next[0].load());
+        destroy(node);
+        node = next;
+    }
+}
+
+template <class T>
+typename SkipListSet<T>::Node* SkipListSet<T>::create(const T& value, int levels) {
+    constexpr std::size_t offset =
+        (sizeof(Node) + alignof(Link) - 1) / alignof(Link) * alignof(Link);
+    char* block = static_cast<char*>(::operator new(offset + levels * sizeof(Link)));
+    Link* links = reinterpret_cast<Link*>(block + offset);
+    for (int level = 0; level < levels; ++level) {
+        new (links + level) Link(0);
+    }
+    try {
+        return new (block) Node(value, levels, links);
+    } catch (...) {
+        ::operator delete(block);
+        throw;
+    }
+}
+
+template <class T>
+void SkipListSet<T>::destroy(void* node) {
+    static_cast<Node*>(node)->~Node();
+    ::operator delete(node);
+}
+
+template <class T>
+int SkipListSet<T>::random_level() {
+    thread_local std::uint64_t state =
+        0x9E3779B97F4A7C15ull ^ reinterpret_cast<std::uintptr_t>(&state);
+    // xorshift64*
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    std::uint64_t bits = state * 0x2545F4914F6CDD1Dull;
+    int level = 1;
+    while ((bits & 1) && level < kMaxLevel) {
+        bits >>= 1;
+        ++level;
+    }
+    return level;
+}
+
+template <class T>
+bool SkipListSet<T>::find(const T& value, Link** preds, Node** succs) const {
+retry:
+    Link* pred = const_cast<Link*>(head);
+    Node* curr = nullptr;
+    for (int level = kMaxLevel - 1; level >= 0; --level) {
+        curr = pointer(pred[level].load());
+        while (curr) {
+            std::uintptr_t succ = curr->next[level].load();
+            while (marked(succ)) {
+                std::uintptr_t expected = raw(curr);
+                if (!pred[level].compare_exchange_strong(expected,
+                                                         succ & ~std::uintptr_t(1))) {
+                    goto retry;
+                }
+                curr = pointer(succ);
+                if (!curr) break;
+                succ = curr->next[level].load();
+            }
+            if (!curr || !(curr->data < value)) break;
+            pred = curr->next;
+            curr = pointer(succ);
+        }
+        preds[level] = pred;
+        succs[level] = curr;
+    }
+    return curr && !(value < curr->data);
+}
+
+template <class T>
+void SkipListSet<T>::finish(Node* node) const {
+    if (node->owners.fetch_sub(1) == 1) {
+        Link* preds[kMaxLevel];
+        Node* succs[kMaxLevel];
+        find(node->data, preds, succs);
+        domain.retire(node, &SkipListSet::destroy);
+    }
+}
+
+template <class T>
+bool SkipListSet<T>::insert(const T& value) {
+    auto guard = domain.pin();
+    Link* preds[kMaxLevel];
+    Node* succs[kMaxLevel];
+    int levels = random_level();
+
+    Node* node = nullptr;
+    while (true) {
+        if (find(value, preds, succs)) {
+            if (node) destroy(node);
+            return false;
+        }
+        if (!node) node = create(value, levels);
+        for (int level = 0; level < levels; ++level) {
+            node->next[level].store(raw(succs[level]), std::memory_order_relaxed);
+        }
+        std::uintptr_t expected = raw(succs[0]);
+        if (preds[0][0].compare_exchange_strong(expected, raw(node))) break;
+    }
+    count.fetch_add(1, std::memory_order_relaxed);
+
+    // Liga os níveis superiores; para se o nó começar a ser removido.
+    for (int level = 1; level < levels; ++level) {
+        while (true) {
+            std::uintptr_t current = node->next[level].load();
+            if (marked(current)) goto done;
+            if (pointer(current) != succs[level] &&
+                !node->next[level].compare_exchange_strong(current,
+                                                           raw(succs[level]))) {
+                goto done;
+            }
+            std::uintptr_t expected = raw(succs[level]);
+            if (preds[level][level].compare_exchange_strong(expected, raw(node))) {
+                break;
+            }
+            find(value, preds, succs);
+            if (succs[0] != node) goto done;
+        }
+    }
+done:
+    finish(node);
+    return true;
+}
+
+template <class T>
+bool SkipListSet<T>::remove(const T& value) {
+    auto guard = domain.pin();
+    Link* preds[kMaxLevel];
+    Node* succs[kMaxLevel];
+    if (!find(value, preds, succs)) return false;
+
+    Node* node = succs[0];
+    for (int level = node->levels - 1; level >= 1; --level) {
+        std::uintptr_t current = node->next[level].load();
+        while (!marked(current) &&
+               !node->next[level].compare_exchange_weak(current, current | 1)) {
+        }
+    }
+
+    std::uintptr_t current = node->next[0].load();
+    while (true) {
+        if (marked(current)) return false;
+        if (node->next[0].compare_exchange_weak(current, current | 1)) break;
+    }
+    count.fetch_sub(1, std::memory_order_relaxed);
+
+    find(value, preds, succs);
+    finish(node);
+    return true;
+}
+
+template <class T>
+bool SkipListSet<T>::search(const T& value) const {
+    auto guard = domain.pin();
+    const Link* pred = head;
+    Node* curr = nullptr;
+    for (int level = kMaxLevel - 1; level >= 0; --level) {
+        curr = pointer(pred[level].load());
+        while (curr) {
+            std::uintptr_t succ = curr->next[level].load();
+            if (marked(succ)) {
+                curr = pointer(succ);
+            } else if (curr->data < value) {
+                pred = curr->next;
+                curr = pointer(succ);
+            } else {
+                break;
+            }
+        }
+    }
+    return curr && !(value < curr->data) && !marked(curr->next[0].load());
+}
+
+template <class T>
+template <class F>
+void SkipListSet<T>::for_each(F&& f) const {
+    auto guard = domain.pin();
+    for (Node* node = pointer(head[0].load()); node;) {
+        std::uintptr_t next = node->next[0].load();
+        if (!marked(next)) f(node->data);
+        node = pointer(next);
+    }
+}
+
+template <class T>
+std::vector<T> SkipListSet<T>::in_order() const {
+    std::vector<T> result;
+    result.reserve(size());
+    for_each([&](const T& value) { result.push_back(value); });
+    return result;
+}
@@ -0,0 +1,291 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Chama o visitante de uma travessia e diz se ela deve continuar.
+ *
+ * Visitantes que devolvem `void` nunca interrompem a travessia; os que
+ * devolvem `bool` a interrompem ao devolver `false`.
+ */
+template <class F, class... Args>
+bool keep_visiting(F& f, Args&&... args) {
+  if constexpr (std::is_void<std::invoke_result_t<F&, Args...>>::value) {
+    f(std::forward<Args>(args)...);
+    return true;
+  } else {
+    return static_cast<bool>(f(std::forward<Args>(args)...));
+  }
+}
+
+/**
+ * @brief Pilha de nós das travessias iterativas.
+ *
+ * Os primeiros `Inline` nós ficam num vetor fixo, sem alocação; só caminhos
+ * mais fundos (árvores de busca degeneradas) usam memória dinâmica. Para
+ * uma AVL, 96 níveis bastam para qualquer quantidade de nós representável.
+ */
+template <class Node, std::size_t Inline = 96>
+class TraversalStack {
+ public:
+  bool empty() const { return used == 0; }
+
+  void push(const Node* node) {
+    if (used < Inline) {
+      fixed[used] = node;
+    } else {
+      spill.push_back(node);
+    }
+    ++used;
+  }
+
+  const Node* top() const {
+    return used <= Inline ? fixed[used - 1] : spill.back();
+  }
+
+  const Node* pop() {
+    const Node* node = top();
+    if (used > Inline) spill.pop_back();
+    --used;
+    return node;
+  }
+
+ private:
+  const Node* fixed[Inline];
+  std::vector<const Node*> spill;
+  std::size_t used = 0;
+};
+
+/**
+ * @name Travessias iterativas
+ *
+ * Percorrem a árvore de raiz `root` com uma `TraversalStack`, chamando
+ * `visit(const Node*)` em cada nó; param assim que `visit` devolve `false`.
+ * O nó só precisa ter os membros `left` e `right`.
+ *
+ * @return `true` se todos os nós foram visitados.
+ * @{
+ */
+template <class Node, class F>
+bool walk_in_order(const Node* root, F&& visit) {
+  TraversalStack<Node> stack;
+  const Node* node = root;
+  while (node || !stack.empty()) {
+    while (node) {
+      stack.push(node);
+      node = node->left;
+    }
+    node = stack.pop();
+    if (!visit(node)) return false;
+    node = node->right;
+  }
+  return true;
+}
+
+template <class Node, class F>
+bool walk_pre_order(const Node* root, F&& visit) {
+  TraversalStack<Node> stack;
+  if (root) stack.push(root);
+  while (!stack.empty()) {
+    const Node* node = stack.pop();
+    if (!visit(node)) return false;
+    if (node->right) stack.push(node->right);
+    if (node->left) stack.push(node->left);
+  }
+  return true;
+}
+
+template <class Node, class F>
+bool walk_post_order(const Node* root, F&& visit) {
+  TraversalStack<Node> stack;
+  const Node* node = root;
+  const Node* last = nullptr;  // Último nó visitado.
+  while (node || !stack.empty()) {
+    if (node) {
+      stack.push(node);
+      node = node->left;
+      continue;
+    }
+    const Node* top = stack.top();
+    if (top->right && top->right != last) {
+      node = top->right;
+    } else {
+      if (!visit(top)) return false;
+      last = stack.pop();
+    }
+  }
+  return true;
+}
+/** @} */
+
+/**
+ * @brief Travessia em ordem de Morris, com O(1) de memória extra.
+ *
+ * Em vez de uma pilha, costura temporariamente o ponteiro `right` (nulo) do
+ * predecessor de cada nó com filho à esquerda de volta para o nó, e desfaz
+ * a costura ao passar por ele pela segunda vez. Cada aresta é percorrida no
+ * máximo três vezes, então o custo continua O(n).
+ *
+ * A árvore é alterada durante a travessia: ela exige acesso exclusivo,
+ * inclusive em relação a leitores. Ao fim, mesmo se `visit` devolver
+ * `false` ou lançar uma exceção, todas as costuras são desfeitas; por isso
+ * uma interrupção deixa de visitar os nós restantes, mas ainda os percorre.
+ *
+ * @return `true` se todos os nós foram visitados.
+ */
+template <class Node, class F>
+bool walk_morris(Node* root, F&& visit) {
+  std::exception_ptr error;
+  bool visiting = true;
+  Node* node = root;
+  while (node) {
+    if (node->left) {
+      Node* predecessor = node->left;
+      while (predecessor->right && predecessor->right != node) {
+        predecessor = predecessor->right;
+      }
+      if (!predecessor->right) {
+        // Primeira passagem: costura e desce à esquerda.
+        predecessor->right = node;
+        node = node->left;
+        continue;
+      }
+      predecessor->right = nullptr;
+    }
+    if (visiting) {
+      try {
+        visiting = visit(static_cast<const Node*>(node));
+      } catch (...) {
+        error = std::current_exception();
+        visiting = false;
+      }
+    }
+    node = node->right;
+  }
+  if (error) std::rethrow_exception(error);
+  return visiting;
+}
+
+/**
+ * @brief Executa `task(i)` para cada i em [0, n) em até `threads` threads,
+ * incluindo a chamadora, que pegam os índices de um contador comum.
+ *
+ * A primeira exceção lançada por `task` é propagada depois que todas as
+ * threads terminam; as demais tarefas ainda não iniciadas são descartadas.
+ * Se não for possível criar todas as threads, as tarefas são divididas entre
+ * as que já existem e a chamadora.
+ */
+template <class Task>
+void run_in_threads(std::size_t n, unsigned threads, Task&& task) {
+  std::atomic<std::size_t> next{0};
+  std::exception_ptr error;
+  std::mutex error_lock;
+  auto work = [&] {
+    for (std::size_t i = next++; i < n; i = next++) {
+      try {
+        task(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> guard(error_lock);
+        if (!error) error = std::current_exception();
+        next = n;
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  unsigned extra = static_cast<unsigned>(
+      std::min<std::size_t>(threads > 0 ? threads - 1 : 0, n > 0 ? n - 1 : 0));
+  try {
+    workers.reserve(extra);
+    for (unsigned t = 0; t < extra; ++t) workers.emplace_back(work);
+  } catch (...) {
+    // Sem recursos para mais threads (std::system_error): as threads já
+    // criadas continuam pegando índices do contador junto com a chamadora.
+  }
+  work();
+  for (std::thread& worker : workers) worker.join();
+  if (error) std::rethrow_exception(error);
+}
+
+/**
+ * @brief Pedaço da travessia paralela: um nó isolado do topo da árvore ou
+ * uma subárvore inteira.
+ */
+template <class Node>
+struct ExportPiece {
+  const Node* node;
+  bool subtree;
+};
+
+/**
+ * @brief Lista em ordem os pedaços da árvore: os nós com profundidade menor
+ * que `depth` isolados e as subárvores penduradas nessa profundidade.
+ */
+template <class Node>
+void collect_pieces(const Node* node, unsigned depth,
+                    std::vector<ExportPiece<Node>>& pieces) {
+  if (!node) return;
+  if (depth == 0) {
+    pieces.push_back({node, true});
+    return;
+  }
+  collect_pieces<Node>(node->left, depth - 1, pieces);
+  pieces.push_back({node, false});
+  collect_pieces<Node>(node->right, depth - 1, pieces);
+}
+
+/**
+ * @brief Travessia em ordem repartida entre threads, para exportar a árvore
+ * para posições já conhecidas.
+ *
+ * Os nós não guardam o tamanho da subárvore, então a árvore é cortada numa
+ * profundidade com cerca de 8 subárvores por thread, as subárvores são
+ * contadas em paralelo e as somas prefixadas dão a posição inicial de cada
+ * uma; uma segunda passada paralela chama `emit(node, posição)`. Em árvores
+ * balanceadas as subárvores têm tamanhos parecidos; numa BST degenerada a
+ * maior parte fica num único pedaço e o ganho desaparece.
+ *
+ * @param root Raiz da árvore (não alterada).
+ * @param threads Quantidade de threads, incluindo a chamadora.
+ * @param emit Chamada como `emit(const Node*, std::size_t)` uma vez por nó,
+ * concorrentemente para nós diferentes.
+ */
+template <class Node, class Emit>
+void walk_in_order_parallel(const Node* root, unsigned threads, Emit&& emit) {
+  unsigned depth = 0;
+  while ((std::size_t{1} << depth) < 8u * std::max(threads, 1u)) ++depth;
+  std::vector<ExportPiece<Node>> pieces;
+  collect_pieces(root, depth, pieces);
+
+  std::vector<std::size_t> offsets(pieces.size() + 1, 0);
+  run_in_threads(pieces.size(), threads, [&](std::size_t i) {
+    std::size_t size = 1;
+    if (pieces[i].subtree) {
+      size = 0;
+      walk_in_order(pieces[i].node, [&size](const Node*) {
+        ++size;
+        return true;
+      });
+    }
+    offsets[i + 1] = size;
+  });
+  for (std::size_t i = 0; i < pieces.size(); ++i) offsets[i + 1] += offsets[i];
+
+  run_in_threads(pieces.size(), threads, [&](std::size_t i) {
+    std::size_t position = offsets[i];
+    if (!pieces[i].subtree) {
+      emit(pieces[i].node, position);
+      return;
+    }
+    walk_in_order(pieces[i].node, [&](const Node* node) {
+      emit(node, position++);
+      return true;
+    });
+  });
+}
@@ -0,0 +1,82 @@
+#include "../include/async_io.hpp"
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "temp_path.hpp"
+
+class AsyncReaderTest : public ::testing::TestWithParam<AsyncReader::Backend> {
+ protected:
+  void SetUp() override {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    for (int i = 0; i < 1 << 16; ++i) file.put(static_cast<char>(i * 7));
+    file.close();
+    fd = ::open(path.c_str(), O_RDONLY);
+    ASSERT_GE(fd, 0);
+  }
+
+  void TearDown() override {
+    ::close(fd);
+    std::remove(path.c_str());
+  }
+
+  std::string path = temp_path(".bin");
+  int fd = -1;
+};
+
+TEST_P(AsyncReaderTest, ReadsManyBlocksConcurrently) {
+  AsyncReader reader(fd, 8, GetParam());
+  std::vector<std::vector<char>> buffers(32, std::vector<char>(1000));
+  std::vector<AsyncReader::Completion> done;
+  std::size_t next = 0;
+  while (done.size() < buffers.size()) {
+    while (next < buffers.size() && reader.in_flight() < reader.depth()) {
+      reader.submit(next * 2000 + 3, buffers[next].data(), 1000, next);
+      ++next;
+    }
+    EXPECT_GT(reader.wait(done), 0u);
+  }
+  EXPECT_EQ(reader.in_flight(), 0u);
+  EXPECT_EQ(reader.wait(done), 0u);
+
+  for (const AsyncReader::Completion& c : done) {
+    ASSERT_EQ(c.error, 0);
+    for (std::size_t i = 0; i < 1000; ++i) {
+      std::size_t offset = c.tag * 2000 + 3 + i;
+      ASSERT_EQ(buffers[c.tag][i], static_cast<char>(offset * 7));
+    }
+  }
+}
+
+TEST_P(AsyncReaderTest, ReportsReadPastEnd) {
+  AsyncReader reader(fd, 2, GetParam());
+  std::vector<char> buffer(100);
+  reader.submit((1 << 16) - 10, buffer.data(), buffer.size(), 42);
+  std::vector<AsyncReader::Completion> done;
+  reader.wait(done);
+  ASSERT_EQ(done.size(), 1u);
+  EXPECT_EQ(done[0].tag, 42u);
+  EXPECT_EQ(done[0].error, EIO);
+}
+
+TEST_P(AsyncReaderTest, RejectsSubmitBeyondDepth) {
+  AsyncReader reader(fd, 1, GetParam());
+  std::vector<char> buffer(10);
+  reader.submit(0, buffer.data(), buffer.size(), 0);
+  EXPECT_THROW(reader.submit(0, buffer.data(), buffer.size(), 1), std::logic_error);
+  std::vector<AsyncReader::Completion> done;
+  reader.wait(done);
+  EXPECT_EQ(done.size(), 1u);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, AsyncReaderTest,
+                         ::testing::Values(AsyncReader::Backend::kAuto,
+                                           AsyncReader::Backend::kThreadPool));
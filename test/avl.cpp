@@ -1,5 +1,16 @@
 #include "../include/avl.hpp"
+#include "../include/bst.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <gtest/gtest.h>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 using IntAVL = AVL<int>;
@@ -134,3 +145,511 @@ TEST(AVLRotationTest, RightLeftRotation) {
     EXPECT_EQ(tree.in_order(), expected);
     EXPECT_TRUE(tree.is_balanced());
 }
+
+TEST(AVLRotationTest, DoubleRotationsKeepTreeBalanced) {
+    // Alturas desatualizadas após a rotação interna de uma rotação dupla
+    // acumulam-se até que a árvore deixe de ser AVL.
+    IntAVL tree;
+    for (int i = 0; i < 500; ++i) {
+        tree.insert((i * 37) % 500);
+        ASSERT_TRUE(tree.is_balanced()) << "após inserir " << (i * 37) % 500;
+    }
+    for (int i = 0; i < 1000; ++i) tree.insert(1000 + (i * 263) % 1000);
+    EXPECT_TRUE(tree.is_balanced());
+    EXPECT_EQ(tree.size(), 1500u);
+}
+
+// ---------- CÓPIA E MOVIMENTO ----------
+
+TEST(AVLTest, CopyPreservesShapeAndHeights) {
+    IntAVL tree;
+    for (int i = 0; i < 100; ++i) tree.insert(i);
+
+    IntAVL copy(tree);
+    EXPECT_EQ(copy.pre_order(), tree.pre_order());
+    EXPECT_TRUE(copy.is_balanced());
+
+    // Alturas copiadas corretamente mantêm o rebalanceamento na cópia.
+    for (int i = 0; i < 100; i += 3) copy.remove(i);
+    EXPECT_TRUE(copy.is_balanced());
+    EXPECT_TRUE(tree.contain(0));
+    EXPECT_EQ(tree.in_order().size(), 100u);
+}
+
+TEST(AVLTest, MoveAndSwap) {
+    IntAVL tree;
+    for (int i : {20, 10, 30}) tree.insert(i);
+
+    IntAVL moved = std::move(tree);
+    EXPECT_TRUE(tree.in_order().empty());
+    EXPECT_TRUE(tree.insert(1));
+    EXPECT_EQ(moved.in_order(), (std::vector<int>{10, 20, 30}));
+
+    moved.swap(tree);
+    EXPECT_EQ(moved.in_order(), (std::vector<int>{1}));
+    EXPECT_EQ(tree.in_order(), (std::vector<int>{10, 20, 30}));
+
+    tree = moved;
+    EXPECT_EQ(tree.in_order(), (std::vector<int>{1}));
+}
+
+TEST(AVLTest, AssignSortedBuildsBalancedTree) {
+    IntAVL tree;
+    tree.insert(-5);
+    int next = 0;
+    tree.assign_sorted(1000, [&] { return next++; });
+
+    EXPECT_EQ(tree.size(), 1000u);
+    EXPECT_TRUE(tree.is_balanced());
+    EXPECT_FALSE(tree.contain(-5));
+    std::vector<int> values = tree.in_order();
+    ASSERT_EQ(values.size(), 1000u);
+    EXPECT_EQ(values.front(), 0);
+    EXPECT_EQ(values.back(), 999);
+
+    // Alturas corretas: inserções e remoções seguintes mantêm o balanceamento.
+    for (int i = 0; i < 1000; i += 2) EXPECT_TRUE(tree.remove(i));
+    for (int i = 1000; i < 1200; ++i) EXPECT_TRUE(tree.insert(i));
+    EXPECT_TRUE(tree.is_balanced());
+    EXPECT_EQ(tree.size(), 700u);
+}
+
+TEST(AVLTest, AssignSortedKeepsTreeOnException) {
+    IntAVL tree;
+    tree.insert(7);
+    int next = 0;
+    EXPECT_THROW(tree.assign_sorted(10, [&] {
+        if (next == 6) throw std::runtime_error("falha");
+        return next++;
+    }), std::runtime_error);
+    EXPECT_EQ(tree.in_order(), (std::vector<int>{7}));
+}
+
+TEST(AVLTest, SaveShapeRestoresIdenticalTree) {
+    IntAVL tree;
+    for (int i = 0; i < 500; ++i) tree.insert((i * 37) % 500);
+    for (int i = 0; i < 500; i += 3) tree.remove(i);
+    ASSERT_TRUE(tree.is_balanced());
+
+    std::stringstream stream;
+    tree.save_shape(stream);
+    IntAVL restored;
+    restored.load_shape(stream);
+
+    EXPECT_EQ(restored.size(), tree.size());
+    EXPECT_EQ(restored.pre_order(), tree.pre_order());
+    EXPECT_EQ(restored.post_order(), tree.post_order());
+    EXPECT_TRUE(restored.is_balanced());
+
+    // Alturas recalculadas: operações seguintes mantêm o balanceamento.
+    for (int i = 500; i < 700; ++i) EXPECT_TRUE(restored.insert(i));
+    EXPECT_TRUE(restored.is_balanced());
+}
+
+TEST(AVLTest, LoadShapeRejectsUnbalancedShape) {
+    BST<int> chain;
+    for (int i = 0; i < 4; ++i) chain.insert(i);
+    std::stringstream stream;
+    chain.save_shape(stream);
+
+    IntAVL tree;
+    tree.insert(7);
+    EXPECT_THROW(tree.load_shape(stream), std::runtime_error);
+    EXPECT_EQ(tree.in_order(), (std::vector<int>{7}));
+}
+
+TEST(AVLTest, LoadShapeRejectsCorruptCount) {
+    IntAVL source;
+    for (int i = 0; i < 10; ++i) source.insert(i);
+    std::stringstream stream;
+    source.save_shape(stream);
+
+    // `count` é o último campo do cabeçalho.
+    std::string bytes = stream.str();
+    std::uint64_t count = std::uint64_t(1) << 61;
+    std::memcpy(&bytes[SnapshotHeader::encoded_size() - sizeof(count)], &count,
+                sizeof(count));
+    std::stringstream corrupt(bytes);
+
+    IntAVL tree;
+    tree.insert(7);
+    EXPECT_THROW(tree.load_shape(corrupt), std::runtime_error);
+    EXPECT_EQ(tree.in_order(), (std::vector<int>{7}));
+}
+
+TEST(AVLTest, ContainsManyMatchesContain) {
+    IntAVL tree;
+    for (int i = 0; i < 1000; i += 3) tree.insert(i);
+
+    // Mais consultas que um grupo, com repetidas e ausentes misturadas.
+    std::vector<int> probes;
+    for (int i = 0; i < 100; ++i) probes.push_back((i * 37) % 1010 - 5);
+    bool found[100];
+    std::size_t hits = tree.contains_many(probes.data(), probes.size(), found);
+
+    std::size_t expected = 0;
+    for (std::size_t i = 0; i < probes.size(); ++i) {
+        EXPECT_EQ(found[i], tree.contain(probes[i])) << probes[i];
+        expected += found[i];
+    }
+    EXPECT_EQ(hits, expected);
+
+    std::vector<const int*> nodes(probes.size());
+    EXPECT_EQ(tree.find_many(probes.data(), probes.size(), nodes.data()), expected);
+    for (std::size_t i = 0; i < probes.size(); ++i) {
+        if (found[i]) {
+            EXPECT_EQ(*nodes[i], probes[i]);
+        }
+    }
+}
+
+TEST(AVLTest, SearchSortedMatchesContain) {
+    IntAVL tree;
+    for (int i = 0; i < 500; i += 5) tree.insert(i);
+
+    // Lote ordenado com repetições e valores fora da faixa da árvore.
+    std::vector<int> probes = {-3, 0, 0, 1, 5, 5, 5, 7, 250, 251, 495, 495, 496, 900};
+    for (int i = 0; i < 600; i += 3) probes.push_back(i);
+    std::sort(probes.begin(), probes.end());
+    std::unique_ptr<bool[]> owned(new bool[probes.size()]);
+    bool* found = owned.get();
+    std::size_t hits = tree.search_sorted(probes.data(), probes.size(), found);
+    std::size_t expected = 0;
+    for (std::size_t i = 0; i < probes.size(); ++i) {
+        EXPECT_EQ(found[i], tree.contain(probes[i])) << probes[i];
+        expected += found[i];
+    }
+    EXPECT_EQ(hits, expected);
+
+    IntAVL empty;
+    EXPECT_EQ(empty.search_sorted(probes.data(), probes.size(), found), 0u);
+    EXPECT_FALSE(found[1]);
+
+    std::vector<int> unsorted = {3, 1};
+    EXPECT_THROW(tree.search_sorted(unsorted.data(), 2, found), std::invalid_argument);
+}
+
+TEST(AVLTest, AppendMaxKeepsTreeBalanced) {
+    IntAVL tree;
+    for (int i = 0; i < 5000; ++i) tree.append_max(2 * i);
+    EXPECT_EQ(tree.size(), 5000u);
+    EXPECT_TRUE(tree.is_balanced());
+    std::vector<int> expected;
+    for (int i = 0; i < 5000; ++i) expected.push_back(2 * i);
+    EXPECT_EQ(tree.in_order(), expected);
+
+    EXPECT_THROW(tree.append_max(9998), std::invalid_argument);
+    EXPECT_THROW(tree.append_max(5), std::invalid_argument);
+
+    // Outras alterações invalidam o dedo interno, que é refeito.
+    tree.remove(9998);
+    tree.insert(-1);
+    tree.append_max(9998);
+    tree.append_max(10001);
+    EXPECT_EQ(tree.size(), 5002u);
+    EXPECT_TRUE(tree.is_balanced());
+    EXPECT_TRUE(tree.contain(10001));
+}
+
+TEST(AVLTest, HintedInsertMatchesPlainInsert) {
+    IntAVL tree;
+    IntAVL plain;
+    IntAVL::Finger hint;
+    // Corridas crescentes e decrescentes com saltos, repetições e
+    // inserções sem dica no meio (que invalidam o dedo).
+    std::uint32_t state = 7;
+    int value = 0;
+    for (int i = 0; i < 20000; ++i) {
+        state = state * 1103515245u + 12345u;
+        if (state % 97 == 0) value = static_cast<int>(state % 100000);
+        value += (state >> 8) % 3 == 0 ? -1 : 2;
+        if (i % 1000 == 999) {
+            EXPECT_EQ(tree.insert(value + 7), plain.insert(value + 7));
+        }
+        EXPECT_EQ(tree.insert(hint, value), plain.insert(value));
+    }
+    EXPECT_EQ(tree.size(), plain.size());
+    EXPECT_EQ(tree.in_order(), plain.in_order());
+    EXPECT_TRUE(tree.is_balanced());
+
+    // Dica de outra árvore é ignorada.
+    IntAVL other;
+    EXPECT_TRUE(other.insert(hint, 3));
+    EXPECT_FALSE(other.insert(hint, 3));
+    EXPECT_EQ(other.in_order(), (std::vector<int>{3}));
+}
+
+TEST(AVLTest, EraseRangeMatchesRemove) {
+    // Vários intervalos sobre árvores de formas diferentes, comparando com
+    // remoções individuais.
+    for (int n : {0, 1, 2, 7, 100, 1000}) {
+        for (int lo = -5; lo <= n + 5; lo += std::max(1, n / 7)) {
+            for (int hi : {lo - 1, lo, lo + 1, lo + n / 3, n + 10}) {
+                IntAVL tree;
+                IntAVL plain;
+                for (int i = 0; i < n; ++i) {
+                    int value = (i * 37) % n;
+                    tree.insert(value);
+                    plain.insert(value);
+                }
+                std::size_t expected = 0;
+                for (int value = lo; value < hi; ++value) expected += plain.remove(value);
+                EXPECT_EQ(tree.erase_range(lo, hi), expected);
+                EXPECT_EQ(tree.size(), plain.size());
+                EXPECT_EQ(tree.in_order(), plain.in_order());
+                EXPECT_TRUE(tree.is_balanced());
+            }
+        }
+    }
+}
+
+TEST(AVLTest, ExtractRangeMovesNodes) {
+    IntAVL tree;
+    for (int i = 0; i < 2000; ++i) tree.append_max(i);
+    IntAVL::Finger hint;
+    tree.insert(hint, 5000);
+
+    IntAVL middle = tree.extract_range(500, 1500);
+    EXPECT_EQ(middle.size(), 1000u);
+    EXPECT_EQ(tree.size(), 1001u);
+    EXPECT_TRUE(middle.is_balanced());
+    EXPECT_TRUE(tree.is_balanced());
+    std::vector<int> inside = middle.in_order();
+    EXPECT_EQ(inside.front(), 500);
+    EXPECT_EQ(inside.back(), 1499);
+    EXPECT_FALSE(tree.contain(500));
+    EXPECT_TRUE(tree.contain(499));
+    EXPECT_TRUE(tree.contain(1500));
+
+    // Os dedos antigos são invalidados pela divisão.
+    EXPECT_TRUE(tree.insert(hint, 1000));
+    tree.append_max(6000);
+    EXPECT_EQ(tree.size(), 1003u);
+    EXPECT_TRUE(tree.is_balanced());
+
+    EXPECT_TRUE(tree.extract_range(3000, 2000).empty());
+    EXPECT_EQ(tree.size(), 1003u);
+}
+
+TEST(AVLTest, OrderQueriesMatchSortedVector) {
+    IntAVL tree;
+    std::vector<int> values;
+    for (int i = 0; i < 300; ++i) {
+        int value = (i * 53) % 997 * 2;
+        if (tree.insert(value)) values.push_back(value);
+    }
+    std::sort(values.begin(), values.end());
+
+    auto same = [](const int* got, std::vector<int>::const_iterator it,
+                   const std::vector<int>& all) {
+        if (it == all.end()) return got == nullptr;
+        return got != nullptr && *got == *it;
+    };
+    for (int probe = -3; probe <= 2000; ++probe) {
+        auto lower = std::lower_bound(values.begin(), values.end(), probe);
+        auto upper = std::upper_bound(values.begin(), values.end(), probe);
+        EXPECT_TRUE(same(tree.lower_bound(probe), lower, values));
+        EXPECT_TRUE(same(tree.ceiling(probe), lower, values));
+        EXPECT_TRUE(same(tree.upper_bound(probe), upper, values));
+        EXPECT_TRUE(same(tree.successor(probe), upper, values));
+        EXPECT_TRUE(same(tree.floor(probe),
+                         upper == values.begin() ? values.end() : upper - 1, values));
+        EXPECT_TRUE(same(tree.predecessor(probe),
+                         lower == values.begin() ? values.end() : lower - 1, values));
+
+        const int* near = tree.nearest(probe);
+        ASSERT_NE(near, nullptr);
+        for (int value : values) {
+            EXPECT_LE(std::abs(*near - probe), std::abs(value - probe));
+        }
+    }
+}
+
+TEST(AVLTest, VisitorsMatchVectorTraversals) {
+    IntAVL tree;
+    for (int i = 0; i < 1000; ++i) tree.insert((i * 389) % 1000);
+
+    std::vector<int> seen;
+    EXPECT_TRUE(tree.for_each_in_order([&](int value) { seen.push_back(value); }));
+    EXPECT_EQ(seen, tree.in_order());
+    seen.clear();
+    tree.for_each_pre_order([&](int value) { seen.push_back(value); });
+    EXPECT_EQ(seen, tree.pre_order());
+    seen.clear();
+    tree.for_each_post_order([&](int value) { seen.push_back(value); });
+    EXPECT_EQ(seen, tree.post_order());
+
+    // Varredura parcial: para no primeiro valor >= 100.
+    std::size_t visited = 0;
+    EXPECT_FALSE(tree.for_each_in_order([&](int value) {
+        ++visited;
+        return value < 100;
+    }));
+    EXPECT_EQ(visited, 101u);
+
+    std::unique_ptr<int[]> buffer(new int[tree.size()]);
+    EXPECT_EQ(tree.post_order(buffer.get()), buffer.get() + tree.size());
+    EXPECT_EQ(std::vector<int>(buffer.get(), buffer.get() + tree.size()), tree.post_order());
+}
+
+TEST(AVLTest, MorrisTraversalLeavesTreeIntact) {
+    IntAVL tree;
+    for (int i = 0; i < 500; ++i) tree.insert((i * 211) % 500);
+    std::vector<int> pre = tree.pre_order();
+
+    std::vector<int> values;
+    tree.in_order_morris(std::back_inserter(values));
+    EXPECT_EQ(values, tree.in_order());
+    int sum = 0;
+    EXPECT_FALSE(tree.for_each_in_order_morris([&](int value) {
+        sum += value;
+        return value < 9;
+    }));
+    EXPECT_EQ(sum, 45);
+
+    EXPECT_EQ(tree.pre_order(), pre);
+    EXPECT_TRUE(tree.is_balanced());
+    EXPECT_TRUE(tree.insert(1000));
+    EXPECT_TRUE(tree.remove(250));
+    EXPECT_EQ(tree.size(), 500u);
+}
+
+TEST(AVLTest, MorrisVisitorCanLookUpTheSameTree) {
+    IntAVL tree;
+    for (int i = 0; i < 500; ++i) tree.insert((i * 211) % 500 * 2);
+
+    // Durante a travessia a árvore está costurada: buscas por valores
+    // ausentes entre um nó e o seu sucessor não podem seguir as costuras.
+    std::size_t checked = 0;
+    EXPECT_TRUE(tree.for_each_in_order_morris([&](int value) {
+        EXPECT_TRUE(tree.contain(value));
+        EXPECT_FALSE(tree.contain(value + 1));
+        EXPECT_FALSE(tree.contain(value - 1));
+        const int* found = tree.find(value);
+        EXPECT_TRUE(found && *found == value);
+        EXPECT_EQ(tree.find(value + 1), nullptr);
+        ++checked;
+    }));
+    EXPECT_EQ(checked, tree.size());
+    EXPECT_TRUE(tree.is_balanced());
+}
+
+TEST(AVLTest, ParallelExportMatchesInOrder) {
+    for (int n : {0, 1, 5, 100, 30000}) {
+        IntAVL tree;
+        for (int i = 0; i < n; ++i) tree.insert((i * 7919) % n);
+        std::vector<int> expected = tree.in_order();
+        for (unsigned threads : {0u, 1u, 2u, 3u, 8u}) {
+            std::vector<int> out(n, -1);
+            EXPECT_EQ(tree.parallel_export(out.data(), threads), out.data() + n);
+            EXPECT_EQ(out, expected) << n << " valores, " << threads << " threads";
+        }
+    }
+}
+
+TEST(AVLTest, ParallelExportPropagatesVisitorException) {
+    IntAVL tree;
+    for (int i = 0; i < 1000; ++i) tree.append_max(i);
+    EXPECT_THROW(tree.parallel_for_each_in_order(
+                     [](int value, std::size_t) {
+                         if (value == 500) throw std::runtime_error("falha");
+                     },
+                     4),
+                 std::runtime_error);
+}
+
+namespace {
+
+// Monoide não comutativo: concatena os valores na ordem da árvore.
+struct Concat {
+    using value_type = std::string;
+    static value_type identity() { return ""; }
+    static value_type combine(const value_type& a, const value_type& b) { return a + b; }
+    static value_type measure(int value) { return std::to_string(value) + ","; }
+};
+
+template <class Tree>
+void expect_aggregates(const Tree& tree, int lo, int hi) {
+    long sum = 0;
+    std::string concat;
+    for (int value : tree.in_order()) {
+        if (value < lo || value >= hi) continue;
+        sum += value;
+        concat += std::to_string(value) + ",";
+    }
+    EXPECT_EQ(tree.aggregate(lo, hi).first, sum) << lo << ".." << hi;
+    EXPECT_EQ(tree.aggregate(lo, hi).second, concat) << lo << ".." << hi;
+}
+
+// Soma e concatenação juntas, para verificar valor e ordem de uma vez.
+struct SumAndConcat {
+    using value_type = std::pair<long, std::string>;
+    static value_type identity() { return {0, ""}; }
+    static value_type combine(const value_type& a, const value_type& b) {
+        return {a.first + b.first, a.second + b.second};
+    }
+    static value_type measure(int value) { return {value, Concat::measure(value)}; }
+};
+
+}  // namespace
+
+TEST(AVLTest, AggregateTracksEveryMutation) {
+    AVL<int, SumAndConcat> tree;
+    AVL<int, SumAndConcat>::Finger hint;
+    std::uint32_t state = 11;
+    for (int step = 0; step < 3000; ++step) {
+        state = state * 1103515245u + 12345u;
+        int value = static_cast<int>((state >> 8) % 2000);
+        switch (step % 5) {
+            case 0:
+            case 1:
+                tree.insert(value);
+                break;
+            case 2:
+                tree.insert(hint, value);
+                break;
+            case 3:
+                tree.remove(value);
+                break;
+            default:
+                if (step % 100 == 4) tree.erase_range(value, value + 40);
+                break;
+        }
+        if (step % 50 == 0) {
+            expect_aggregates(tree, value - 300, value + 300);
+            EXPECT_EQ(tree.aggregate().second, tree.aggregate(-1, 1 << 30).second);
+        }
+    }
+    for (int lo = -10; lo < 2010; lo += 97) expect_aggregates(tree, lo, lo + 250);
+    EXPECT_EQ(tree.aggregate(50, 50).first, 0);
+
+    AVL<int, SumAndConcat> part = tree.extract_range(500, 1500);
+    expect_aggregates(part, 0, 2000);
+    expect_aggregates(tree, 0, 2000);
+
+    AVL<int, SumAndConcat> copy(tree);
+    expect_aggregates(copy, 100, 1900);
+
+    std::stringstream shape;
+    tree.save_shape(shape);
+    AVL<int, SumAndConcat> loaded;
+    loaded.load_shape(shape);
+    expect_aggregates(loaded, 0, 2000);
+}
+
+TEST(AVLTest, ReadyMadeAggregates) {
+    AVL<int, MinOf<int>> low;
+    AVL<int, MaxOf<int>> high;
+    AVL<int, CountOf> count;
+    int next = 0;
+    low.assign_sorted(100, [&] { return next++ * 2; });
+    for (int i = 0; i < 100; ++i) {
+        high.append_max(i * 2);
+        count.insert(i * 2);
+    }
+    EXPECT_EQ(low.aggregate(11, 40), 12);
+    EXPECT_EQ(low.aggregate(500, 600), std::numeric_limits<int>::max());
+    EXPECT_EQ(high.aggregate(11, 40), 38);
+    EXPECT_EQ(count.aggregate(11, 40), 14u);
+    EXPECT_EQ(count.aggregate(), 100u);
+}
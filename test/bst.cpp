@@ -2,6 +2,12 @@
 
 #include <gtest/gtest.h>
 
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 // ---------- Casos Gerais ----------
 
 TEST(BSTTest, InserirEEncontrarElementos) {
@@ -180,4 +186,283 @@ TEST(BSTTest, PostOrderTraversal) {
   std::vector<int> expected = {3, 7, 5, 15, 10};
 
   EXPECT_EQ(result, expected);
-}
\ No newline at end of file
+}
+
+// ---------- Cópia e Movimento ----------
+
+TEST(BSTTest, CopiaPreservaFormaEIndependencia) {
+  BST<int> tree;
+  for (int i : {10, 5, 15, 3, 7}) tree.insert(i);
+
+  BST<int> copy(tree);
+  EXPECT_EQ(copy.pre_order(), tree.pre_order());
+
+  copy.remove(5);
+  copy.insert(20);
+  EXPECT_TRUE(tree.contain(5));
+  EXPECT_FALSE(tree.contain(20));
+  EXPECT_EQ(tree.pre_order(), (std::vector<int>{10, 5, 3, 7, 15}));
+}
+
+TEST(BSTTest, MovimentoESwap) {
+  BST<int> tree;
+  for (int i : {10, 5, 15}) tree.insert(i);
+
+  BST<int> moved(std::move(tree));
+  EXPECT_TRUE(tree.in_order().empty());
+  EXPECT_EQ(moved.in_order(), (std::vector<int>{5, 10, 15}));
+
+  BST<int> other;
+  other.insert(1);
+  swap(moved, other);
+  EXPECT_EQ(moved.in_order(), (std::vector<int>{1}));
+  EXPECT_EQ(other.in_order(), (std::vector<int>{5, 10, 15}));
+
+  moved = other;
+  other = BST<int>();
+  EXPECT_EQ(moved.in_order(), (std::vector<int>{5, 10, 15}));
+  EXPECT_TRUE(other.in_order().empty());
+}
+
+TEST(BSTTest, AssignSortedMontaArvoreBalanceada) {
+  BST<int> tree;
+  int next = 1;
+  tree.assign_sorted(7, [&] { return next++; });
+
+  EXPECT_EQ(tree.size(), 7u);
+  EXPECT_EQ(tree.pre_order(), (std::vector<int>{4, 2, 1, 3, 6, 5, 7}));
+  EXPECT_TRUE(tree.insert(8));
+  EXPECT_EQ(tree.size(), 8u);
+}
+
+TEST(BSTTest, SaveShapeRestauraFormaIdentica) {
+  BST<int> tree;
+  // Forma degenerada à direita seguida de uma subárvore à esquerda.
+  for (int value : {1, 2, 3, 10, 6, 4, 8, 12}) tree.insert(value);
+
+  std::stringstream stream;
+  tree.save_shape(stream);
+  BST<int> restored;
+  restored.insert(99);
+  restored.load_shape(stream);
+
+  EXPECT_EQ(restored.size(), tree.size());
+  EXPECT_EQ(restored.pre_order(), tree.pre_order());
+  EXPECT_EQ(restored.in_order(), tree.in_order());
+  EXPECT_FALSE(restored.contain(99));
+}
+
+TEST(BSTTest, LoadShapeRejeitaFormaInconsistente) {
+  BST<int> tree;
+  for (int value : {2, 1, 3}) tree.insert(value);
+  std::stringstream stream;
+  tree.save_shape(stream);
+  std::string bytes = stream.str();
+  bytes[bytes.size() - 1] = 1;  // a última folha passa a ter um filho
+
+  std::stringstream corrupted(bytes);
+  BST<int> restored;
+  restored.insert(5);
+  EXPECT_THROW(restored.load_shape(corrupted), std::runtime_error);
+  EXPECT_EQ(restored.in_order(), (std::vector<int>{5}));
+}
+
+TEST(BSTTest, FindManyIgualABuscasIndividuais) {
+  BST<int> tree;
+  for (int value : {50, 20, 80, 10, 30, 70, 90, 25, 35, 75}) tree.insert(value);
+
+  std::vector<int> probes;
+  for (int value = 0; value <= 100; value += 5) probes.push_back(value);
+  std::vector<const int*> found(probes.size());
+  std::size_t hits = tree.find_many(probes.data(), probes.size(), found.data());
+
+  std::size_t expected = 0;
+  for (std::size_t i = 0; i < probes.size(); ++i) {
+    if (tree.contain(probes[i])) {
+      ASSERT_NE(found[i], nullptr);
+      EXPECT_EQ(*found[i], probes[i]);
+      ++expected;
+    } else {
+      EXPECT_EQ(found[i], nullptr);
+    }
+  }
+  EXPECT_EQ(hits, expected);
+
+  BST<int> empty;
+  EXPECT_EQ(empty.find_many(probes.data(), probes.size(), found.data()), 0u);
+  EXPECT_EQ(found[0], nullptr);
+}
+
+TEST(BSTTest, EraseRangeEExtractRange) {
+  BST<int> tree;
+  for (int value : {50, 20, 80, 10, 30, 70, 90, 25, 35, 75}) tree.insert(value);
+
+  EXPECT_EQ(tree.erase_range(25, 71), 5u);
+  EXPECT_EQ(tree.in_order(), (std::vector<int>{10, 20, 75, 80, 90}));
+  EXPECT_EQ(tree.size(), 5u);
+  EXPECT_EQ(tree.erase_range(40, 40), 0u);
+
+  BST<int> tail = tree.extract_range(80, 1000);
+  EXPECT_EQ(tail.in_order(), (std::vector<int>{80, 90}));
+  EXPECT_EQ(tail.size(), 2u);
+  EXPECT_EQ(tree.in_order(), (std::vector<int>{10, 20, 75}));
+  EXPECT_TRUE(tree.insert(85));
+  EXPECT_EQ(tree.size(), 4u);
+
+  // Árvore degenerada: a divisão é iterativa.
+  BST<int> chain;
+  for (int i = 0; i < 5000; ++i) chain.insert(i);
+  EXPECT_EQ(chain.erase_range(10, 4990), 4980u);
+  EXPECT_EQ(chain.size(), 20u);
+  EXPECT_TRUE(chain.contain(9));
+  EXPECT_TRUE(chain.contain(4990));
+}
+
+TEST(BSTTest, ConsultasPorOrdem) {
+  BST<int> tree;
+  EXPECT_EQ(tree.lower_bound(1), nullptr);
+  EXPECT_EQ(tree.nearest(1), nullptr);
+  for (int value : {50, 20, 80, 10, 30, 70, 90}) tree.insert(value);
+
+  EXPECT_EQ(*tree.lower_bound(30), 30);
+  EXPECT_EQ(*tree.ceiling(31), 50);
+  EXPECT_EQ(*tree.upper_bound(30), 50);
+  EXPECT_EQ(*tree.successor(85), 90);
+  EXPECT_EQ(tree.upper_bound(90), nullptr);
+  EXPECT_EQ(*tree.floor(30), 30);
+  EXPECT_EQ(*tree.floor(69), 50);
+  EXPECT_EQ(*tree.predecessor(30), 20);
+  EXPECT_EQ(tree.predecessor(10), nullptr);
+  EXPECT_EQ(*tree.nearest(64), 70);
+  EXPECT_EQ(*tree.nearest(60), 50);  // Empate: o menor.
+  EXPECT_EQ(*tree.nearest(-100), 10);
+  EXPECT_EQ(*tree.nearest(1000), 90);
+
+  BST<int> limits;
+  limits.insert(std::numeric_limits<int>::min());
+  limits.insert(std::numeric_limits<int>::max());
+  EXPECT_EQ(*limits.nearest(0), std::numeric_limits<int>::max());
+  EXPECT_EQ(*limits.nearest(-1), std::numeric_limits<int>::min());
+  EXPECT_EQ(tree.lower_bound(30), &tree.find_node(30)->data);  // Sem cópia.
+}
+
+TEST(BSTTest, VisitantesIterativosEInterrupcao) {
+  BST<int> tree;
+  for (int value : {50, 20, 80, 10, 30, 70, 90}) tree.insert(value);
+
+  std::vector<int> seen;
+  EXPECT_TRUE(tree.for_each_pre_order([&](int value) { seen.push_back(value); }));
+  EXPECT_EQ(seen, tree.pre_order());
+  seen.clear();
+  EXPECT_TRUE(tree.for_each_post_order([&](int value) { seen.push_back(value); }));
+  EXPECT_EQ(seen, (std::vector<int>{10, 30, 20, 70, 90, 80, 50}));
+
+  // Interrompe no primeiro valor maior que 40.
+  seen.clear();
+  EXPECT_FALSE(tree.for_each_in_order([&](int value) {
+    seen.push_back(value);
+    return value < 40;
+  }));
+  EXPECT_EQ(seen, (std::vector<int>{10, 20, 30, 50}));
+
+  // Iterador de saída para um buffer do chamador.
+  int buffer[7];
+  EXPECT_EQ(tree.in_order(buffer), buffer + 7);
+  EXPECT_EQ(std::vector<int>(buffer, buffer + 7), tree.in_order());
+}
+
+TEST(BSTTest, TravessiasIterativasEmArvoreDegenerada) {
+  // Monta em O(n), via load_shape, uma cadeia em que cada nó só tem o filho
+  // direito; a pilha das travessias passa do trecho fixo para o vetor.
+  const int n = 20000;
+  std::stringstream shape;
+  SnapshotHeader header =
+      SnapshotHeader::make<int, std::uint8_t>(SnapshotHeader::kShape, n);
+  header.write(shape);
+  SnapshotWriter<int, std::uint8_t> writer(shape, header);
+  for (int i = 0; i < n; ++i) writer.push(i, i + 1 < n ? 2 : 0);
+  writer.flush();
+  BST<int> chain;
+  chain.load_shape(shape);
+
+  std::vector<int> in(n), pre(n), post(n);
+  chain.in_order(in.begin());
+  chain.pre_order(pre.begin());
+  chain.post_order(post.begin());
+  for (int i = 0; i < n; ++i) {
+    ASSERT_EQ(in[i], i);
+    ASSERT_EQ(pre[i], i);
+    ASSERT_EQ(post[i], n - 1 - i);
+  }
+  int visited = 0;
+  EXPECT_FALSE(chain.for_each_post_order([&](int) { return ++visited < 10; }));
+  EXPECT_EQ(visited, 10);
+
+  std::vector<int> morris(n);
+  chain.in_order_morris(morris.begin());
+  EXPECT_EQ(morris, in);
+}
+
+TEST(BSTTest, MorrisRestauraAArvore) {
+  BST<int> tree;
+  for (int value : {50, 20, 80, 10, 30, 70, 90, 25, 35, 75}) tree.insert(value);
+  std::stringstream before;
+  tree.save_shape(before);
+
+  std::vector<int> values;
+  EXPECT_TRUE(tree.for_each_in_order_morris([&](int value) { values.push_back(value); }));
+  EXPECT_EQ(values, tree.in_order());
+
+  // Interrupção e exceção também desfazem as costuras.
+  int visited = 0;
+  EXPECT_FALSE(tree.for_each_in_order_morris([&](int) { return ++visited < 3; }));
+  EXPECT_EQ(visited, 3);
+  EXPECT_THROW(tree.for_each_in_order_morris([](int value) {
+    if (value == 30) throw std::runtime_error("falha");
+  }), std::runtime_error);
+
+  std::stringstream after;
+  tree.save_shape(after);
+  EXPECT_EQ(before.str(), after.str());
+
+  int buffer[10];
+  EXPECT_EQ(tree.in_order_morris(buffer), buffer + 10);
+  EXPECT_EQ(std::vector<int>(buffer, buffer + 10), tree.in_order());
+
+  BST<int> empty;
+  EXPECT_TRUE(empty.for_each_in_order_morris([](int) { return false; }));
+}
+
+TEST(BSTTest, MorrisPermiteBuscasDoVisitante) {
+  BST<int> tree;
+  for (int value : {50, 20, 80, 10, 30, 70, 90, 25, 35, 75}) tree.insert(value);
+
+  // Com a árvore costurada, buscas por ausentes entre um nó e o seu
+  // sucessor não podem entrar em ciclo.
+  std::vector<int> values = tree.in_order();
+  std::size_t checked = 0;
+  EXPECT_TRUE(tree.for_each_in_order_morris([&](int value) {
+    for (int probe : values) EXPECT_TRUE(tree.contain(probe));
+    EXPECT_FALSE(tree.contain(value + 1));
+    EXPECT_FALSE(tree.contain(value - 1));
+    ++checked;
+  }));
+  EXPECT_EQ(checked, values.size());
+  EXPECT_EQ(tree.in_order(), values);
+}
+
+TEST(BSTTest, ParallelExportIgualAInOrder) {
+  BST<int> tree;
+  for (int i = 0; i < 2000; ++i) tree.insert((i * 613) % 2000);
+  std::vector<int> out(2000);
+  for (unsigned threads : {1u, 4u}) {
+    EXPECT_EQ(tree.parallel_export(out.data(), threads), out.data() + 2000);
+    EXPECT_EQ(out, tree.in_order());
+  }
+  // Árvore degenerada: quase tudo num só pedaço, mas o resultado é o mesmo.
+  BST<int> chain;
+  for (int i = 0; i < 300; ++i) chain.insert(i);
+  std::vector<int> sorted(300);
+  chain.parallel_export(sorted.data(), 4);
+  EXPECT_EQ(sorted, chain.in_order());
+}
@@ -0,0 +1,116 @@
+#include "../include/bulk_loader.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <class T>
+std::vector<T> contents(const Set<T>& set) {
+  std::stringstream stream;
+  set.save(stream);
+  SnapshotHeader header = SnapshotHeader::read(
+      stream, SnapshotHeader::make<T>(SnapshotHeader::kSet, 0));
+  SnapshotReader<T> reader(stream, header);
+  std::vector<T> result;
+  for (std::uint64_t i = 0; i < header.count; ++i) {
+    reader.advance();
+    result.push_back(reader.key());
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(BulkLoaderTest, InMemoryLoadDeduplicates) {
+  BulkLoader<int> loader;
+  for (int value : {5, 3, 9, 3, 1, 5}) loader.add(value);
+  Set<int> set;
+  set.insert(100);
+  loader.finish(set);
+
+  EXPECT_EQ(loader.runs(), 0u);
+  EXPECT_EQ(contents(set), (std::vector<int>{1, 3, 5, 9}));
+  EXPECT_FALSE(set.search(100));
+}
+
+TEST(BulkLoaderTest, SpillsRunsAndMerges) {
+  // Orçamento de ~1000 inteiros por corrida.
+  BulkLoader<int> loader(1000 * sizeof(int));
+  for (int i = 0; i < 20000; ++i) loader.add((i * 7919) % 10007);
+  EXPECT_GT(loader.runs(), 1u);
+
+  Set<int> set;
+  loader.finish(set);
+  EXPECT_EQ(loader.runs(), 0u);
+  EXPECT_EQ(set.size(), 10007u);
+
+  std::vector<int> values = contents(set);
+  for (int i = 0; i < 10007; ++i) ASSERT_EQ(values[i], i);
+}
+
+TEST(BulkLoaderTest, ReadsTextLines) {
+  std::istringstream in("42\n-7\r\n\n13\n42\n8");
+  BulkLoader<long> loader(4 * sizeof(long));
+  loader.read_lines(in);
+  Set<long> set;
+  loader.finish(set);
+  EXPECT_EQ(contents(set), (std::vector<long>{-7, 8, 13, 42}));
+}
+
+TEST(BulkLoaderTest, ReadsStringLinesAcrossRuns) {
+  std::string text;
+  for (int i = 0; i < 3000; ++i) text += "chave" + std::to_string(i % 1500) + "\n";
+  std::istringstream in(text);
+
+  BulkLoader<std::string> loader(16 * 1024);
+  loader.read_lines(in);
+  EXPECT_GT(loader.runs(), 1u);
+
+  Set<std::string> set;
+  loader.finish(set);
+  EXPECT_EQ(set.size(), 1500u);
+  EXPECT_TRUE(set.search("chave0"));
+  EXPECT_TRUE(set.search("chave1499"));
+  EXPECT_FALSE(set.search("chave1500"));
+}
+
+TEST(BulkLoaderTest, ReadsBinaryInput) {
+  std::vector<unsigned> raw = {9, 2, 7, 2, 4};
+  std::string bytes(reinterpret_cast<const char*>(raw.data()),
+                    raw.size() * sizeof(unsigned));
+  std::istringstream in(bytes);
+
+  BulkLoader<unsigned> loader;
+  loader.read_binary(in);
+  Set<unsigned> set;
+  loader.finish(set);
+  EXPECT_EQ(contents(set), (std::vector<unsigned>{2, 4, 7, 9}));
+}
+
+TEST(BulkLoaderTest, RejectsInvalidLines) {
+  std::istringstream in("1\nabc\n");
+  BulkLoader<int> loader;
+  EXPECT_THROW(loader.read_lines(in), std::runtime_error);
+}
+
+TEST(BulkLoaderTest, RejectsOutOfRangeIntegers) {
+  std::istringstream wide("1\n4294967296\n");
+  BulkLoader<int> ints;
+  EXPECT_THROW(ints.read_lines(wide), std::runtime_error);
+
+  std::istringstream negative("1\n-1\n");
+  BulkLoader<unsigned> unsigneds;
+  EXPECT_THROW(unsigneds.read_lines(negative), std::runtime_error);
+
+  std::istringstream limits("-2147483648\n2147483647\n");
+  BulkLoader<int> bounds;
+  bounds.read_lines(limits);
+  Set<int> set;
+  bounds.finish(set);
+  EXPECT_EQ(contents(set), (std::vector<int>{-2147483648, 2147483647}));
+}
@@ -0,0 +1,101 @@
+#include "../include/coroutine_lookup.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+TEST(CoroutineLookupTest, InterleavedAVLQueriesMatchDirectAnswers) {
+  AVL<int> tree;
+  for (int i = 0; i < 2000; i += 2) tree.insert(i);
+
+  std::vector<Lookup<const int*>> finds;
+  std::vector<Lookup<const int*>> bounds;
+  std::vector<Lookup<std::size_t>> ranges;
+  std::vector<std::vector<int>> seen(20);
+  for (int i = 0; i < 100; ++i) {
+    finds.push_back(find_async(tree, i * 21 - 10));
+    bounds.push_back(lower_bound_async(tree, i * 21 - 10));
+  }
+  for (int i = 0; i < 20; ++i) {
+    ranges.push_back(range_async(tree, i * 97, i * 97 + 11,
+                                 [&seen, i](int value) { seen[i].push_back(value); }));
+  }
+
+  // Mistura os três tipos de consulta no mesmo executor.
+  Interleaver executor(8);
+  for (int i = 0; i < 100; ++i) {
+    executor.add(finds[i]);
+    if (i < 20) executor.add(ranges[i]);
+    executor.add(bounds[i]);
+  }
+  executor.run();
+
+  for (int i = 0; i < 100; ++i) {
+    int value = i * 21 - 10;
+    ASSERT_TRUE(finds[i].done());
+    const int* found = finds[i].result();
+    EXPECT_EQ(found != nullptr, tree.contain(value)) << value;
+    if (found) {
+      EXPECT_EQ(*found, value);
+    }
+
+    const int* bound = bounds[i].result();
+    int expected = value <= 0 ? 0 : (value + 1) / 2 * 2;
+    if (expected >= 2000) {
+      EXPECT_EQ(bound, nullptr);
+    } else {
+      ASSERT_NE(bound, nullptr);
+      EXPECT_EQ(*bound, expected);
+    }
+  }
+  for (int i = 0; i < 20; ++i) {
+    std::vector<int> expected;
+    for (int v = i * 97; v < i * 97 + 11; ++v) {
+      if (v % 2 == 0 && v < 2000) expected.push_back(v);
+    }
+    EXPECT_EQ(seen[i], expected);
+    EXPECT_EQ(ranges[i].result(), expected.size());
+  }
+}
+
+TEST(CoroutineLookupTest, MapQueries) {
+  Map<std::string, int> map;
+  for (const char* word : {"delta", "alfa", "echo", "bravo", "charlie"}) {
+    map[word] = static_cast<int>(std::string(word).size());
+  }
+
+  auto found = find_async(map, std::string("echo"));
+  auto missing = find_async(map, std::string("foxtrot"));
+  auto bound = lower_bound_async(map, std::string("c"));
+  std::vector<std::pair<std::string, int>> seen;
+  auto range = range_async(map, std::string("b"), std::string("d"),
+                           [&seen](const std::string& key, int value) {
+                             seen.emplace_back(key, value);
+                           });
+  Interleaver executor;
+  executor.add(found);
+  executor.add(missing);
+  executor.add(bound);
+  executor.add(range);
+  executor.run();
+
+  ASSERT_NE(found.result(), nullptr);
+  EXPECT_EQ(*found.result(), 4);
+  EXPECT_EQ(missing.result(), nullptr);
+  ASSERT_NE(bound.result().first, nullptr);
+  EXPECT_EQ(*bound.result().first, "charlie");
+  EXPECT_EQ(*bound.result().second, 7);
+  EXPECT_EQ(range.result(), 2u);
+  EXPECT_EQ(seen, (std::vector<std::pair<std::string, int>>{{"bravo", 5}, {"charlie", 7}}));
+}
+
+TEST(CoroutineLookupTest, ResultRunsLookupWithoutExecutor) {
+  AVL<int> tree;
+  EXPECT_EQ(find_async(tree, 1).result(), nullptr);
+  tree.insert(1);
+  auto lookup = find_async(tree, 1);
+  EXPECT_FALSE(lookup.done());
+  EXPECT_EQ(*lookup.result(), 1);
+}
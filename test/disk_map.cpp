@@ -0,0 +1,147 @@
+#include "../include/disk_map.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "temp_path.hpp"
+
+class DiskMapTest : public ::testing::Test {
+ protected:
+  void SetUp() override { std::remove(path.c_str()); }
+  void TearDown() override { std::remove(path.c_str()); }
+
+  std::string path = temp_path(".db");
+};
+
+TEST_F(DiskMapTest, OperatorSquareBracketsAndRemove) {
+  DiskMap<int, double> map(path);
+  map[3] = 1.5;
+  EXPECT_EQ(map[3], 1.5);
+  EXPECT_EQ(static_cast<double>(map[4]), 0.0);  // insere o valor padrão
+  EXPECT_EQ(map.size(), 2u);
+
+  const DiskMap<int, double>& view = map;
+  EXPECT_THROW(view[5], std::out_of_range);
+  EXPECT_TRUE(map.remove(3));
+  EXPECT_FALSE(map.remove(3));
+  EXPECT_FALSE(map.contains(3));
+  EXPECT_EQ(map.size(), 1u);
+}
+
+TEST_F(DiskMapTest, MatchesStdMapWithSmallBufferPool) {
+  std::map<int, long> expected;
+  std::mt19937 rng(1);
+  {
+    // Poucas páginas em memória forçam despejos e releituras.
+    DiskMap<int, long> map(path, 8);
+    for (int i = 0; i < 50000; ++i) {
+      int key = static_cast<int>(rng() % 20000);
+      if (rng() % 4 == 0) {
+        EXPECT_EQ(map.remove(key), expected.erase(key) == 1);
+      } else {
+        map[key] = i;
+        expected[key] = i;
+      }
+    }
+    EXPECT_EQ(map.size(), expected.size());
+    EXPECT_GT(map.buffer_pool().misses(), 0u);
+
+    auto it = expected.begin();
+    map.for_each([&](int key, long value) {
+      ASSERT_NE(it, expected.end());
+      EXPECT_EQ(key, it->first);
+      EXPECT_EQ(value, it->second);
+      ++it;
+    });
+    EXPECT_EQ(it, expected.end());
+  }
+
+  DiskMap<int, long> reopened(path, 16);
+  EXPECT_EQ(reopened.size(), expected.size());
+  const DiskMap<int, long>& view = reopened;
+  for (const auto& [key, value] : expected) ASSERT_EQ(view[key], value);
+}
+
+TEST_F(DiskMapTest, DetectsCorruptedPage) {
+  {
+    DiskMap<int, int> map(path);
+    for (int i = 0; i < 100; ++i) map[i] = i;
+  }
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(BufferPool::kPageSize + 100);
+    file.put('\x7f');
+  }
+  DiskMap<int, int> map(path);
+  const DiskMap<int, int>& view = map;
+  EXPECT_THROW(view[1], std::runtime_error);
+}
+
+TEST_F(DiskMapTest, RejectsOtherTypes) {
+  { DiskMap<int, int> map(path); }
+  EXPECT_THROW((DiskMap<int, double>(path)), std::runtime_error);
+}
+
+TEST_F(DiskMapTest, FindManyMatchesSingleLookups) {
+  std::map<int, long> expected;
+  {
+    DiskMap<int, long> map(path);
+    std::mt19937 rng(2);
+    for (int i = 0; i < 30000; ++i) {
+      int key = static_cast<int>(rng() % 100000);
+      map[key] = i;
+      expected[key] = i;
+    }
+  }
+
+  for (auto backend : {AsyncReader::Backend::kAuto, AsyncReader::Backend::kThreadPool}) {
+    // Poucas páginas em memória: quase toda descida espera leituras.
+    DiskMap<int, long> map(path, 8);
+    map.set_async_io(4, backend);
+    std::vector<int> keys;
+    for (int key = 0; key < 100000; key += 7) keys.push_back(key);
+    std::vector<long> values(keys.size(), -1);
+    std::unique_ptr<bool[]> found(new bool[keys.size()]);
+
+    std::size_t hits = map.find_many(keys.data(), keys.size(), values.data(), found.get());
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      auto it = expected.find(keys[i]);
+      ASSERT_EQ(found[i], it != expected.end());
+      if (found[i]) {
+        EXPECT_EQ(values[i], it->second);
+        ++count;
+      } else {
+        EXPECT_EQ(values[i], -1);
+      }
+    }
+    EXPECT_EQ(hits, count);
+    EXPECT_EQ(map.contains_many(keys.data(), keys.size(), found.get()), count);
+  }
+}
+
+TEST_F(DiskMapTest, FindManyDetectsCorruptedPage) {
+  {
+    DiskMap<int, int> map(path);
+    for (int i = 0; i < 10000; ++i) map[i] = i;
+  }
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(2 * BufferPool::kPageSize + 100);
+    file.put('\x7f');
+  }
+  DiskMap<int, int> map(path, 8);
+  std::vector<int> keys(10000);
+  for (int i = 0; i < 10000; ++i) keys[i] = i;
+  std::unique_ptr<bool[]> found(new bool[keys.size()]);
+  EXPECT_THROW(map.contains_many(keys.data(), keys.size(), found.get()),
+               std::runtime_error);
+}
@@ -0,0 +1,219 @@
+#include "../include/durable_map.hpp"
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "temp_path.hpp"
+
+class DurableMapTest : public ::testing::Test {
+ protected:
+  void SetUp() override { clean(); }
+  void TearDown() override { clean(); }
+
+  void clean() {
+    std::remove((directory + "/wal").c_str());
+    std::remove((directory + "/checkpoint").c_str());
+    std::remove((directory + "/checkpoint.tmp").c_str());
+    std::remove(directory.c_str());
+  }
+
+  DurableOptions with(Durability durability) {
+    DurableOptions options;
+    options.durability = durability;
+    return options;
+  }
+
+  /**
+   * @brief Limita o tamanho dos arquivos do processo a `extra` bytes além do
+   * log atual; `write` passa a falhar com EFBIG em vez de gerar SIGXFSZ.
+   */
+  void limit_wal(off_t extra) {
+    struct stat info {};
+    ASSERT_EQ(::stat((directory + "/wal").c_str(), &info), 0);
+    ASSERT_EQ(::getrlimit(RLIMIT_FSIZE, &saved), 0);
+    std::signal(SIGXFSZ, SIG_IGN);
+    struct rlimit limit = saved;
+    limit.rlim_cur = static_cast<rlim_t>(info.st_size + extra);
+    ASSERT_EQ(::setrlimit(RLIMIT_FSIZE, &limit), 0);
+  }
+
+  void unlimit_wal() {
+    ASSERT_EQ(::setrlimit(RLIMIT_FSIZE, &saved), 0);
+    std::signal(SIGXFSZ, SIG_DFL);
+  }
+
+  std::string directory = temp_path("");
+  struct rlimit saved {};
+};
+
+TEST_F(DurableMapTest, RecoversFromLogInEveryMode) {
+  for (Durability durability :
+       {Durability::kEveryOp, Durability::kBatch, Durability::kPeriodic}) {
+    clean();
+    {
+      DurableMap<int, int> map(directory, with(durability));
+      for (int i = 0; i < 100; ++i) map.assign(i, i * i);
+      EXPECT_TRUE(map.remove(10));
+      EXPECT_FALSE(map.remove(1000));
+      map.assign(20, -1);
+    }
+    DurableMap<int, int> reopened(directory, with(durability));
+    EXPECT_EQ(reopened.size(), 99u);
+    EXPECT_EQ(reopened.get(5), 25);
+    EXPECT_EQ(reopened.get(20), -1);
+    EXPECT_THROW(reopened.get(10), std::out_of_range);
+  }
+}
+
+TEST_F(DurableMapTest, CheckpointThenReplaysTail) {
+  {
+    DurableMap<std::string, std::string> map(directory);
+    map.assign("a", "1");
+    map.assign("b", "2");
+    map.checkpoint();
+    map.assign("c", "3");
+    map.remove("a");
+  }
+  std::ifstream wal(directory + "/wal", std::ios::binary | std::ios::ate);
+  EXPECT_GT(wal.tellg(), 0);
+
+  DurableMap<std::string, std::string> reopened(directory);
+  EXPECT_EQ(reopened.size(), 2u);
+  EXPECT_EQ(reopened.get("b"), "2");
+  EXPECT_EQ(reopened.get("c"), "3");
+  EXPECT_THROW(reopened.get("a"), std::out_of_range);
+}
+
+TEST_F(DurableMapTest, AutomaticCheckpointBoundsTheLog) {
+  DurableOptions options;
+  options.checkpoint_bytes = 256;
+  {
+    DurableMap<int, int> map(directory, options);
+    for (int i = 0; i < 200; ++i) map.assign(i % 10, i);
+  }
+  std::ifstream wal(directory + "/wal", std::ios::binary | std::ios::ate);
+  EXPECT_LT(wal.tellg(), 256);
+
+  DurableMap<int, int> reopened(directory, options);
+  EXPECT_EQ(reopened.size(), 10u);
+  EXPECT_EQ(reopened.get(3), 193);
+}
+
+TEST_F(DurableMapTest, DiscardsTornTail) {
+  {
+    DurableMap<int, int> map(directory);
+    map.assign(1, 10);
+    map.assign(2, 20);
+  }
+  {
+    // Simula uma escrita interrompida: registro truncado no fim do log.
+    std::ofstream wal(directory + "/wal", std::ios::binary | std::ios::app);
+    wal.write("\x09\x00\x00\x00\x01\x02", 6);
+  }
+  {
+    DurableMap<int, int> map(directory);
+    EXPECT_EQ(map.size(), 2u);
+    map.assign(3, 30);
+  }
+  DurableMap<int, int> reopened(directory);
+  EXPECT_EQ(reopened.size(), 3u);
+  EXPECT_EQ(reopened.get(3), 30);
+}
+
+TEST_F(DurableMapTest, ConcurrentWritersShareCommits) {
+  {
+    DurableMap<int, int> map(directory);
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t) {
+      writers.emplace_back([&map, t] {
+        for (int i = 0; i < 50; ++i) map.assign(t * 1000 + i, i);
+      });
+    }
+    for (auto& writer : writers) writer.join();
+    EXPECT_EQ(map.size(), 200u);
+  }
+  DurableMap<int, int> reopened(directory);
+  EXPECT_EQ(reopened.size(), 200u);
+  EXPECT_EQ(reopened.get(3049), 49);
+}
+
+TEST_F(DurableMapTest, FailedAppendKeepsAcknowledgedRecords) {
+  {
+    DurableMap<int, std::string> map(directory);
+    for (int i = 0; i < 10; ++i) map.assign(i, std::to_string(i));
+
+    // O registro grande só cabe em parte: o lote falha no meio da escrita.
+    // A operação que lançou não altera o mapa nem é gravada depois.
+    limit_wal(16);
+    EXPECT_THROW(map.assign(100, std::string(4096, 'x')), std::system_error);
+    unlimit_wal();
+    limit_wal(0);
+    EXPECT_THROW(map.remove(3), std::system_error);
+    unlimit_wal();
+    EXPECT_THROW(map.get(100), std::out_of_range);
+    EXPECT_EQ(map.get(3), "3");
+
+    map.assign(10, "10");
+    map.sync();
+  }
+  DurableMap<int, std::string> reopened(directory);
+  EXPECT_EQ(reopened.size(), 11u);
+  EXPECT_EQ(reopened.get(3), "3");
+  EXPECT_EQ(reopened.get(10), "10");
+  EXPECT_THROW(reopened.get(100), std::out_of_range);
+}
+
+TEST_F(DurableMapTest, PeriodicFailureSurfacesOnNextWrite) {
+  DurableOptions options = with(Durability::kPeriodic);
+  options.interval = std::chrono::milliseconds(1);
+  {
+    DurableMap<int, std::string> map(directory, options);
+    map.assign(1, "1");
+    map.sync();
+
+    limit_wal(16);
+    map.assign(2, std::string(4096, 'x'));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    unlimit_wal();
+
+    EXPECT_THROW(map.assign(3, "3"), std::system_error);
+    map.assign(3, "3");
+    map.sync();
+  }
+  DurableMap<int, std::string> reopened(directory, options);
+  EXPECT_EQ(reopened.size(), 3u);
+  EXPECT_EQ(reopened.get(1), "1");
+  EXPECT_EQ(reopened.get(3), "3");
+}
+
+TEST_F(DurableMapTest, FailedTruncateRejectsFurtherWrites) {
+  DurableMap<int, int> map(directory);
+  map.assign(1, 10);
+  {
+    // Fecha o descritor do log por baixo do mapa: nem a escrita nem o
+    // truncamento conseguem desfazer o lote.
+    struct stat info {};
+    ASSERT_EQ(::stat((directory + "/wal").c_str(), &info), 0);
+    for (int fd = 3; fd < 1024; ++fd) {
+      struct stat other {};
+      if (::fstat(fd, &other) == 0 && other.st_ino == info.st_ino &&
+          other.st_dev == info.st_dev) {
+        ::close(fd);
+      }
+    }
+  }
+  EXPECT_THROW(map.assign(2, 20), std::system_error);
+  EXPECT_THROW(map.assign(3, 30), std::system_error);
+  EXPECT_THROW(map.sync(), std::system_error);
+}
@@ -0,0 +1,62 @@
+#include "../include/fork_snapshot.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "temp_path.hpp"
+
+class ForkSnapshotTest : public ::testing::Test {
+ protected:
+  void TearDown() override {
+    std::remove(path.c_str());
+    std::remove((path + ".tmp").c_str());
+  }
+
+  std::string path = temp_path(".bin");
+};
+
+TEST_F(ForkSnapshotTest, CapturesStateAtStart) {
+  Map<int, int> map;
+  for (int i = 0; i < 10000; ++i) map[(i * 7919) % 10007] = i;
+
+  BackgroundSnapshot snapshot = save_in_background(map, path);
+  // O pai continua alterando o mapa durante a gravação.
+  for (int i = 0; i < 10000; ++i) map[(i * 7919) % 10007] = -1;
+  map.remove(0);
+  map[20000] = 1;
+  snapshot.wait();
+  EXPECT_TRUE(snapshot.done());
+
+  BackgroundSnapshot::Progress progress = snapshot.progress();
+  EXPECT_GT(progress.expected, 0u);
+  EXPECT_EQ(progress.bytes, progress.expected);
+
+  std::ifstream in(path, std::ios::binary);
+  Map<int, int> restored;
+  restored.load(in);
+  EXPECT_EQ(restored.size(), 10000u);
+  const Map<int, int>& view = restored;
+  for (int i = 0; i < 10000; ++i) ASSERT_EQ(view[(i * 7919) % 10007], i);
+  EXPECT_THROW(view[20000], std::out_of_range);
+}
+
+TEST_F(ForkSnapshotTest, UnknownSizeForStrings) {
+  Map<std::string, std::string> map;
+  map["a"] = "alfa";
+  BackgroundSnapshot snapshot = save_in_background(map, path);
+  snapshot.wait();
+  EXPECT_EQ(snapshot.progress().expected, 0u);
+  EXPECT_GT(snapshot.progress().bytes, 0u);
+}
+
+TEST_F(ForkSnapshotTest, ReportsFailure) {
+  Map<int, int> map;
+  map[1] = 1;
+  BackgroundSnapshot snapshot =
+      save_in_background(map, ::testing::TempDir() + "inexistente/x/y.bin");
+  EXPECT_THROW(snapshot.wait(), std::runtime_error);
+}
@@ -2,8 +2,13 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 
 struct MyValue {
@@ -217,3 +222,226 @@ TEST_F(MapTest, ScopeAndDestruction) {
   }
   SUCCEED();
 }
+
+
+TEST_F(MapTest, CopyMoveAndSwap) {
+  stringMyValueMap["a"] = MyValue(1, "one");
+  stringMyValueMap["b"] = MyValue(2, "two");
+
+  Map<std::string, MyValue> copy = stringMyValueMap;
+  copy["a"] = MyValue(10, "ten");
+  EXPECT_EQ(stringMyValueMap["a"], MyValue(1, "one"));
+  EXPECT_EQ(copy["a"], MyValue(10, "ten"));
+
+  Map<std::string, MyValue> moved = std::move(copy);
+  EXPECT_EQ(moved["b"], MyValue(2, "two"));
+  EXPECT_FALSE(copy.remove("b"));
+
+  moved.swap(stringMyValueMap);
+  EXPECT_EQ(moved["a"], MyValue(1, "one"));
+  EXPECT_EQ(stringMyValueMap["a"], MyValue(10, "ten"));
+}
+
+
+TEST_F(MapTest, SaveAndLoadRoundTrip) {
+  for (int i = 0; i < 5000; ++i) intIntMap[i * 2] = i;
+  std::stringstream buffer;
+  intIntMap.save(buffer);
+
+  Map<int, int> loaded;
+  loaded.load(buffer);
+  EXPECT_EQ(loaded.size(), 5000u);
+  const auto& const_loaded = loaded;
+  for (int i = 0; i < 5000; ++i) EXPECT_EQ(const_loaded[i * 2], i);
+  EXPECT_THROW(const_loaded[1], std::out_of_range);
+}
+
+TEST_F(MapTest, SaveAndLoadMixedTypes) {
+  intStringMap[3] = "three";
+  intStringMap[1] = "one";
+  intStringMap[2] = "";
+  std::stringstream buffer;
+  intStringMap.save(buffer);
+
+  Map<int, std::string> loaded;
+  loaded.load(buffer);
+  EXPECT_EQ(loaded.size(), 3u);
+  EXPECT_EQ(loaded[1], "one");
+  EXPECT_EQ(loaded[2], "");
+  EXPECT_EQ(loaded[3], "three");
+
+  // O mapa carregado continua aceitando alterações normalmente.
+  loaded[4] = "four";
+  EXPECT_TRUE(loaded.remove(1));
+  EXPECT_EQ(loaded.size(), 3u);
+}
+
+TEST_F(MapTest, LoadRejectsWrongKind) {
+  std::stringstream buffer;
+  Map<int, int> other;
+  other[1] = 1;
+  other.save(buffer);
+  EXPECT_THROW(intStringMap.load(buffer), std::runtime_error);
+}
+
+TEST_F(MapTest, FindManyReturnsValuePointers) {
+  for (int i = 0; i < 100; ++i) intStringMap[(i * 7919) % 1000] = std::to_string(i);
+
+  std::vector<int> keys;
+  for (int key = 0; key < 1000; key += 9) keys.push_back(key);
+  std::vector<const std::string*> values(keys.size());
+  std::size_t hits = intStringMap.find_many(keys.data(), keys.size(), values.data());
+
+  const auto& view = intStringMap;
+  std::size_t expected = 0;
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    if (values[i]) {
+      EXPECT_EQ(*values[i], view[keys[i]]);
+      ++expected;
+    } else {
+      EXPECT_THROW(view[keys[i]], std::out_of_range);
+    }
+  }
+  EXPECT_EQ(hits, expected);
+
+  std::unique_ptr<bool[]> found(new bool[keys.size()]);
+  EXPECT_EQ(intStringMap.contains_many(keys.data(), keys.size(), found.get()), expected);
+  for (std::size_t i = 0; i < keys.size(); ++i) EXPECT_EQ(found[i], values[i] != nullptr);
+}
+
+TEST_F(MapTest, EraseAndExtractRange) {
+  for (int key = 0; key < 50; ++key) intStringMap[key] = std::to_string(key);
+  EXPECT_EQ(intStringMap.erase_range(-10, 5), 5u);
+  Map<int, std::string> moved = intStringMap.extract_range(20, 30);
+  EXPECT_EQ(moved.size(), 10u);
+  EXPECT_EQ(intStringMap.size(), 35u);
+
+  const auto& view = intStringMap;
+  const auto& movedView = moved;
+  EXPECT_EQ(movedView[25], "25");
+  EXPECT_THROW(view[25], std::out_of_range);
+  EXPECT_THROW(view[4], std::out_of_range);
+  EXPECT_EQ(view[30], "30");
+  EXPECT_EQ(intStringMap.erase_range(30, 20), 0u);
+}
+
+TEST_F(MapTest, OrderQueriesReturnStoredEntries) {
+  for (int key : {10, 20, 30}) intStringMap[key] = std::to_string(key);
+
+  auto entry = intStringMap.lower_bound(15);
+  ASSERT_NE(entry.first, nullptr);
+  EXPECT_EQ(*entry.first, 20);
+  EXPECT_EQ(*entry.second, "20");
+  const auto& view = intStringMap;
+  EXPECT_EQ(entry.second, &view[20]);  // Sem cópia.
+
+  EXPECT_EQ(*intStringMap.upper_bound(20).first, 30);
+  EXPECT_EQ(*intStringMap.floor(29).second, "20");
+  EXPECT_EQ(*intStringMap.ceiling(30).first, 30);
+  EXPECT_EQ(*intStringMap.predecessor(10 + 1).first, 10);
+  EXPECT_EQ(*intStringMap.successor(10).first, 20);
+  EXPECT_EQ(*intStringMap.nearest(26).first, 30);
+  EXPECT_EQ(*intStringMap.nearest(25).first, 20);
+
+  Map<long long, int> extremes;
+  extremes[std::numeric_limits<long long>::min()] = 1;
+  extremes[std::numeric_limits<long long>::max()] = 2;
+  EXPECT_EQ(*extremes.nearest(0).second, 2);
+  EXPECT_EQ(*extremes.nearest(-1).second, 1);
+
+  auto none = intStringMap.upper_bound(30);
+  EXPECT_EQ(none.first, nullptr);
+  EXPECT_EQ(none.second, nullptr);
+  EXPECT_EQ(intStringMap.predecessor(10).first, nullptr);
+}
+
+TEST_F(MapTest, ForEachVisitsPairsInKeyOrder) {
+  for (int key : {3, 1, 2}) intStringMap[key] = std::to_string(key * 10);
+  std::vector<std::string> values;
+  EXPECT_TRUE(intStringMap.for_each([&](int key, const std::string& value) {
+    EXPECT_EQ(value, std::to_string(key * 10));
+    values.push_back(value);
+  }));
+  EXPECT_EQ(values, (std::vector<std::string>{"10", "20", "30"}));
+  int visited = 0;
+  EXPECT_FALSE(intStringMap.for_each([&](int, const std::string&) { return ++visited < 2; }));
+  EXPECT_EQ(visited, 2);
+}
+
+TEST_F(MapTest, ParallelExportFillsKeyAndValueColumns) {
+  for (int i = 0; i < 500; ++i) {
+    int key = (i * 37) % 500;
+    intStringMap[key] = std::to_string(key * 2);
+  }
+  std::vector<int> keys(intStringMap.size());
+  std::vector<std::string> values(intStringMap.size());
+  intStringMap.parallel_export(keys.data(), values.data(), 3);
+  for (int i = 0; i < 500; ++i) {
+    ASSERT_EQ(keys[i], i);
+    ASSERT_EQ(values[i], std::to_string(i * 2));
+  }
+}
+
+TEST(MapAggregateTest, SumOfValuesBetweenKeys) {
+  Map<long, long, SumOf<long>> bytes;
+  for (long t = 0; t < 1000; ++t) bytes[t * 10] = t;
+  EXPECT_EQ(bytes.aggregate(0, 100), 45);          // t = 0..9
+  EXPECT_EQ(bytes.aggregate(95, 205), 165);  // t = 10..20
+  EXPECT_EQ(bytes.aggregate(), 999 * 1000 / 2);
+
+  // Atribuições pela referência de operator[] atualizam os agregados.
+  bytes[50] = bytes[50] + 1000;
+  bytes[60] = 0;
+  EXPECT_EQ(bytes.aggregate(0, 100), 45 + 1000 - 6);
+  bytes[50] = 5;
+  EXPECT_EQ(bytes.aggregate(0, 100), 45 - 6);
+
+  EXPECT_TRUE(bytes.remove(0));
+  EXPECT_EQ(bytes.erase_range(10, 30), 2u);
+  EXPECT_EQ(bytes.aggregate(0, 100), 45 - 6 - 1 - 2);
+
+  Map<long, long, SumOf<long>> copy(bytes);
+  copy[990] = 0;
+  EXPECT_EQ(copy.aggregate(900, 1000), bytes.aggregate(900, 1000) - 99);
+
+  std::stringstream snapshot;
+  bytes.save(snapshot);
+  Map<long, long, SumOf<long>> loaded;
+  loaded.load(snapshot);
+  EXPECT_EQ(loaded.aggregate(), bytes.aggregate());
+}
+
+TEST(MapAggregateTest, ReferenceSurvivesRotations) {
+  Map<int, long, SumOf<long>> sums;
+  sums[10] = 1;
+  auto value = sums[10];
+  sums[20] = 1;
+  sums[30] = 1;  // Rotação: o nó de 10 deixa de ser a raiz.
+  value = 100;
+  EXPECT_EQ(sums.aggregate(), 102);
+  EXPECT_EQ(sums.aggregate(0, 15), 100);
+
+  for (int key = 40; key < 1000; key += 10) sums[key] = 1;
+  value = 7;
+  EXPECT_EQ(static_cast<long>(value), 7);
+  EXPECT_EQ(sums.aggregate(), 7 + 2 + 96);
+
+  EXPECT_TRUE(sums.remove(10));
+  EXPECT_THROW(static_cast<long>(value), std::out_of_range);
+  value = 3;  // Reinsere a chave.
+  EXPECT_EQ(sums.aggregate(), 3 + 2 + 96);
+}
+
+TEST(MapAggregateTest, MaxAndCountInRange) {
+  Map<int, int, MaxOf<int>> peaks;
+  Map<int, int, CountOf> counts;
+  for (int key = 0; key < 100; ++key) {
+    peaks[key] = (key * 37) % 101;
+    counts[key] = key;
+  }
+  int expected = 0;
+  for (int key = 20; key < 40; ++key) expected = std::max(expected, (key * 37) % 101);
+  EXPECT_EQ(peaks.aggregate(20, 40), expected);
+  EXPECT_EQ(counts.aggregate(20, 40), 20u);
+  EXPECT_EQ(counts.aggregate(90, 1000), 10u);
+}
@@ -0,0 +1,194 @@
+#include "../include/mapped_map.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "temp_path.hpp"
+
+using IntMap = MappedMap<int, int>;
+
+class MappedMapTest : public ::testing::Test {
+ protected:
+  void TearDown() override {
+    std::remove(path.c_str());
+    std::remove((path + ".tmp").c_str());
+  }
+
+  /**
+   * @brief Sobrescreve `size` bytes do arquivo na posição `offset`.
+   */
+  void patch(std::size_t offset, const void* bytes, std::size_t size) {
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+  }
+
+  /// Posição de `count` no cabeçalho: magic, versão, reservado e 4 u32.
+  static constexpr std::size_t kCountOffset = 24;
+
+  std::string path = temp_path(".bin");
+};
+
+TEST_F(MappedMapTest, EmptyMap) {
+  Map<int, int> map;
+  MappedMap<int, int>::write(map, path);
+
+  MappedMap<int, int> mapped(path);
+  EXPECT_EQ(mapped.size(), 0u);
+  EXPECT_EQ(mapped.find(1), IntMap::npos);
+  EXPECT_EQ(mapped.lower_bound(1), 0u);
+}
+
+TEST_F(MappedMapTest, FixedWidthLookups) {
+  Map<int, double> map;
+  for (int i = 0; i < 1000; ++i) map[i * 3] = i * 0.5;
+  MappedMap<int, double>::write(map, path);
+
+  MappedMap<int, double> mapped(path);
+  ASSERT_EQ(mapped.size(), 1000u);
+  for (int i = 0; i < 1000; ++i) {
+    std::size_t index = mapped.find(i * 3);
+    ASSERT_EQ(index, static_cast<std::size_t>(i));
+    EXPECT_EQ(mapped.key(index), i * 3);
+    EXPECT_EQ(mapped.value(index), i * 0.5);
+    EXPECT_FALSE(mapped.contains(i * 3 + 1));
+  }
+  EXPECT_EQ(mapped.lower_bound(-5), 0u);
+  EXPECT_EQ(mapped.lower_bound(1), 1u);
+  EXPECT_EQ(mapped.lower_bound(192), 64u);
+  EXPECT_EQ(mapped.lower_bound(193), 65u);
+  EXPECT_EQ(mapped.lower_bound(3000), 1000u);
+}
+
+TEST_F(MappedMapTest, StringKeysAndValues) {
+  Map<std::string, std::string> map;
+  map["banana"] = "amarela";
+  map["abacate"] = "verde";
+  map["cereja"] = "";
+  MappedMap<std::string, std::string>::write(map, path);
+
+  MappedMap<std::string, std::string> mapped(path);
+  ASSERT_EQ(mapped.size(), 3u);
+  EXPECT_EQ(mapped.key(0), "abacate");
+  EXPECT_EQ(mapped.value(mapped.find(std::string("banana"))), "amarela");
+  EXPECT_EQ(mapped.value(mapped.find(std::string("cereja"))), "");
+  EXPECT_FALSE(mapped.contains(std::string("damasco")));
+  EXPECT_EQ(mapped.lower_bound(std::string("b")), 1u);
+}
+
+TEST_F(MappedMapTest, RangeScan) {
+  Map<int, int> map;
+  for (int i = 0; i < 500; ++i) map[i] = -i;
+  MappedMap<int, int>::write(map, path);
+
+  MappedMap<int, int> mapped(path);
+  std::vector<int> keys;
+  mapped.scan(100, 105, [&](int key, int value) {
+    EXPECT_EQ(value, -key);
+    keys.push_back(key);
+  });
+  EXPECT_EQ(keys, (std::vector<int>{100, 101, 102, 103, 104}));
+
+  keys.clear();
+  mapped.scan(490, 1000, [&](int key, int) {
+    keys.push_back(key);
+    return keys.size() < 3;
+  });
+  EXPECT_EQ(keys, (std::vector<int>{490, 491, 492}));
+}
+
+TEST_F(MappedMapTest, MoveTransfersMapping) {
+  Map<int, int> map;
+  map[7] = 70;
+  MappedMap<int, int>::write(map, path);
+
+  MappedMap<int, int> first(path);
+  MappedMap<int, int> second(std::move(first));
+  EXPECT_EQ(second.value(second.find(7)), 70);
+}
+
+TEST_F(MappedMapTest, RejectsInvalidFiles) {
+  EXPECT_THROW(IntMap{path}, std::system_error);
+
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "isto não é um mapa mapeado, apenas texto suficiente para o cabeçalho";
+  }
+  EXPECT_THROW(IntMap{path}, std::runtime_error);
+
+  Map<int, int> map;
+  map[1] = 2;
+  MappedMap<int, int>::write(map, path);
+  EXPECT_THROW((MappedMap<int, double>{path}), std::runtime_error);
+  EXPECT_THROW((MappedMap<std::string, int>{path}), std::runtime_error);
+}
+
+TEST_F(MappedMapTest, RejectsSectionsPastTheFile) {
+  Map<int, int> map;
+  for (int i = 0; i < 200; ++i) map[i] = i;
+  MappedMap<int, int>::write(map, path);
+
+  // Mais pares do que as seções comportam: amostras e chaves invadiriam as
+  // seções seguintes e os valores passariam do fim do arquivo.
+  std::uint64_t count = 400;
+  patch(kCountOffset, &count, sizeof(count));
+  EXPECT_THROW(IntMap{path}, std::runtime_error);
+
+  count = ~std::uint64_t(0) / 2;
+  patch(kCountOffset, &count, sizeof(count));
+  EXPECT_THROW(IntMap{path}, std::runtime_error);
+}
+
+TEST_F(MappedMapTest, RejectsStringOffsetsPastTheFile) {
+  Map<std::string, std::string> map;
+  map["a"] = "1";
+  map["b"] = "22";
+  MappedMap<std::string, std::string>::write(map, path);
+  {
+    MappedMap<std::string, std::string> mapped(path);
+    EXPECT_EQ(mapped.value(mapped.find(std::string("b"))), "22");
+  }
+
+  // O último deslocamento da tabela de valores é o tamanho total dos bytes;
+  // os valores são a última seção, então ele fica 8 bytes antes do fim da
+  // tabela, que termina antes dos bytes "122" (mais o alinhamento).
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  std::size_t size = static_cast<std::size_t>(in.tellg());
+  in.close();
+  std::uint64_t values_table = 0;
+  {
+    std::ifstream header(path, std::ios::binary);
+    header.seekg(kCountOffset + 4 * sizeof(std::uint64_t));
+    header.read(reinterpret_cast<char*>(&values_table), sizeof(values_table));
+  }
+  std::uint64_t total = size;
+  patch(static_cast<std::size_t>(values_table) + 2 * sizeof(std::uint64_t), &total,
+        sizeof(total));
+  EXPECT_THROW((MappedMap<std::string, std::string>{path}), std::runtime_error);
+}
+
+TEST_F(MappedMapTest, RewriteKeepsExistingMappingsIntact) {
+  Map<int, int> map;
+  for (int i = 0; i < 1000; ++i) map[i] = i * 2;
+  MappedMap<int, int>::write(map, path);
+  MappedMap<int, int> old(path);
+
+  // Regravar com menos pares não pode encolher nem alterar o mapeamento
+  // antigo: ele continua apontando para o inode anterior.
+  Map<int, int> smaller;
+  smaller[5] = -5;
+  MappedMap<int, int>::write(smaller, path);
+
+  EXPECT_EQ(old.size(), 1000u);
+  EXPECT_EQ(old.value(old.find(999)), 1998);
+  MappedMap<int, int> fresh(path);
+  EXPECT_EQ(fresh.size(), 1u);
+  EXPECT_EQ(fresh.value(fresh.find(5)), -5);
+}
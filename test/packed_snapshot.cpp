@@ -0,0 +1,128 @@
+#include "../include/packed_snapshot.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "temp_path.hpp"
+
+class PackedSnapshotTest : public ::testing::Test {
+ protected:
+  void TearDown() override { std::remove(path.c_str()); }
+
+  template <class T>
+  void write_file(const Set<T>& set) {
+    std::ofstream out(path, std::ios::binary);
+    save_packed(set, out);
+  }
+
+  std::string path = temp_path(".bin");
+};
+
+TEST_F(PackedSnapshotTest, RoundTripIsSmallerThanRawSnapshot) {
+  Set<std::uint64_t> set;
+  for (std::uint64_t i = 0; i < 10000; ++i) set.insert(1000000 + i * 3 + (i % 2));
+
+  std::stringstream packed;
+  save_packed(set, packed);
+  std::stringstream raw;
+  set.save(raw);
+  EXPECT_LT(packed.str().size() * 8, raw.str().size());
+
+  Set<std::uint64_t> restored;
+  restored.insert(5);
+  load_packed(restored, packed);
+  EXPECT_EQ(restored.size(), 10000u);
+  EXPECT_FALSE(restored.search(5));
+  for (std::uint64_t i = 0; i < 10000; ++i) {
+    ASSERT_TRUE(restored.search(1000000 + i * 3 + (i % 2)));
+  }
+}
+
+TEST_F(PackedSnapshotTest, SignedAndExtremeValues) {
+  Set<std::int64_t> set;
+  const std::int64_t values[] = {std::numeric_limits<std::int64_t>::min(), -3, 0,
+                                 7, std::numeric_limits<std::int64_t>::max()};
+  for (std::int64_t value : values) set.insert(value);
+
+  std::stringstream stream;
+  save_packed(set, stream);
+  Set<std::int64_t> restored;
+  load_packed(restored, stream);
+  EXPECT_EQ(restored.size(), 5u);
+  for (std::int64_t value : values) EXPECT_TRUE(restored.search(value));
+  EXPECT_FALSE(restored.search(1));
+}
+
+TEST_F(PackedSnapshotTest, EmptySet) {
+  Set<int> set;
+  write_file(set);
+  PackedSetFile<int> file(path);
+  EXPECT_EQ(file.size(), 0u);
+  EXPECT_FALSE(file.contains(0));
+
+  std::ifstream in(path, std::ios::binary);
+  Set<int> restored;
+  restored.insert(1);
+  load_packed(restored, in);
+  EXPECT_EQ(restored.size(), 0u);
+}
+
+TEST_F(PackedSnapshotTest, RandomAccessMembership) {
+  Set<std::uint32_t> set;
+  for (std::uint32_t i = 0; i < 5000; ++i) set.insert(i * i);
+  write_file(set);
+
+  PackedSetFile<std::uint32_t> file(path);
+  EXPECT_EQ(file.size(), 5000u);
+  for (std::uint32_t i = 0; i < 5000; ++i) {
+    ASSERT_TRUE(file.contains(i * i));
+    if (i > 1) {
+      ASSERT_FALSE(file.contains(i * i - 1));
+    }
+  }
+  EXPECT_FALSE(file.contains(5000u * 5000u));
+}
+
+TEST_F(PackedSnapshotTest, RejectsOtherTypes) {
+  Set<std::uint32_t> set;
+  set.insert(1);
+  write_file(set);
+  EXPECT_THROW(PackedSetFile<std::int32_t>{path}, std::runtime_error);
+
+  std::ifstream in(path, std::ios::binary);
+  Set<std::uint64_t> other;
+  EXPECT_THROW(load_packed(other, in), std::runtime_error);
+}
+
+TEST_F(PackedSnapshotTest, RejectsValuesOutsideType) {
+  Set<std::uint8_t> set;
+  set.insert(0);
+  set.insert(255);
+  std::stringstream packed;
+  save_packed(set, packed);
+  const std::size_t first = PackedCodec<std::uint8_t>::kHeaderSize;
+
+  // Somar o delta ao primeiro valor passaria de 255.
+  std::string overflow = packed.str();
+  overflow[first] = static_cast<char>(200);
+  std::istringstream a(overflow);
+  Set<std::uint8_t> restored;
+  restored.insert(7);
+  EXPECT_THROW(load_packed(restored, a), std::runtime_error);
+  EXPECT_EQ(restored.size(), 1u);
+  EXPECT_TRUE(restored.search(7));
+
+  // Primeiro valor codificado fora do intervalo de uint8_t.
+  std::string wide = packed.str();
+  wide[first + 1] = 1;
+  std::istringstream b(wide);
+  EXPECT_THROW(load_packed(restored, b), std::runtime_error);
+  EXPECT_EQ(restored.size(), 1u);
+}
@@ -0,0 +1,101 @@
+#include "../include/persistent_avl.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using IntPAVL = PersistentAVL<int>;
+
+TEST(PersistentAVLTest, InsertRemoveAndContain) {
+    IntPAVL tree;
+    EXPECT_TRUE(tree.insert(10));
+    EXPECT_TRUE(tree.insert(5));
+    EXPECT_TRUE(tree.insert(15));
+    EXPECT_FALSE(tree.insert(10));
+
+    EXPECT_TRUE(tree.contain(5));
+    EXPECT_TRUE(tree.remove(5));
+    EXPECT_FALSE(tree.remove(5));
+    EXPECT_FALSE(tree.contain(5));
+    EXPECT_TRUE(tree.is_balanced());
+}
+
+TEST(PersistentAVLTest, SnapshotNaoVeModificacoesPosteriores) {
+    IntPAVL tree;
+    for (int i = 0; i < 10; ++i) tree.insert(i);
+
+    IntPAVL::Snapshot before = tree.snapshot();
+    tree.remove(3);
+    tree.insert(42);
+
+    std::vector<int> expected = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    EXPECT_EQ(before.in_order(), expected);
+    EXPECT_TRUE(before.contain(3));
+    EXPECT_FALSE(before.contain(42));
+
+    EXPECT_FALSE(tree.contain(3));
+    EXPECT_TRUE(tree.contain(42));
+}
+
+TEST(PersistentAVLTest, SnapshotsMultiplosEBalanceamento) {
+    IntPAVL tree;
+    std::set<int> reference;
+    std::vector<std::pair<IntPAVL::Snapshot, std::vector<int>>> history;
+    std::mt19937 rng(3);
+
+    for (int round = 0; round < 2000; ++round) {
+        int value = static_cast<int>(rng() % 500);
+        if (rng() % 3 == 0) {
+            EXPECT_EQ(tree.remove(value), reference.erase(value) == 1);
+        } else {
+            EXPECT_EQ(tree.insert(value), reference.insert(value).second);
+        }
+        if (round % 100 == 0) {
+            history.emplace_back(tree.snapshot(),
+                                 std::vector<int>(reference.begin(), reference.end()));
+        }
+    }
+
+    EXPECT_TRUE(tree.is_balanced());
+    EXPECT_EQ(tree.in_order(), std::vector<int>(reference.begin(), reference.end()));
+    for (const auto& [snap, expected] : history) {
+        EXPECT_EQ(snap.in_order(), expected);
+        EXPECT_TRUE(snap.is_balanced());
+    }
+}
+
+TEST(PersistentAVLTest, SnapshotSobreviveAArvore) {
+    IntPAVL::Snapshot snap;
+    {
+        IntPAVL tree;
+        tree.insert(20);
+        tree.insert(10);
+        tree.insert(30);
+        snap = tree.snapshot();
+    }
+    std::vector<int> pre = snap.pre_order();
+    EXPECT_EQ(pre.front(), 20);
+    EXPECT_EQ(snap.post_order().back(), 20);
+}
+
+TEST(PersistentAVLTest, SnapshotLidoEmOutraThread) {
+    PersistentAVL<std::string> tree;
+    for (int i = 0; i < 200; ++i) tree.insert(std::to_string(i));
+
+    auto snap = tree.snapshot();
+    std::thread reader([snap] {
+        for (int round = 0; round < 50; ++round) {
+            EXPECT_EQ(snap.in_order().size(), 200u);
+        }
+    });
+    for (int i = 0; i < 200; i += 2) tree.remove(std::to_string(i));
+    for (int i = 200; i < 400; ++i) tree.insert(std::to_string(i));
+    reader.join();
+
+    EXPECT_EQ(snap.in_order().size(), 200u);
+    EXPECT_EQ(tree.in_order().size(), 300u);
+}
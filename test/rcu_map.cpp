@@ -0,0 +1,75 @@
+#include "../include/rcu_map.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+class RcuMapTest : public ::testing::Test {
+ protected:
+  RcuMap<int, int> intIntMap;
+  RcuMap<std::string, std::string> stringMap;
+};
+
+TEST_F(RcuMapTest, IsEmptyInitially) {
+  const auto& const_map = intIntMap;
+  EXPECT_THROW(const_map[0], std::out_of_range);
+  EXPECT_FALSE(intIntMap.contains(0));
+  EXPECT_FALSE(intIntMap.remove(0));
+}
+
+TEST_F(RcuMapTest, AssignInsereESubstitui) {
+  EXPECT_TRUE(intIntMap.assign(10, 100));
+  EXPECT_EQ(intIntMap[10], 100);
+  EXPECT_FALSE(intIntMap.assign(10, 200));
+  EXPECT_EQ(intIntMap[10], 200);
+
+  EXPECT_TRUE(stringMap.assign("alpha", "apple"));
+  EXPECT_EQ(stringMap["alpha"], "apple");
+}
+
+TEST_F(RcuMapTest, Remove) {
+  for (int i = 0; i < 50; ++i) intIntMap.assign(i, i * i);
+  for (int i = 0; i < 50; i += 2) EXPECT_TRUE(intIntMap.remove(i));
+  for (int i = 0; i < 50; ++i) {
+    if (i % 2) {
+      EXPECT_EQ(intIntMap[i], i * i);
+    } else {
+      EXPECT_FALSE(intIntMap.contains(i));
+    }
+  }
+}
+
+TEST(RcuMapStressTest, LeitoresVeemValoresConsistentes) {
+  RcuMap<int, std::string> map;
+  for (int i = 0; i < 64; ++i) map.assign(i, std::to_string(i));
+
+  std::atomic<bool> stop{false};
+  std::atomic<long> wrong{0};
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 4; ++r) {
+    readers.emplace_back([&] {
+      int key = 0;
+      while (!stop) {
+        std::string value = map[key];
+        // O valor é sempre a chave, com ou sem o sufixo gravado pelo escritor.
+        if (value.compare(0, std::to_string(key).size(), std::to_string(key)) != 0) {
+          ++wrong;
+        }
+        key = (key + 1) % 64;
+      }
+    });
+  }
+
+  for (int round = 0; round < 2000; ++round) {
+    int key = round % 64;
+    map.assign(key, std::to_string(key) + (round % 2 ? "-odd" : "-even"));
+  }
+  stop = true;
+  for (auto& t : readers) t.join();
+
+  EXPECT_EQ(wrong.load(), 0);
+}
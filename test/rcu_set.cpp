@@ -0,0 +1,151 @@
+#include "../include/rcu_set.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+class RcuSetTest : public ::testing::Test {
+ protected:
+  RcuSet<int> intSet;
+  RcuSet<std::string> stringSet;
+};
+
+TEST_F(RcuSetTest, IsEmptyInitially) {
+  EXPECT_FALSE(intSet.search(0));
+  EXPECT_TRUE(intSet.in_order().empty());
+}
+
+TEST_F(RcuSetTest, InsertSearchRemove) {
+  EXPECT_TRUE(intSet.insert(10));
+  EXPECT_FALSE(intSet.insert(10));
+  EXPECT_TRUE(intSet.search(10));
+  EXPECT_TRUE(intSet.remove(10));
+  EXPECT_FALSE(intSet.remove(10));
+  EXPECT_FALSE(intSet.search(10));
+
+  EXPECT_TRUE(stringSet.insert("hello"));
+  EXPECT_TRUE(stringSet.search("hello"));
+  EXPECT_FALSE(stringSet.search("world"));
+}
+
+TEST(RcuAVLTest, PermaneceBalanceadaEOrdenada) {
+  RcuAVL<int> tree;
+  std::set<int> reference;
+  std::mt19937 rng(7);
+  for (int i = 0; i < 5000; ++i) {
+    int value = static_cast<int>(rng() % 1000);
+    if (rng() % 3 == 0) {
+      EXPECT_EQ(tree.remove(value), reference.erase(value) == 1);
+    } else {
+      EXPECT_EQ(tree.insert(value), reference.insert(value).second);
+    }
+  }
+  EXPECT_TRUE(tree.is_balanced());
+  EXPECT_EQ(tree.in_order(), std::vector<int>(reference.begin(), reference.end()));
+}
+
+TEST(RcuAVLTest, VersaoLidaNaoMudaDuranteEscritas) {
+  RcuAVL<int> tree;
+  for (int i = 0; i < 100; ++i) tree.insert(i);
+
+  // Um leitor que está dentro de visit continua vendo o elemento mesmo que
+  // uma escrita concorrente o remova.
+  bool seen = tree.visit(50, [&](const int& value) {
+    std::thread writer([&] { tree.remove(50); });
+    writer.join();
+    EXPECT_EQ(value, 50);
+  });
+  EXPECT_TRUE(seen);
+  EXPECT_FALSE(tree.contain(50));
+}
+
+namespace {
+
+// Valor cuja cópia lança depois de `copies_left` cópias (-1: nunca lança).
+struct Fragile {
+  static int copies_left;
+  int value;
+
+  Fragile(int v) : value(v) {}
+  Fragile(const Fragile& other) : value(other.value) {
+    if (copies_left == 0) throw std::runtime_error("cópia");
+    if (copies_left > 0) --copies_left;
+  }
+  Fragile& operator=(const Fragile&) = default;
+  bool operator<(const Fragile& other) const { return value < other.value; }
+};
+int Fragile::copies_left = -1;
+
+}  // namespace
+
+TEST(RcuAVLTest, EscritaInterrompidaNaoAposentaNosPublicados) {
+  RcuAVL<Fragile> tree;
+  std::set<int> reference;
+  for (int i = 0; i < 200; ++i) {
+    tree.insert(Fragile(i));
+    reference.insert(i);
+  }
+
+  // Cada escrita falha no meio da cópia do caminho; nada pode ser publicado
+  // nem aposentado, senão as escritas seguintes liberariam nós ainda vivos.
+  for (int copies = 0; copies < 5; ++copies) {
+    Fragile::copies_left = copies;
+    EXPECT_THROW(tree.remove(Fragile(copies * 20 + 1)), std::runtime_error);
+    Fragile::copies_left = copies;
+    EXPECT_THROW(tree.insert(Fragile(1000 + copies)), std::runtime_error);
+    Fragile::copies_left = -1;
+  }
+
+  for (int i = 0; i < 200; i += 3) {
+    EXPECT_TRUE(tree.remove(Fragile(i)));
+    reference.erase(i);
+  }
+  for (int i = 500; i < 700; ++i) {
+    tree.insert(Fragile(i));
+    reference.insert(i);
+  }
+  std::vector<int> values;
+  for (const Fragile& f : tree.in_order()) values.push_back(f.value);
+  EXPECT_EQ(values, std::vector<int>(reference.begin(), reference.end()));
+  EXPECT_TRUE(tree.is_balanced());
+}
+
+TEST(RcuSetStressTest, LeitoresSemTravaContraEscritores) {
+  constexpr int kKeys = 512;
+  RcuSet<int> set;
+  // Chaves pares ficam sempre presentes; as ímpares entram e saem.
+  for (int i = 0; i < kKeys; i += 2) set.insert(i);
+
+  std::atomic<bool> stop{false};
+  std::atomic<long> missing{0};
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 4; ++r) {
+    readers.emplace_back([&, r] {
+      std::mt19937 rng(r);
+      while (!stop) {
+        int key = static_cast<int>(rng() % kKeys) & ~1;
+        if (!set.search(key)) ++missing;
+      }
+    });
+  }
+
+  std::mt19937 rng(99);
+  for (int i = 0; i < 20000; ++i) {
+    int key = static_cast<int>(rng() % kKeys) | 1;
+    if (i % 2) {
+      set.insert(key);
+    } else {
+      set.remove(key);
+    }
+  }
+  stop = true;
+  for (auto& t : readers) t.join();
+
+  EXPECT_EQ(missing.load(), 0);
+}
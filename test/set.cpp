@@ -1,6 +1,15 @@
 #include "../include/set.hpp"
 
 #include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 class SetTest : public ::testing::Test {
  protected:
@@ -138,3 +147,200 @@ TEST_F(SetTest, ComplexSequenceOfOperations) {
   EXPECT_FALSE(intSet.search(5));
   EXPECT_FALSE(intSet.remove(10));
 }
+
+TEST_F(SetTest, CopyMoveAndSwap) {
+  intSet.insert(1);
+  intSet.insert(2);
+
+  Set<int> copy = intSet;
+  copy.remove(1);
+  EXPECT_TRUE(intSet.search(1));
+  EXPECT_FALSE(copy.search(1));
+
+  Set<int> moved = std::move(copy);
+  EXPECT_TRUE(moved.search(2));
+  EXPECT_FALSE(copy.search(2));
+
+  swap(moved, intSet);
+  EXPECT_TRUE(moved.search(1));
+  EXPECT_FALSE(intSet.search(1));
+  EXPECT_TRUE(intSet.search(2));
+}
+
+TEST_F(SetTest, SizeTracksInsertAndRemove) {
+  EXPECT_EQ(intSet.size(), 0u);
+  intSet.insert(1);
+  intSet.insert(2);
+  intSet.insert(2);
+  EXPECT_EQ(intSet.size(), 2u);
+  intSet.remove(1);
+  intSet.remove(7);
+  EXPECT_EQ(intSet.size(), 1u);
+}
+
+TEST_F(SetTest, SaveAndLoadRoundTrip) {
+  for (int i = 0; i < 10000; i += 3) intSet.insert(i);
+  std::stringstream buffer;
+  intSet.save(buffer);
+
+  Set<int> loaded;
+  loaded.insert(-1);
+  loaded.load(buffer);
+  EXPECT_EQ(loaded.size(), intSet.size());
+  EXPECT_FALSE(loaded.search(-1));
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_EQ(loaded.search(i), i % 3 == 0);
+  }
+}
+
+TEST_F(SetTest, SaveAndLoadStrings) {
+  stringSet.insert("");
+  stringSet.insert("banana");
+  stringSet.insert("apple");
+  std::stringstream buffer;
+  stringSet.save(buffer);
+
+  Set<std::string> loaded;
+  loaded.load(buffer);
+  EXPECT_EQ(loaded.size(), 3u);
+  EXPECT_TRUE(loaded.search(""));
+  EXPECT_TRUE(loaded.search("apple"));
+  EXPECT_TRUE(loaded.search("banana"));
+}
+
+TEST_F(SetTest, LoadRejectsInvalidSnapshots) {
+  intSet.insert(42);
+
+  std::stringstream garbage("not a snapshot");
+  EXPECT_THROW(intSet.load(garbage), std::runtime_error);
+
+  // Tipo incompatível: snapshot de strings lido como inteiros.
+  stringSet.insert("x");
+  std::stringstream strings;
+  stringSet.save(strings);
+  EXPECT_THROW(intSet.load(strings), std::runtime_error);
+
+  // Snapshot truncado.
+  Set<int> big;
+  for (int i = 0; i < 100; ++i) big.insert(i);
+  std::stringstream full;
+  big.save(full);
+  std::string bytes = full.str();
+  std::stringstream truncated(bytes.substr(0, bytes.size() - 8));
+  EXPECT_THROW(intSet.load(truncated), std::runtime_error);
+
+  // Tamanho de string corrompido, maior que o próprio fluxo.
+  std::string prefixed = strings.str();
+  std::uint64_t length = std::uint64_t(1) << 40;
+  std::memcpy(&prefixed[SnapshotHeader::encoded_size()], &length, sizeof(length));
+  std::stringstream oversized(prefixed);
+  Set<std::string> words;
+  EXPECT_THROW(words.load(oversized), std::runtime_error);
+
+  // O conjunto não muda quando a carga falha.
+  EXPECT_EQ(intSet.size(), 1u);
+  EXPECT_TRUE(intSet.search(42));
+}
+
+TEST_F(SetTest, ContainsManyMatchesSearch) {
+  for (std::string word : {"pera", "uva", "maçã", "kiwi"}) stringSet.insert(word);
+  std::string probes[] = {"uva", "banana", "kiwi", "pera", "", "maçã", "uva"};
+  bool found[7];
+  EXPECT_EQ(stringSet.contains_many(probes, 7, found), 5u);
+  for (int i = 0; i < 7; ++i) EXPECT_EQ(found[i], stringSet.search(probes[i]));
+
+  const std::string* stored[7];
+  EXPECT_EQ(stringSet.find_many(probes, 7, stored), 5u);
+  EXPECT_EQ(stored[1], nullptr);
+  EXPECT_EQ(*stored[2], "kiwi");
+}
+
+TEST_F(SetTest, SearchSortedMatchesSearch) {
+  for (int i = 0; i < 10000; i += 3) intSet.insert(i);
+  std::vector<int> probes;
+  for (int i = 2000; i < 4000; i += 2) probes.push_back(i);
+  std::unique_ptr<bool[]> found(new bool[probes.size()]);
+  std::size_t hits = intSet.search_sorted(probes.data(), probes.size(), found.get());
+  std::size_t expected = 0;
+  for (std::size_t i = 0; i < probes.size(); ++i) {
+    ASSERT_EQ(found[i], intSet.search(probes[i]));
+    expected += found[i];
+  }
+  EXPECT_EQ(hits, expected);
+}
+
+TEST_F(SetTest, AppendMaxAndHintedInsert) {
+  for (int i = 0; i < 1000; ++i) intSet.append_max(i * 3);
+  EXPECT_THROW(intSet.append_max(0), std::invalid_argument);
+  Set<int>::Finger hint;
+  for (int i = 0; i < 1000; ++i) EXPECT_TRUE(intSet.insert(hint, i * 3 + 1));
+  EXPECT_FALSE(intSet.insert(hint, 3));
+  EXPECT_EQ(intSet.size(), 2000u);
+  EXPECT_TRUE(intSet.search(2998));
+}
+
+TEST_F(SetTest, EraseAndExtractRange) {
+  for (int i = 0; i < 100; ++i) intSet.insert(i);
+  EXPECT_EQ(intSet.erase_range(0, 10), 10u);
+  Set<int> moved = intSet.extract_range(90, 200);
+  EXPECT_EQ(moved.size(), 10u);
+  EXPECT_TRUE(moved.search(99));
+  EXPECT_EQ(intSet.size(), 80u);
+  EXPECT_FALSE(intSet.search(9));
+  EXPECT_FALSE(intSet.search(90));
+  EXPECT_TRUE(intSet.search(10));
+}
+
+TEST_F(SetTest, OrderQueries) {
+  for (int value : {10, 20, 30, 40}) intSet.insert(value);
+  EXPECT_EQ(*intSet.lower_bound(20), 20);
+  EXPECT_EQ(*intSet.upper_bound(20), 30);
+  EXPECT_EQ(*intSet.floor(29), 20);
+  EXPECT_EQ(*intSet.ceiling(29), 30);
+  EXPECT_EQ(*intSet.predecessor(20), 10);
+  EXPECT_EQ(*intSet.successor(40 - 1), 40);
+  EXPECT_EQ(intSet.successor(40), nullptr);
+  EXPECT_EQ(*intSet.nearest(26), 30);
+
+  stringSet.insert("banana");
+  stringSet.insert("cereja");
+  EXPECT_EQ(*stringSet.ceiling("c"), "cereja");
+  EXPECT_EQ(stringSet.floor("a"), nullptr);
+}
+
+TEST_F(SetTest, NearestAtIntegerLimits) {
+  const int lowest = std::numeric_limits<int>::min();
+  const int highest = std::numeric_limits<int>::max();
+  intSet.insert(lowest);
+  intSet.insert(highest);
+  EXPECT_EQ(*intSet.nearest(0), highest);  // 2^31 - 1 contra 2^31.
+  EXPECT_EQ(*intSet.nearest(-1), lowest);
+  EXPECT_EQ(*intSet.nearest(lowest), lowest);
+  EXPECT_EQ(*intSet.nearest(highest), highest);
+
+  Set<unsigned> unsignedSet;
+  unsignedSet.insert(0);
+  unsignedSet.insert(std::numeric_limits<unsigned>::max());
+  EXPECT_EQ(*unsignedSet.nearest(1u << 31), std::numeric_limits<unsigned>::max());
+  EXPECT_EQ(*unsignedSet.nearest((1u << 31) - 1), 0u);
+}
+
+TEST_F(SetTest, ForEachVisitsInOrderAndStops) {
+  for (int value : {5, 1, 4, 2, 3}) intSet.insert(value);
+  std::vector<int> seen;
+  EXPECT_TRUE(intSet.for_each([&](int value) { seen.push_back(value); }));
+  EXPECT_EQ(seen, (std::vector<int>{1, 2, 3, 4, 5}));
+  seen.clear();
+  EXPECT_FALSE(intSet.for_each([&](int value) {
+    seen.push_back(value);
+    return value != 2;
+  }));
+  EXPECT_EQ(seen, (std::vector<int>{1, 2}));
+}
+
+TEST_F(SetTest, ParallelExport) {
+  for (int i = 999; i >= 0; --i) intSet.insert(i);
+  std::vector<int> out(intSet.size());
+  EXPECT_EQ(intSet.parallel_export(out.data(), 4), out.data() + 1000);
+  for (int i = 0; i < 1000; ++i) ASSERT_EQ(out[i], i);
+}
@@ -0,0 +1,148 @@
+#include "../include/shared_map.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+class SharedMapTest : public ::testing::Test {
+ protected:
+  void SetUp() override { SharedMap<int, int>::unlink(name); }
+  void TearDown() override { SharedMap<int, int>::unlink(name); }
+
+  /// Executa `f` num processo filho e devolve seu código de saída.
+  template <class F>
+  static int in_child(F f) {
+    pid_t pid = ::fork();
+    if (pid == 0) {
+      int code = 1;
+      try {
+        code = f() ? 0 : 1;
+      } catch (...) {
+      }
+      ::_exit(code);
+    }
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+  }
+
+  std::string name = "/ed_shared_map_test_" + std::to_string(::getpid());
+};
+
+TEST_F(SharedMapTest, OperatorSquareBracketsAndRemove) {
+  SharedMap<int, double> map(name, 1 << 16);
+  map[3] = 1.5;
+  EXPECT_EQ(map[3], 1.5);
+  EXPECT_EQ(static_cast<double>(map[4]), 0.0);  // insere o valor padrão
+  EXPECT_EQ(map.size(), 2u);
+
+  const SharedMap<int, double>& view = map;
+  EXPECT_THROW(view[5], std::out_of_range);
+  EXPECT_TRUE(map.remove(3));
+  EXPECT_FALSE(map.remove(3));
+  EXPECT_FALSE(map.contains(3));
+  EXPECT_EQ(map.size(), 1u);
+}
+
+TEST_F(SharedMapTest, MatchesStdMap) {
+  SharedMap<int, long> map(name, 1 << 22);
+  std::map<int, long> expected;
+  std::mt19937 rng(3);
+  for (int i = 0; i < 50000; ++i) {
+    int key = static_cast<int>(rng() % 5000);
+    if (rng() % 3 == 0) {
+      EXPECT_EQ(map.remove(key), expected.erase(key) == 1);
+    } else {
+      map[key] = i;
+      expected[key] = i;
+    }
+  }
+  ASSERT_EQ(map.size(), expected.size());
+  auto it = expected.begin();
+  map.for_each([&](int key, long value) {
+    ASSERT_NE(it, expected.end());
+    EXPECT_EQ(key, it->first);
+    EXPECT_EQ(value, it->second);
+    ++it;
+  });
+  EXPECT_EQ(it, expected.end());
+}
+
+TEST_F(SharedMapTest, OtherProcessesSeeTheSameMap) {
+  SharedMap<int, int> map(name, 1 << 20);
+  for (int i = 0; i < 1000; ++i) map[i] = 2 * i;
+
+  // Um leitor vê o que o pai escreveu...
+  EXPECT_EQ(in_child([this] {
+              const SharedMap<int, int> view(name);
+              if (view.size() != 1000) return false;
+              for (int i = 0; i < 1000; ++i) {
+                if (view[i] != 2 * i) return false;
+              }
+              return true;
+            }),
+            0);
+
+  // ... e o pai vê o que um escritor filho alterou.
+  EXPECT_EQ(in_child([this] {
+              SharedMap<int, int> writer(name);
+              for (int i = 0; i < 500; ++i) writer.remove(i);
+              writer[5000] = 7;
+              return true;
+            }),
+            0);
+  EXPECT_EQ(map.size(), 501u);
+  EXPECT_FALSE(map.contains(10));
+  EXPECT_EQ(map[5000], 7);
+}
+
+TEST_F(SharedMapTest, ReadersRunConcurrentlyWithWriter) {
+  SharedMap<int, int> map(name, 1 << 20);
+  pid_t writer = ::fork();
+  if (writer == 0) {
+    SharedMap<int, int> child(name);
+    for (int round = 0; round < 20; ++round) {
+      for (int i = 0; i < 2000; ++i) child[i] = 3 * i;
+      for (int i = 0; i < 2000; i += 2) child.remove(i);
+    }
+    ::_exit(0);
+  }
+  bool consistent = true;
+  for (int step = 0; step < 200; ++step) {
+    map.for_each([&](int key, int value) { consistent &= value == 3 * key; });
+  }
+  int status = 0;
+  ::waitpid(writer, &status, 0);
+  EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  EXPECT_TRUE(consistent);
+  EXPECT_EQ(map.size(), 1000u);
+}
+
+TEST_F(SharedMapTest, ReusesFreedNodesAndReportsFullSegment) {
+  SharedMap<int, int> map(name, 4096);
+  int inserted = 0;
+  EXPECT_THROW(
+      {
+        while (true) {
+          map[inserted] = inserted;
+          ++inserted;
+        }
+      },
+      std::length_error);
+  EXPECT_EQ(map.size(), static_cast<std::size_t>(inserted));
+  EXPECT_TRUE(map.remove(0));
+  map[-1] = 1;  // ocupa o nó liberado
+  EXPECT_THROW(map[-2] = 2, std::length_error);
+}
+
+TEST_F(SharedMapTest, RejectsMissingSegmentAndOtherTypes) {
+  EXPECT_THROW((SharedMap<int, int>(name)), std::system_error);
+  SharedMap<int, int> map(name, 1 << 16);
+  EXPECT_THROW((SharedMap<int, double>(name)), std::runtime_error);
+}
@@ -0,0 +1,125 @@
+#include "../include/skiplist_set.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+class SkipListSetTest : public ::testing::Test {
+ protected:
+  SkipListSet<int> intSet;
+  SkipListSet<std::string> stringSet;
+};
+
+TEST_F(SkipListSetTest, IsEmptyInitially) {
+  EXPECT_FALSE(intSet.search(0));
+  EXPECT_EQ(intSet.size(), 0u);
+  EXPECT_TRUE(intSet.in_order().empty());
+}
+
+TEST_F(SkipListSetTest, InsertSearchRemove) {
+  EXPECT_TRUE(intSet.insert(10));
+  EXPECT_FALSE(intSet.insert(10));
+  EXPECT_TRUE(intSet.search(10));
+  EXPECT_TRUE(intSet.remove(10));
+  EXPECT_FALSE(intSet.remove(10));
+  EXPECT_FALSE(intSet.search(10));
+
+  EXPECT_TRUE(stringSet.insert("hello"));
+  EXPECT_TRUE(stringSet.search("hello"));
+  EXPECT_FALSE(stringSet.search("world"));
+}
+
+TEST_F(SkipListSetTest, IteracaoOrdenadaIgualAReferencia) {
+  std::set<int> reference;
+  std::mt19937 rng(11);
+  for (int i = 0; i < 5000; ++i) {
+    int value = static_cast<int>(rng() % 2000);
+    if (rng() % 3 == 0) {
+      EXPECT_EQ(intSet.remove(value), reference.erase(value) == 1);
+    } else {
+      EXPECT_EQ(intSet.insert(value), reference.insert(value).second);
+    }
+  }
+  EXPECT_EQ(intSet.in_order(), std::vector<int>(reference.begin(), reference.end()));
+  EXPECT_EQ(intSet.size(), reference.size());
+}
+
+TEST(SkipListSetStressTest, InsercoesDisjuntasConcorrentes) {
+  constexpr int kThreads = 8;
+  constexpr int kPerThread = 2000;
+  SkipListSet<int> set;
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < kThreads; ++t) {
+    workers.emplace_back([&, t] {
+      for (int i = 0; i < kPerThread; ++i) {
+        EXPECT_TRUE(set.insert(i * kThreads + t));
+      }
+    });
+  }
+  for (auto& w : workers) w.join();
+
+  std::vector<int> all = set.in_order();
+  ASSERT_EQ(all.size(), static_cast<std::size_t>(kThreads * kPerThread));
+  EXPECT_TRUE(std::is_sorted(all.begin(), all.end()));
+  EXPECT_EQ(all.front(), 0);
+  EXPECT_EQ(all.back(), kThreads * kPerThread - 1);
+}
+
+TEST(SkipListSetStressTest, RemocoesDisputadasContamUmaVez) {
+  constexpr int kKeys = 4000;
+  SkipListSet<int> set;
+  for (int i = 0; i < kKeys; ++i) set.insert(i);
+
+  std::atomic<int> removed{0};
+  std::vector<std::thread> workers;
+  for (int t = 0; t < 8; ++t) {
+    workers.emplace_back([&] {
+      for (int i = 0; i < kKeys; ++i) {
+        if (set.remove(i)) ++removed;
+      }
+    });
+  }
+  for (auto& w : workers) w.join();
+
+  EXPECT_EQ(removed.load(), kKeys);
+  EXPECT_TRUE(set.in_order().empty());
+}
+
+TEST(SkipListSetStressTest, MisturaDeOperacoes) {
+  constexpr int kKeys = 256;
+  SkipListSet<int> set;
+  // Chaves pares nunca são removidas; as ímpares entram e saem.
+  for (int i = 0; i < kKeys; i += 2) set.insert(i);
+
+  std::atomic<long> missing{0};
+  std::vector<std::thread> workers;
+  for (int t = 0; t < 8; ++t) {
+    workers.emplace_back([&, t] {
+      std::mt19937 rng(t);
+      for (int i = 0; i < 20000; ++i) {
+        int key = static_cast<int>(rng() % kKeys);
+        if (key % 2 == 0) {
+          if (!set.search(key)) ++missing;
+        } else if (rng() % 2) {
+          set.insert(key);
+        } else {
+          set.remove(key);
+        }
+      }
+    });
+  }
+  for (auto& w : workers) w.join();
+
+  EXPECT_EQ(missing.load(), 0);
+  std::vector<int> all = set.in_order();
+  EXPECT_TRUE(std::is_sorted(all.begin(), all.end()));
+  EXPECT_EQ(std::adjacent_find(all.begin(), all.end()), all.end());
+  EXPECT_EQ(all.size(), set.size());
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+/**
+ * @brief Caminho temporário exclusivo do teste em execução.
+ *
+ * Junta o nome do caso e do teste ao pid, para que binários diferentes ou
+ * execuções repetidas rodando ao mesmo tempo (`ctest -j`) não disputem o
+ * mesmo arquivo. Deve ser chamado durante o teste (por exemplo, na
+ * construção da fixture).
+ */
+inline std::string temp_path(const std::string& suffix) {
+  const ::testing::TestInfo* info =
+      ::testing::UnitTest::GetInstance()->current_test_info();
+  std::string name = std::string(info->test_suite_name()) + "_" + info->name();
+  for (char& c : name) {
+    if (c == '/') c = '_';  // Testes parametrizados: "Caso/0".
+  }
+  return ::testing::TempDir() + name + "_" + std::to_string(::getpid()) + suffix;
+}